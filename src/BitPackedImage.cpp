@@ -0,0 +1,135 @@
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include "stdafx.h"
+#include "BitPackedImage.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace PRImA
+{
+
+/*
+ * Class CBitPackedImage
+ *
+ * Copy of a bilevel image with one bit per pixel (1 = black), stored in 64-bit words per row.
+ * Black pixels are counted with the popcount instruction (64 pixels per step).
+ * This is a counting accelerator, not a replacement: the bilevel image itself is kept
+ * (it is used for everything else), so the copy adds 1/8 of the size of the byte matrix.
+ */
+
+/*
+ * Constructor (packs the image)
+ */
+CBitPackedImage::CBitPackedImage(COpenCvBiLevelImage * image)
+{
+	m_Width = image->GetWidth();
+	m_Height = image->GetHeight();
+	m_WordsPerRow = (m_Width + 63) / 64;
+	m_Bits.assign((size_t)m_WordsPerRow * m_Height, 0);
+
+	for (int y=0; y<m_Height; y++)
+	{
+		uint64_t * row = &m_Bits[(size_t)y * m_WordsPerRow];
+		for (int x=0; x<m_Width; x++)
+			if (image->IsBlack(x, y))
+				row[x >> 6] |= (uint64_t)1 << (x & 63);
+	}
+}
+
+/*
+ * Destructor
+ */
+CBitPackedImage::~CBitPackedImage()
+{
+}
+
+/*
+ * Returns the number of black pixels within the given rectangle (inclusive coordinates, clipped to the image).
+ */
+long CBitPackedImage::CountPixels(int x1, int y1, int x2, int y2)
+{
+	x1 = max(x1, 0);
+	y1 = max(y1, 0);
+	x2 = min(x2, m_Width-1);
+	y2 = min(y2, m_Height-1);
+	if (x2 < x1 || y2 < y1)
+		return 0L;
+
+	long count = 0L;
+	for (int y=y1; y<=y2; y++)
+		count += CountRowPixels(&m_Bits[(size_t)y * m_WordsPerRow], x1, x2);
+	return count;
+}
+
+/*
+ * Returns the number of black pixels within the given rectangle (right and bottom are inclusive).
+ */
+long CBitPackedImage::CountPixels(CRect * rect)
+{
+	return CountPixels(rect->left, rect->top, rect->right, rect->bottom);
+}
+
+/*
+ * Returns the number of black pixels within the given rectangles (the rectangles should not overlap).
+ */
+long CBitPackedImage::CountPixels(vector<CRect*> * rects)
+{
+	long count = 0L;
+	for (unsigned int i=0; i<rects->size(); i++)
+		count += CountPixels(rects->at(i));
+	return count;
+}
+
+/*
+ * Returns the number of black pixels within the area of the given interval representation.
+ */
+long CBitPackedImage::CountPixels(CIntervalRepresentation * intRepr)
+{
+	long count = 0L;
+	for (int i=0; i<intRepr->GetIntervalCount(); i++)
+	{
+		CInterval * interval = intRepr->GetInterval(i);
+		vector<int> * parts = interval->GetIntervalSegments();
+		int y1 = max(interval->GetStart(), 0);
+		int y2 = min(interval->GetEnd(), m_Height-1);
+		for (int y=y1; y<=y2; y++)
+		{
+			const uint64_t * row = &m_Bits[(size_t)y * m_WordsPerRow];
+			for (unsigned int j=0; (int)j<(int)parts->size()-1; j+=2)
+			{
+				int x1 = max(parts->at(j), 0);
+				int x2 = min(parts->at(j+1), m_Width-1);
+				if (x1 <= x2)
+					count += CountRowPixels(row, x1, x2);
+			}
+		}
+	}
+	return count;
+}
+
+/*
+ * Counts the black pixels of one row between x1 and x2 (inclusive, already clipped).
+ */
+long CBitPackedImage::CountRowPixels(const uint64_t * row, int x1, int x2)
+{
+	int firstWord = x1 >> 6;
+	int lastWord = x2 >> 6;
+	uint64_t firstMask = ~(uint64_t)0 << (x1 & 63);
+	uint64_t lastMask = ~(uint64_t)0 >> (63 - (x2 & 63));
+
+	if (firstWord == lastWord)
+		return PopCount(row[firstWord] & firstMask & lastMask);
+
+	long count = PopCount(row[firstWord] & firstMask);
+	for (int w=firstWord+1; w<lastWord; w++)
+		count += PopCount(row[w]);
+	count += PopCount(row[lastWord] & lastMask);
+	return count;
+}
+
+} //end namespace
@@ -0,0 +1,58 @@
+#pragma once
+
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include "opencvimage.h"
+#include "IntervalRepresentation.h"
+#include <vector>
+#include <cstdint>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace PRImA
+{
+
+/*
+ * Class CBitPackedImage
+ *
+ * Copy of a bilevel image with one bit per pixel (1 = black), stored in 64-bit words per row.
+ * Black pixels are counted with the popcount instruction (64 pixels per step).
+ * This is a counting accelerator, not a replacement: the bilevel image itself is kept
+ * (it is used for everything else), so the copy adds 1/8 of the size of the byte matrix.
+ */
+class CBitPackedImage
+{
+public:
+	CBitPackedImage(COpenCvBiLevelImage * image);
+	~CBitPackedImage();
+
+	long	CountPixels(int x1, int y1, int x2, int y2);
+	long	CountPixels(CRect * rect);
+	long	CountPixels(std::vector<CRect*> * rects);
+	long	CountPixels(CIntervalRepresentation * intRepr);
+
+private:
+	long	CountRowPixels(const uint64_t * row, int x1, int x2);
+
+	static inline int PopCount(uint64_t word)
+	{
+#ifdef _MSC_VER
+		return (int)__popcnt64(word);
+#else
+		return __builtin_popcountll(word);
+#endif
+	};
+
+private:
+	int		m_Width;
+	int		m_Height;
+	int		m_WordsPerRow;
+	std::vector<uint64_t>	m_Bits;
+};
+
+} //end namespace
@@ -0,0 +1,192 @@
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include "stdafx.h"
+#include "CompactRectArray.h"
+#include "EvaluationArena.h"
+#include <cstring>
+
+using namespace std;
+
+namespace PRImA
+{
+
+/*
+ * Class CCompactRectArray
+ *
+ * Contiguous array of compact rectangles (error regions, overlap rects).
+ * The first few rects are stored within the object itself (no allocation for the common case).
+ */
+
+/*
+ * Constructor
+ */
+CCompactRectArray::CCompactRectArray()
+{
+	m_Data = m_Inline;
+	m_Size = 0;
+	m_Capacity = INLINE_CAPACITY;
+}
+
+/*
+ * Copy constructor
+ */
+CCompactRectArray::CCompactRectArray(const CCompactRectArray & other)
+{
+	m_Data = m_Inline;
+	m_Size = 0;
+	m_Capacity = INLINE_CAPACITY;
+	Add(other);
+}
+
+/*
+ * Move constructor (takes over the buffer of the other array)
+ */
+CCompactRectArray::CCompactRectArray(CCompactRectArray && other)
+{
+	m_Data = m_Inline;
+	m_Size = 0;
+	m_Capacity = INLINE_CAPACITY;
+	MoveFrom(other);
+}
+
+/*
+ * Destructor
+ */
+CCompactRectArray::~CCompactRectArray()
+{
+	Release();
+}
+
+CCompactRectArray & CCompactRectArray::operator=(const CCompactRectArray & other)
+{
+	if (this != &other)
+	{
+		m_Size = 0;
+		Add(other);
+	}
+	return *this;
+}
+
+CCompactRectArray & CCompactRectArray::operator=(CCompactRectArray && other)
+{
+	if (this != &other)
+	{
+		Release();
+		MoveFrom(other);
+	}
+	return *this;
+}
+
+/*
+ * Takes over the content of the other array (leaves it empty)
+ */
+void CCompactRectArray::MoveFrom(CCompactRectArray & other)
+{
+	if (other.m_Data == other.m_Inline) //Small -> copy
+	{
+		memcpy(m_Inline, other.m_Inline, other.m_Size * sizeof(CCompactRect));
+		m_Data = m_Inline;
+		m_Capacity = INLINE_CAPACITY;
+	}
+	else //Take the buffer
+	{
+		m_Data = other.m_Data;
+		m_Capacity = other.m_Capacity;
+	}
+	m_Size = other.m_Size;
+
+	other.m_Data = other.m_Inline;
+	other.m_Size = 0;
+	other.m_Capacity = INLINE_CAPACITY;
+}
+
+/*
+ * Releases the buffer (if any) and empties the array
+ */
+void CCompactRectArray::Release()
+{
+	if (m_Data != m_Inline)
+		CEvaluationArena::ReleaseObject(m_Data);
+	m_Data = m_Inline;
+	m_Size = 0;
+	m_Capacity = INLINE_CAPACITY;
+}
+
+/*
+ * Makes sure there is space for the given number of rects.
+ * Larger buffers come from the current evaluation arena (or the heap if there is none, see CEvaluationArena).
+ */
+void CCompactRectArray::Reserve(unsigned int capacity)
+{
+	if (capacity <= m_Capacity)
+		return;
+	unsigned int newCapacity = m_Capacity * 2;
+	if (newCapacity < capacity)
+		newCapacity = capacity;
+	CCompactRect * data = (CCompactRect*)CEvaluationArena::AllocateObject(newCapacity * sizeof(CCompactRect));
+	memcpy(data, m_Data, m_Size * sizeof(CCompactRect));
+	if (m_Data != m_Inline)
+		CEvaluationArena::ReleaseObject(m_Data);
+	m_Data = data;
+	m_Capacity = newCapacity;
+}
+
+void CCompactRectArray::push_back(const CCompactRect & rect)
+{
+	Reserve(m_Size + 1);
+	m_Data[m_Size++] = rect;
+}
+
+void CCompactRectArray::Add(int left, int top, int right, int bottom)
+{
+	CCompactRect rect;
+	rect.left = left;
+	rect.top = top;
+	rect.right = right;
+	rect.bottom = bottom;
+	push_back(rect);
+}
+
+/*
+ * Adds a copy of the coordinates of the given rect
+ */
+void CCompactRectArray::Add(CRect * rect)
+{
+	Add((int)rect->left, (int)rect->top, (int)rect->right, (int)rect->bottom);
+}
+
+/*
+ * Adds copies of the coordinates of the given rects (the vector can be NULL)
+ */
+void CCompactRectArray::Add(vector<CRect*> * rects)
+{
+	if (rects == NULL)
+		return;
+	Reserve(m_Size + (unsigned int)rects->size());
+	for (unsigned int i=0; i<rects->size(); i++)
+		Add(rects->at(i));
+}
+
+/*
+ * Appends the rects of the given array
+ */
+void CCompactRectArray::Add(const CCompactRectArray & rects)
+{
+	Reserve(m_Size + rects.m_Size);
+	memcpy(m_Data + m_Size, rects.m_Data, rects.m_Size * sizeof(CCompactRect));
+	m_Size += rects.m_Size;
+}
+
+/*
+ * Removes all rects (keeps the buffer)
+ */
+void CCompactRectArray::clear()
+{
+	m_Size = 0;
+}
+
+} //end namespace
@@ -0,0 +1,75 @@
+#pragma once
+
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include "DocumentLayout.h"
+#include <vector>
+
+namespace PRImA
+{
+
+/*
+ * Struct CCompactRect
+ *
+ * Plain 16-byte rectangle (right and bottom are inclusive, as for CRect).
+ */
+struct CCompactRect
+{
+	int left;
+	int top;
+	int right;
+	int bottom;
+
+	inline long GetArea() { return (long)(right - left + 1) * (long)(bottom - top + 1); };
+};
+
+
+/*
+ * Class CCompactRectArray
+ *
+ * Contiguous array of compact rectangles (error regions, overlap rects).
+ * The first few rects are stored within the object itself (no allocation for the common case).
+ */
+class CCompactRectArray
+{
+public:
+	CCompactRectArray();
+	CCompactRectArray(const CCompactRectArray & other);
+	CCompactRectArray(CCompactRectArray && other);
+	~CCompactRectArray();
+
+	CCompactRectArray & operator=(const CCompactRectArray & other);
+	CCompactRectArray & operator=(CCompactRectArray && other);
+
+	void	push_back(const CCompactRect & rect);
+	void	Add(int left, int top, int right, int bottom);
+	void	Add(CRect * rect);
+	void	Add(std::vector<CRect*> * rects);
+	void	Add(const CCompactRectArray & rects);
+	void	clear();
+
+	inline unsigned int		size() const { return m_Size; };
+	inline bool				empty() const { return m_Size == 0; };
+	inline CCompactRect &	operator[](unsigned int i) { return m_Data[i]; };
+	inline CCompactRect *	begin() { return m_Data; };
+	inline CCompactRect *	end() { return m_Data + m_Size; };
+
+private:
+	void	Reserve(unsigned int capacity);
+	void	Release();
+	void	MoveFrom(CCompactRectArray & other);
+
+private:
+	static const unsigned int INLINE_CAPACITY = 4;
+
+	CCompactRect	*	m_Data;			//Points to m_Inline or to a buffer from CEvaluationArena::AllocateObject
+	unsigned int		m_Size;
+	unsigned int		m_Capacity;
+	CCompactRect		m_Inline[INLINE_CAPACITY];
+};
+
+} //end namespace
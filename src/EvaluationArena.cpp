@@ -0,0 +1,248 @@
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include "stdafx.h"
+#include "EvaluationArena.h"
+#include <cstdlib>
+#include <new>
+#include <map>
+
+using namespace std;
+
+namespace PRImA
+{
+
+static atomic<unsigned int> s_NextArenaId(1);
+
+//Blocks of all arenas (for IsArenaMemory)
+static mutex					s_BlockRangesMutex;
+static map<const char*, const char*>	s_BlockRanges;	//map [block start, block end]
+static atomic<unsigned int>		s_BlockRangesVersion(1);	//Changes when blocks are released
+
+/*
+ * Current block of a thread in one arena
+ */
+struct CArenaBlockCursor
+{
+	unsigned int	m_ArenaId;	//Arena (and generation) the block belongs to (0 = unused)
+	char *			m_Pos;
+	char *			m_End;
+};
+
+//Per thread
+static const int THREAD_CURSOR_COUNT = 4;	//Arenas a thread can switch between without giving up its blocks
+static thread_local CEvaluationArena *	t_CurrentArena = NULL;
+static thread_local CArenaBlockCursor	t_Cursors[THREAD_CURSOR_COUNT];	//Most recently used first
+static thread_local const char *		t_LastRangeStart = NULL;	//Block found by the last IsArenaMemory call
+static thread_local const char *		t_LastRangeEnd = NULL;
+static thread_local unsigned int		t_LastRangeVersion = 0;
+
+/*
+ * Class CEvaluationArena
+ *
+ * Monotonic memory pool for the many small objects of one layout evaluation (errors, overlap rects, object results).
+ * Each thread bumps through its own block, so allocations don't contend. A thread keeps its block
+ * in the last few arenas it used, so switching arenas doesn't waste the rest of a block. Single objects
+ * are never freed; the memory is released in one step when the arena is reset or destroyed.
+ * Classes opt in with operator new/delete calling AllocateObject/ReleaseObject. These use the arena
+ * that is current for the calling thread (see CScope) and fall back to the heap if there is none.
+ * Objects of other classes (interval representations, overlaps) can be placed in the arena with New/Delete.
+ */
+
+/*
+ * Constructor
+ */
+CEvaluationArena::CEvaluationArena()
+{
+	m_Id = NextId();
+}
+
+/*
+ * Destructor (releases all blocks)
+ */
+CEvaluationArena::~CEvaluationArena()
+{
+	Reset();
+}
+
+/*
+ * Returns a new unique ID for an arena generation
+ */
+unsigned int CEvaluationArena::NextId()
+{
+	unsigned int id = s_NextArenaId++;
+	if (id == 0) //Wrapped around
+		id = s_NextArenaId++;
+	return id;
+}
+
+/*
+ * Returns memory for an object of the given size (aligned like max_align_t).
+ * Can be called from several threads at the same time.
+ */
+void * CEvaluationArena::Allocate(size_t size)
+{
+	size = (size + HEADER_SIZE - 1) / HEADER_SIZE * HEADER_SIZE;
+	unsigned int id = m_Id;
+
+	//Find the block of this thread for this arena (switching between arenas keeps the blocks)
+	int i = 0;
+	while (i < THREAD_CURSOR_COUNT-1 && t_Cursors[i].m_ArenaId != id)
+		i++;
+	CArenaBlockCursor cursor = t_Cursors[i];	//(least recently used one if not found)
+	for (; i > 0; i--)
+		t_Cursors[i] = t_Cursors[i-1];
+
+	if (cursor.m_ArenaId != id || (size_t)(cursor.m_End - cursor.m_Pos) < size)
+	{
+		//New block for this thread
+		size_t blockSize = BLOCK_SIZE;
+		if (size > blockSize)
+			blockSize = size;
+		char * block = (char*)malloc(blockSize);
+		if (block == NULL)
+		{
+			t_Cursors[0] = cursor;
+			throw bad_alloc();
+		}
+		m_Mutex.lock();
+		m_Blocks.push_back(block);
+		m_Mutex.unlock();
+		s_BlockRangesMutex.lock();
+		s_BlockRanges.insert(pair<const char*, const char*>(block, block + blockSize));
+		s_BlockRangesMutex.unlock();
+		if (size < BLOCK_SIZE || cursor.m_ArenaId != id) //Keep the current block if the object got its own one
+		{
+			cursor.m_ArenaId = id;
+			cursor.m_Pos = block;
+			cursor.m_End = block + blockSize;
+		}
+		else
+		{
+			t_Cursors[0] = cursor;
+			return block;
+		}
+	}
+
+	void * ret = cursor.m_Pos;
+	cursor.m_Pos += size;
+	t_Cursors[0] = cursor;
+	return ret;
+}
+
+/*
+ * Releases all memory of the arena.
+ * Only to be called if none of the objects allocated from the arena is in use any more.
+ */
+void CEvaluationArena::Reset()
+{
+	m_Mutex.lock();
+	s_BlockRangesMutex.lock();
+	for (unsigned int i=0; i<m_Blocks.size(); i++)
+	{
+		s_BlockRanges.erase(m_Blocks[i]);
+		free(m_Blocks[i]);
+	}
+	s_BlockRangesVersion++;
+	s_BlockRangesMutex.unlock();
+	m_Blocks.clear();
+	m_Id = NextId();
+	m_Mutex.unlock();
+}
+
+/*
+ * Returns the arena that is current for the calling thread (or NULL)
+ */
+CEvaluationArena * CEvaluationArena::GetCurrent()
+{
+	return t_CurrentArena;
+}
+
+/*
+ * Checks if the given address lies in a block of any arena
+ */
+bool CEvaluationArena::IsArenaMemory(const void * p)
+{
+	const char * address = (const char*)p;
+	//Objects are usually destroyed in allocation order -> check the last block first
+	if (address >= t_LastRangeStart && address < t_LastRangeEnd && t_LastRangeVersion == s_BlockRangesVersion)
+		return true;
+
+	bool ret = false;
+	s_BlockRangesMutex.lock();
+	map<const char*, const char*>::iterator it = s_BlockRanges.upper_bound(address);
+	if (it != s_BlockRanges.begin())
+	{
+		it--;
+		if (address < (*it).second)
+		{
+			ret = true;
+			t_LastRangeStart = (*it).first;
+			t_LastRangeEnd = (*it).second;
+			t_LastRangeVersion = s_BlockRangesVersion;
+		}
+	}
+	s_BlockRangesMutex.unlock();
+	return ret;
+}
+
+/*
+ * Allocates an object from the current arena or, if there is none, from the heap.
+ * The owner is stored in front of the object so that ReleaseObject knows what to do.
+ */
+void * CEvaluationArena::AllocateObject(size_t size)
+{
+	CEvaluationArena * arena = t_CurrentArena;
+	char * mem;
+	if (arena != NULL)
+		mem = (char*)arena->Allocate(size + HEADER_SIZE);
+	else
+	{
+		mem = (char*)malloc(size + HEADER_SIZE);
+		if (mem == NULL)
+			throw bad_alloc();
+	}
+	*((CEvaluationArena**)mem) = arena;
+	return mem + HEADER_SIZE;
+}
+
+/*
+ * Releases an object allocated with AllocateObject.
+ * Heap objects are freed, arena objects stay until the arena is reset.
+ */
+void CEvaluationArena::ReleaseObject(void * object)
+{
+	if (object == NULL)
+		return;
+	char * mem = (char*)object - HEADER_SIZE;
+	if (*((CEvaluationArena**)mem) == NULL)
+		free(mem);
+}
+
+/*
+ * Class CEvaluationArena::CScope
+ */
+
+/*
+ * Constructor
+ *
+ * 'arena' - New current arena for the calling thread (can be NULL to use the heap)
+ */
+CEvaluationArena::CScope::CScope(CEvaluationArena * arena)
+{
+	m_Previous = t_CurrentArena;
+	t_CurrentArena = arena;
+}
+
+/*
+ * Destructor (restores the previous arena)
+ */
+CEvaluationArena::CScope::~CScope()
+{
+	t_CurrentArena = m_Previous;
+}
+
+} //end namespace
@@ -0,0 +1,95 @@
+#pragma once
+
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace PRImA
+{
+
+/*
+ * Class CEvaluationArena
+ *
+ * Monotonic memory pool for the many small objects of one layout evaluation (errors, overlap rects, object results).
+ * Each thread bumps through its own block, so allocations don't contend. A thread keeps its block
+ * in the last few arenas it used, so switching arenas doesn't waste the rest of a block. Single objects
+ * are never freed; the memory is released in one step when the arena is reset or destroyed.
+ * Classes opt in with operator new/delete calling AllocateObject/ReleaseObject. These use the arena
+ * that is current for the calling thread (see CScope) and fall back to the heap if there is none.
+ * Objects of other classes (interval representations, overlaps) can be placed in the arena with New/Delete.
+ */
+class CEvaluationArena
+{
+public:
+	CEvaluationArena();
+	~CEvaluationArena();
+
+	void *	Allocate(size_t size);
+	void	Reset();
+
+	static CEvaluationArena *	GetCurrent();
+	static void *				AllocateObject(size_t size);
+	static void					ReleaseObject(void * object);
+	static bool					IsArenaMemory(const void * p);
+
+	/*
+	 * Creates an object of a class without arena support (e.g. CIntervalRepresentation) in the current arena
+	 * (with new if there is none). Such objects have to be deleted with Delete().
+	 */
+	template <class T, class... Args>
+	static T * New(Args&&... args)
+	{
+		CEvaluationArena * arena = GetCurrent();
+		if (arena == NULL)
+			return new T(std::forward<Args>(args)...);
+		return new (arena->Allocate(sizeof(T))) T(std::forward<Args>(args)...);
+	};
+
+	/*
+	 * Destroys an object created with New() or new (arena memory is released when the arena is reset)
+	 */
+	template <class T>
+	static void Delete(T * object)
+	{
+		if (object == NULL)
+			return;
+		if (IsArenaMemory(object))
+			object->~T();
+		else
+			delete object;
+	};
+
+	/*
+	 * Makes an arena the current one of the calling thread for the lifetime of the scope object
+	 */
+	class CScope
+	{
+	public:
+		CScope(CEvaluationArena * arena);
+		~CScope();
+	private:
+		CEvaluationArena * m_Previous;
+	};
+
+private:
+	static const size_t BLOCK_SIZE = 64 * 1024;
+	static const size_t HEADER_SIZE = sizeof(std::max_align_t);	//Keeps objects aligned; holds the owning arena (NULL for heap)
+
+	unsigned int	NextId();
+
+private:
+	std::mutex				m_Mutex;	//For adding blocks
+	std::vector<char*>		m_Blocks;
+	std::atomic<unsigned int>	m_Id;	//Changes on reset (invalidates the per-thread block pointers)
+};
+
+} //end namespace
@@ -6,6 +6,7 @@
  */
 
 #include "EvaluationMetrics.h"
+#include "EvaluationWeightTable.h"
 
 
 namespace PRImA
@@ -63,7 +64,7 @@ void CBorderEvaluationMetrics::CalculateGeneralFigures()
 	CPageLayout * segResult = m_Results->GetLayoutEvaluation()->GetSegResult();
 
 	//Image Area
-	m_ImageArea = m_Results->GetLayoutEvaluation()->GetWidth() * m_Results->GetLayoutEvaluation()->GetHeight();
+	m_ImageArea = m_Results->GetLayoutEvaluation()->GetImageArea();
 
 	//Border areas
 	CIntervalRepresentation * intRepr = m_Results->GetBorderResults()->GetGroundTruthBorderIntervalRep();
@@ -225,15 +226,7 @@ CLayoutObjectEvaluationMetrics::CLayoutObjectEvaluationMetrics(CEvaluationResult
 	m_GlyphStatistics = NULL;
 
 	if (calculate)
-	{
-		CalculateGeneralFigures();
-		CalculateWeightedErrors();
-		CalculateReadingOrderError();
-		CalculateSimpleCountBasedErrorRates();
-		CalculateRecallAndPrecision();
-		CalculateOverallSuccessRate();
-		CalculateOCRSuccessRate();
-	}
+		Calculate();
 }
 
 /*
@@ -244,6 +237,77 @@ CLayoutObjectEvaluationMetrics::~CLayoutObjectEvaluationMetrics()
 	delete m_GlyphStatistics;
 }
 
+/*
+ * Calculates all metrics.
+ *
+ * 'typeMetrics' (optional) - Region type specific metrics (see m_LayoutRegionType) that are calculated
+ *                            in the same pass over the layout objects and errors (for metrics of all types only).
+ */
+void CLayoutObjectEvaluationMetrics::Calculate(vector<CLayoutObjectEvaluationMetrics*> * typeMetrics /*= NULL*/)
+{
+	if (typeMetrics != NULL && typeMetrics->empty())
+		typeMetrics = NULL;
+
+	CalculateGeneralFigures(typeMetrics);
+	CalculateWeightedErrors(typeMetrics);
+	CalculateReadingOrderError();
+	if (typeMetrics != NULL)
+	{
+		for (unsigned int i=0; i<typeMetrics->size(); i++)
+			typeMetrics->at(i)->CalculateReadingOrderError();
+	}
+	CalculateSimpleCountBasedErrorRates(typeMetrics);
+	CalculateRecallAndPrecision();
+	CalculateOverallSuccessRate();
+	CalculateOCRSuccessRate();
+
+	if (typeMetrics != NULL)
+	{
+		for (unsigned int i=0; i<typeMetrics->size(); i++)
+		{
+			CLayoutObjectEvaluationMetrics * metrics = typeMetrics->at(i);
+			metrics->CalculateRecallAndPrecision();
+			metrics->CalculateOverallSuccessRate();
+			metrics->CalculateOCRSuccessRate();
+		}
+	}
+}
+
+/*
+ * Calculates the given region type specific metrics in one pass over the layout objects and errors.
+ * This object (metrics for all types) drives the pass but is not recalculated.
+ */
+void CLayoutObjectEvaluationMetrics::CalculateTypeMetrics(vector<CLayoutObjectEvaluationMetrics*> * typeMetrics)
+{
+	if (typeMetrics == NULL || typeMetrics->empty())
+		return;
+
+	CalculateGeneralFigures(typeMetrics, true);
+	CalculateWeightedErrors(typeMetrics, true);
+	for (unsigned int i=0; i<typeMetrics->size(); i++)
+		typeMetrics->at(i)->CalculateReadingOrderError();
+	CalculateSimpleCountBasedErrorRates(typeMetrics, true);
+
+	for (unsigned int i=0; i<typeMetrics->size(); i++)
+	{
+		CLayoutObjectEvaluationMetrics * metrics = typeMetrics->at(i);
+		metrics->CalculateRecallAndPrecision();
+		metrics->CalculateOverallSuccessRate();
+		metrics->CalculateOCRSuccessRate();
+	}
+}
+
+/*
+ * Checks if the given layout object passes the region type filter of this metrics object.
+ * 'layoutRegionsOnly' - If true, objects that are not layout regions don't pass. Otherwise they always pass.
+ */
+bool CLayoutObjectEvaluationMetrics::PassesTypeFilter(CLayoutObject * object, bool layoutRegionsOnly)
+{
+	if (object->GetLayoutObjectType() != CLayoutObject::TYPE_LAYOUT_REGION)
+		return !layoutRegionsOnly;
+	return (((CLayoutRegion*)object)->GetType() & m_LayoutRegionType) != 0;
+}
+
 double CLayoutObjectEvaluationMetrics::GetErrorRatePerTypeBasedOnCount(int errorType)
 {
 	map<int,double>::iterator it = m_ErrorRatePerTypeBasedOnSimpleCount.find(errorType);
@@ -639,98 +703,96 @@ double CLayoutObjectEvaluationMetrics::GetWeightedCountInfluencePerType(int erro
  *   - Combined area of all regions
  *   - Combined foreground pixel count of all regions
  *   - 
+ * The figures are calculated for the given region type specific metrics as well ('typeMetricsOnly': only for those).
  */
-void CLayoutObjectEvaluationMetrics::CalculateGeneralFigures()
+void CLayoutObjectEvaluationMetrics::CalculateGeneralFigures(vector<CLayoutObjectEvaluationMetrics*> * typeMetrics, bool typeMetricsOnly /*= false*/)
 {
-	CPageLayout * groundTruth = m_Results->GetLayoutEvaluation()->GetGroundTruth();
-	CPageLayout * segResult = m_Results->GetLayoutEvaluation()->GetSegResult();
-	int regionType = m_Results->GetLayoutObjectType();
+	//Image Area
+	int imageArea = m_Results->GetLayoutEvaluation()->GetImageArea();
 
-	//Number of ground-truth regions (of the used region type)
-	CLayoutObjectIterator * it = NULL;
-	if (m_LayoutRegionType == CLayoutRegion::TYPE_ALL)
-		it = CLayoutObjectIterator::GetLayoutObjectIterator(groundTruth, regionType);
-	else
-		it = CLayoutObjectIterator::GetLayoutObjectIterator(groundTruth, regionType, m_LayoutRegionType);
-	int count = 0;
-	map<int,int>::iterator itCountMap;
-	while (it->HasNext())
+	//Number of foreground pixels (counted once per layout evaluation)
+	int foreGroundPixelCount = (int)m_Results->GetLayoutEvaluation()->GetForegroundPixelCount();
+
+	if (!typeMetricsOnly)
 	{
-		CLayoutObject * reg = it->Next();
-		count++;
-		if (reg->GetLayoutObjectType() == CLayoutObject::TYPE_LAYOUT_REGION)
+		m_ImageArea = imageArea;
+		m_ForeGroundPixelCount = foreGroundPixelCount;
+	}
+	if (typeMetrics != NULL)
+	{
+		for (unsigned int i=0; i<typeMetrics->size(); i++)
 		{
-			int type =  ((CLayoutRegion*)reg)->GetType();
-			itCountMap = m_NumberOfGroundTruthRegionsPerType.find(type);
-			if (itCountMap == m_NumberOfGroundTruthRegionsPerType.end())
-				m_NumberOfGroundTruthRegionsPerType.insert(pair<int,int>(type, 1));
-			else
-				(*itCountMap).second++;
+			typeMetrics->at(i)->m_ImageArea = imageArea;
+			typeMetrics->at(i)->m_ForeGroundPixelCount = foreGroundPixelCount;
 		}
 	}
-	m_NumberOfGroundTruthRegions = count;
-	delete it;
 
-	//Number of segmentation result regions (of the used region type)
-	if (m_LayoutRegionType == CLayoutRegion::TYPE_ALL)
-		it = CLayoutObjectIterator::GetLayoutObjectIterator(segResult, regionType);
-	else
-		it = CLayoutObjectIterator::GetLayoutObjectIterator(segResult, regionType, m_LayoutRegionType);
-	count = 0;
-	while (it->HasNext())
+	//Number of regions and combined region area / number of foreground pixels (of the used region type)
+	if (!typeMetricsOnly)
+		CountRegionFigures();
+	if (typeMetrics != NULL)
 	{
-		CLayoutObject * reg = it->Next();
-		count++;
-		if (reg->GetLayoutObjectType() == CLayoutObject::TYPE_LAYOUT_REGION)
-		{
-			int type =  ((CLayoutRegion*)reg)->GetType();
-			itCountMap = m_NumberOfSegResultRegionPerType.find(type);
-			if (itCountMap == m_NumberOfSegResultRegionPerType.end())
-				m_NumberOfSegResultRegionPerType.insert(pair<int,int>(type, 1));
-			else
-				(*itCountMap).second++;
-		}
+		for (unsigned int i=0; i<typeMetrics->size(); i++)
+			typeMetrics->at(i)->CountRegionFigures();
 	}
-	m_NumberOfSegResultRegions = count;
-	delete it;
+}
 
-	//Image Area
-	m_ImageArea = m_Results->GetLayoutEvaluation()->GetWidth() * m_Results->GetLayoutEvaluation()->GetHeight();
+/*
+ * Counts the regions of the used region type and adds up their area and foreground pixel count.
+ * (The objects are selected by the type filtered layout object iterator.)
+ */
+void CLayoutObjectEvaluationMetrics::CountRegionFigures()
+{
+	CPageLayout * groundTruth = m_Results->GetLayoutEvaluation()->GetGroundTruth();
+	CPageLayout * segResult = m_Results->GetLayoutEvaluation()->GetSegResult();
+	int regionType = m_Results->GetLayoutObjectType();
 
-	//Number of foreground pixels
-	m_ForeGroundPixelCount = 0;
-	COpenCvBiLevelImage * img = m_Results->GetLayoutEvaluation()->GetBilevelImage();
-	if (img != NULL)
-		m_ForeGroundPixelCount = img->CountPixels(true);
+	for (int layout=0; layout<2; layout++)
+	{
+		bool isGroundTruth = layout == 0;
+		CLayoutObjectIterator * it = NULL;
+		if (m_LayoutRegionType == CLayoutRegion::TYPE_ALL)
+			it = CLayoutObjectIterator::GetLayoutObjectIterator(isGroundTruth ? groundTruth : segResult, regionType);
+		else
+			it = CLayoutObjectIterator::GetLayoutObjectIterator(isGroundTruth ? groundTruth : segResult, regionType, m_LayoutRegionType);
+		while (it->HasNext())
+		{
+			CLayoutObject * reg = it->Next();
+			AddRegionFigures(reg, isGroundTruth, m_Results->GetRegionArea(reg->GetId(), isGroundTruth),
+							m_Results->GetPixelCount(reg->GetId(), isGroundTruth));
+		}
+		delete it;
+	}
+}
 
-	//Combined region area / number of foreground pixels
-	m_OverallGroundTruthRegionArea = 0;
-	m_OverallGroundTruthRegionPixelCount = 0;
-	if (m_LayoutRegionType == CLayoutRegion::TYPE_ALL)
-		it = CLayoutObjectIterator::GetLayoutObjectIterator(groundTruth, regionType);
+/*
+ * Adds the given layout object to the region count and the combined region area / foreground pixel count.
+ */
+void CLayoutObjectEvaluationMetrics::AddRegionFigures(CLayoutObject * object, bool groundTruth, long area, long pixelCount)
+{
+	map<int,int> * countMap = groundTruth ? &m_NumberOfGroundTruthRegionsPerType : &m_NumberOfSegResultRegionPerType;
+	if (groundTruth)
+	{
+		m_NumberOfGroundTruthRegions++;
+		m_OverallGroundTruthRegionArea += area;
+		m_OverallGroundTruthRegionPixelCount += pixelCount;
+	}
 	else
-		it = CLayoutObjectIterator::GetLayoutObjectIterator(groundTruth, regionType, m_LayoutRegionType);
-	while (it->HasNext())
 	{
-		CLayoutObject * reg = it->Next();
-		m_OverallGroundTruthRegionArea += m_Results->GetRegionArea(reg->GetId(), true);
-		m_OverallGroundTruthRegionPixelCount += m_Results->GetPixelCount(reg->GetId(), true);
+		m_NumberOfSegResultRegions++;
+		m_OverallSegResultRegionArea += area;
+		m_OverallSegResultRegionPixelCount += pixelCount;
 	}
-	delete it;
 
-	m_OverallSegResultRegionArea = 0;
-	m_OverallSegResultRegionPixelCount = 0;
-	if (m_LayoutRegionType == CLayoutRegion::TYPE_ALL)
-		it = CLayoutObjectIterator::GetLayoutObjectIterator(segResult, regionType);
-	else
-		it = CLayoutObjectIterator::GetLayoutObjectIterator(segResult, regionType, m_LayoutRegionType);
-	while (it->HasNext())
+	if (object->GetLayoutObjectType() == CLayoutObject::TYPE_LAYOUT_REGION)
 	{
-		CLayoutObject * reg = it->Next();
-		m_OverallSegResultRegionArea += m_Results->GetRegionArea(reg->GetId(), false);
-		m_OverallSegResultRegionPixelCount += m_Results->GetPixelCount(reg->GetId(), false);
+		int type =  ((CLayoutRegion*)object)->GetType();
+		map<int,int>::iterator itCountMap = countMap->find(type);
+		if (itCountMap == countMap->end())
+			countMap->insert(pair<int,int>(type, 1));
+		else
+			(*itCountMap).second++;
 	}
-	delete it;
 }
 
 /*
@@ -745,408 +807,397 @@ double CLayoutObjectEvaluationMetrics::GetRelativeRegionCountDeviation()
 }
 
 /*
- * Applies the weight to every evaluation error
+ * Applies the weight to every evaluation error.
+ * The weights are calculated once per error and then added to this metrics object 
+ * and to the given region type specific metrics (optional; 'typeMetricsOnly' skips this object).
  */
-void CLayoutObjectEvaluationMetrics::CalculateWeightedErrors()
+void CLayoutObjectEvaluationMetrics::CalculateWeightedErrors(vector<CLayoutObjectEvaluationMetrics*> * typeMetrics, bool typeMetricsOnly /*= false*/)
 {
 	CLayoutObjectErrorIterator it(m_Results);
-	CLayoutObjectEvaluationError * err = NULL;
-	int errorType = 0;
-	double weight = 0.0;
-	double weightedArea, weightedCount;
-	m_OverallWeightedAreaError = 0.0;
-	m_OverallWeightedCountError = 0.0;
+	CEvaluationWeightTable * weights = m_Results->GetWeightTable();
+	CWeightedError weighted;
+	if (!typeMetricsOnly)
+	{
+		m_OverallWeightedAreaError = 0.0;
+		m_OverallWeightedCountError = 0.0;
+	}
 
 	while (it.HasNext())
 	{
-		CLayoutObjectEvaluationError * err = it.GetNext();
-		errorType = err->GetType();
-		bool allowable = false;
-		weightedArea = 0.0;
-		weightedCount = 0.0;
-		int layoutRegionType1 = CLayoutRegion::TYPE_INVALID;
-		const double weightForNestedRegions = 0.5;
-
-		if (!err->IsFalseAlarm())
+		WeightError(it.GetNext(), weights, weighted);
+		if (!typeMetricsOnly)
+			AddWeightedError(weighted);
+		if (typeMetrics != NULL)
+		{
+			for (unsigned int i=0; i<typeMetrics->size(); i++)
+				typeMetrics->at(i)->AddWeightedError(weighted);
+		}
+	}
+
+	if (!typeMetricsOnly)
+		CalculateWeightedSuccessRates();
+	if (typeMetrics != NULL)
+	{
+		for (unsigned int i=0; i<typeMetrics->size(); i++)
+			typeMetrics->at(i)->CalculateWeightedSuccessRates();
+	}
+}
+
+/*
+ * Calculates the weighted area and count error of the given error (without applying the region type filter).
+ */
+void CLayoutObjectEvaluationMetrics::WeightError(CLayoutObjectEvaluationError * err, CEvaluationWeightTable * weights, CWeightedError & weighted)
+{
+	int errorType = err->GetType();
+	double weight = 0.0;
+	double weightedArea = 0.0;
+	double weightedCount = 0.0;
+	bool allowable = false;
+	int layoutRegionType1 = CLayoutRegion::TYPE_INVALID;
+	const double weightForNestedRegions = 0.5;
+
+	weighted.m_Error = err;
+	weighted.m_ErrorType = errorType;
+	weighted.m_FilterObject = NULL;
+
+	if (!err->IsFalseAlarm())
+	{
+		//Miss, part. miss, false detection
+		if (	errorType == CLayoutObjectEvaluationError::TYPE_MISS
+			||	errorType == CLayoutObjectEvaluationError::TYPE_PART_MISS
+			||	errorType == CLayoutObjectEvaluationError::TYPE_INVENT)
 		{
-			//Miss, part. miss, false detection
-			if (	errorType == CLayoutObjectEvaluationError::TYPE_MISS
-				||	errorType == CLayoutObjectEvaluationError::TYPE_PART_MISS
-				||	errorType == CLayoutObjectEvaluationError::TYPE_INVENT)
+			CUniString regId = err->GetLayoutObject();
+			CLayoutObject * region = m_Results->GetDocumentLayoutObject(regId, errorType != CLayoutObjectEvaluationError::TYPE_INVENT);
+
+			weighted.m_FilterObject = region;
+
+			//Get type and weight slot (type and subtype)
+			int regionType = region->GetLayoutObjectType();
+			int slot = -1;
+
+			if (regionType == CLayoutObject::TYPE_LAYOUT_REGION)
 			{
-				CUniString regId = err->GetLayoutObject();
-				CLayoutObject * region = m_Results->GetDocumentLayoutObject(regId, errorType != CLayoutObjectEvaluationError::TYPE_INVENT);
+				CLayoutRegion * layoutReg = (CLayoutRegion*)region;
+				layoutRegionType1 = layoutReg->GetType();
+				slot = m_Results->GetWeightSlot(layoutReg, errorType != CLayoutObjectEvaluationError::TYPE_INVENT);
+			}
+			else
+				slot = weights->GetSlot(layoutRegionType1, CUniString());
 
-				if (region->GetLayoutObjectType() != CLayoutObject::TYPE_LAYOUT_REGION
-					||	(((CLayoutRegion*)region)->GetType() & m_LayoutRegionType) != 0) //Type filter
-				{
-					//Get type and subtype
-					int regionType = region->GetLayoutObjectType();
-					CUniString subType;
+			//Error Type Weight
+			if (m_Results->GetLayoutObjectType() == CLayoutObject::TYPE_READING_ORDER_GROUP)
+				weight = m_Profile->GetErrorTypeWeightForReadingOrderGroup(errorType);
+			else if (m_Results->GetLayoutObjectType() != CLayoutObject::TYPE_LAYOUT_REGION) //Text line, word, glyph
+				weight = m_Profile->GetErrorTypeWeightForTextSubStructure(errorType, regionType);
+			else //Layout region (with or without subtype)
+				weight = weights->GetErrorTypeWeight(errorType, slot, false);
 
-					if (regionType == CLayoutObject::TYPE_LAYOUT_REGION)
-					{
-						CLayoutRegion * layoutReg = (CLayoutRegion*)region;
-						layoutRegionType1 = layoutReg->GetType();
-						subType = CLayoutEvaluation::GetLayoutRegionSubtype(layoutReg, m_Profile);
-					}
+			//Region Type Weight
+			if (m_Results->GetLayoutObjectType() == CLayoutObject::TYPE_LAYOUT_REGION)
+				weight *= weights->GetRegionTypeWeight(slot);
 
-					//Error Type Weight
-					if (m_Results->GetLayoutObjectType() == CLayoutObject::TYPE_READING_ORDER_GROUP)
-						weight = m_Profile->GetErrorTypeWeightForReadingOrderGroup(errorType);
-					else if (m_Results->GetLayoutObjectType() != CLayoutObject::TYPE_LAYOUT_REGION) //Text line, word, glyph
-						weight = m_Profile->GetErrorTypeWeightForTextSubStructure(errorType, regionType);
-					else if (subType.IsEmpty()) //Layout region without subtype
-						weight = m_Profile->GetErrorTypeWeight(errorType, layoutRegionType1, false);
-					else //Text region
-						weight = m_Profile->GetErrorTypeWeight(errorType, layoutRegionType1, subType, false);
+			//Nested
+			if (err->IsForNestedRegion())
+				weight *= weightForNestedRegions;
 
-					//Region Type Weight
-					if (m_Results->GetLayoutObjectType() == CLayoutObject::TYPE_LAYOUT_REGION)
-					{
-						if (subType.IsEmpty())
-							weight *= m_Profile->GetRegionTypeWeight(layoutRegionType1);
-						else
-							weight *= m_Profile->GetRegionTypeWeight(layoutRegionType1, subType);
-					}
+			//Area error
+			if (m_UsePixelArea)
+				weightedArea = weight * err->GetPixelCount();
+			else
+				weightedArea = weight * err->GetArea();
 
-					//Nested
-					if (err->IsForNestedRegion())
-						weight *= weightForNestedRegions;
+			//Count error
+			if (errorType == CLayoutObjectEvaluationError::TYPE_SPLIT)
+				weightedCount = weight * err->GetCount();
+			else
+				weightedCount = weight;
+		}
+		//Split
+		else if (errorType == CLayoutObjectEvaluationError::TYPE_SPLIT)
+		{
+			CEvaluationErrorSplit * split = (CEvaluationErrorSplit*)err;
+			allowable = split->IsAllowable();
+			CUniString regId = err->GetLayoutObject();
+			CLayoutObject * region = m_Results->GetDocumentLayoutObject(regId, true);
 
-					//Area error
-					if (m_UsePixelArea)
-						weightedArea = weight * err->GetPixelCount();
-					else
-						weightedArea = weight * err->GetArea();
+			weighted.m_FilterObject = region;
 
-					//Count error
-					if (errorType == CLayoutObjectEvaluationError::TYPE_SPLIT)
-						weightedCount = weight * err->GetCount();
-					else
-						weightedCount = weight;
+			//Get type and weight slot (type and subtype)
+			int regionType = region->GetLayoutObjectType();
+			int slot = -1;
+			if (regionType == CLayoutObject::TYPE_LAYOUT_REGION)
+			{
+				CLayoutRegion * layoutReg = (CLayoutRegion*)region;
+				layoutRegionType1 = layoutReg->GetType();
+				slot = m_Results->GetWeightSlot(layoutReg, true);
+			}
+			else
+				slot = weights->GetSlot(layoutRegionType1, CUniString());
+
+			//Relative split area (largest overlap area divided by total overlap area)
+			double relativeSplitArea = 0.0;
+			double maxOverlapArea = 0.0;
+			double totalOverlaArea = 0.0;
+			COverlapRects * splittingRegions = split->GetSplittingRegions();
+			vector<CUniString> * regions = splittingRegions->GetRegions();
+			for (unsigned int i=0; i<regions->size(); i++)
+			{
+				CUniString regId = regions->at(i);
+				//CLayoutObject * region = regions->at(i);
+				double currArea = m_UsePixelArea ? splittingRegions->GetOverlapPixelCount(regId)
+												 : splittingRegions->GetOverlapArea(regId);
+				if (currArea > maxOverlapArea)
+					maxOverlapArea = currArea;
+				totalOverlaArea += currArea;
+			}
+			if (totalOverlaArea > 0.0)
+				relativeSplitArea = maxOverlapArea / totalOverlaArea;
+
+			//Ground-truth region area
+			double groundTruthRegionArea = m_UsePixelArea ? m_Results->GetPixelCount(region->GetId(), true)
+														  : m_Results->GetRegionArea(region->GetId(), true);
+
+			//Error Type Weight
+			if (m_Results->GetLayoutObjectType() == CLayoutObject::TYPE_READING_ORDER_GROUP)
+				weight = m_Profile->GetErrorTypeWeightForReadingOrderGroup(errorType);
+			else if (m_Results->GetLayoutObjectType() != CLayoutObject::TYPE_LAYOUT_REGION) //Text line, word, glyph
+				weight = m_Profile->GetErrorTypeWeightForTextSubStructure(errorType, regionType);
+			else //Layout region (with or without subtype)
+				weight = weights->GetErrorTypeWeight(errorType, slot, allowable);
+			//Region Type Weight
+			if (m_Results->GetLayoutObjectType() == CLayoutObject::TYPE_LAYOUT_REGION)
+				weight *= weights->GetRegionTypeWeight(slot);
+
+			//Area error (includes count as well)
+			weightedArea = weight * (1.0-relativeSplitArea) 
+							* (log((double)err->GetCount()) + 0.31)		//natural logarithm (+0.31 so that the minimum (split into 2 regions) is 1.0 (ln(2)=0.69))
+							* groundTruthRegionArea;
+
+			//Count error
+			weightedCount = weight * err->GetCount();
+		}
+		//Merge
+		else if (errorType == CLayoutObjectEvaluationError::TYPE_MERGE)
+		{
+			CEvaluationErrorMerge * merge = (CEvaluationErrorMerge*)err;
 
-					err->SetWeightedAreaError(weightedArea);
-					err->SetWeightedCountError(weightedCount);
-					m_OverallWeightedAreaError += weightedArea;
-					m_OverallWeightedCountError += weightedCount;
-				}
+			CUniString regId = merge->GetLayoutObject();
+			CLayoutObject * region1 = m_Results->GetDocumentLayoutObject(regId, true);
+
+			weighted.m_FilterObject = region1;
+
+			//Get type and weight slot of region 1
+			int regionType1 = region1->GetLayoutObjectType();
+			int slot1 = -1;
+			if (regionType1 == CLayoutObject::TYPE_LAYOUT_REGION)
+			{
+				CLayoutRegion * layoutReg = (CLayoutRegion*)region1;
+				layoutRegionType1 = layoutReg->GetType();
+				slot1 = m_Results->GetWeightSlot(layoutReg, true);
 			}
-			//Split
-			else if (errorType == CLayoutObjectEvaluationError::TYPE_SPLIT)
+			else
+				slot1 = weights->GetSlot(layoutRegionType1, CUniString());
+
+			//Get the seperate error for each merged region
+			map<CUniString, COverlapRects *> * mergingRegions = merge->GetMergingRegions();
+
+			map<CUniString, COverlapRects *>::iterator itMergingRegions = mergingRegions->begin();
+			while (itMergingRegions != mergingRegions->end())
 			{
-				CEvaluationErrorSplit * split = (CEvaluationErrorSplit*)err;
-				allowable = split->IsAllowable();
-				CUniString regId = err->GetLayoutObject();
-				CLayoutObject * region = m_Results->GetDocumentLayoutObject(regId, true);
+				COverlapRects * overlap = (*itMergingRegions).second;
+				vector<CUniString> * regions2 = overlap->GetRegions();
+
+				double overlapWeight = 0.0;
+				overlapWeight = 1.0 / ((double)regions2->size()); // - 1.0);  //CC 21.7.10 The -1 is not needed anymore
+				//if (m_UsePixelArea)
+				//	overlapWeight = (double)overlap->GetOverlapPixelCount(region1) / (double)overlap->GetPixelCount();
+				//else
+				//	overlapWeight = (double)overlap->GetOverlapArea(region1) / (double)overlap->GetArea();
 
-				if (region->GetLayoutObjectType() != CLayoutObject::TYPE_LAYOUT_REGION
-					||	(((CLayoutRegion*)region)->GetType() & m_LayoutRegionType) != 0) //Type filter
+				for (unsigned int i=0; i<regions2->size() ;i++)
 				{
-					//Get type and subtype
-					int regionType = region->GetLayoutObjectType();
-					CUniString subType;
-					if (regionType == CLayoutObject::TYPE_LAYOUT_REGION)
-					{
-						CLayoutRegion * layoutReg = (CLayoutRegion*)region;
-						layoutRegionType1 = layoutReg->GetType();
-						subType = CLayoutEvaluation::GetLayoutRegionSubtype(layoutReg, m_Profile);
-					}
+					CUniString regId2 = regions2->at(i);
+					CLayoutObject * region2 = m_Results->GetDocumentLayoutObject(regId2, true);
 
-					//Relative split area (largest overlap area divided by total overlap area)
-					double relativeSplitArea = 0.0;
-					double maxOverlapArea = 0.0;
-					double totalOverlaArea = 0.0;
-					COverlapRects * splittingRegions = split->GetSplittingRegions();
-					vector<CUniString> * regions = splittingRegions->GetRegions();
-					for (unsigned int i=0; i<regions->size(); i++)
-					{
-						CUniString regId = regions->at(i);
-						//CLayoutObject * region = regions->at(i);
-						double currArea = m_UsePixelArea ? splittingRegions->GetOverlapPixelCount(regId)
-														 : splittingRegions->GetOverlapArea(regId);
-						if (currArea > maxOverlapArea)
-							maxOverlapArea = currArea;
-						totalOverlaArea += currArea;
-					}
-					if (totalOverlaArea > 0.0)
-						relativeSplitArea = maxOverlapArea / totalOverlaArea;
-		
-					//Ground-truth region area
-					double groundTruthRegionArea = m_UsePixelArea ? m_Results->GetPixelCount(region->GetId(), true)
-																  : m_Results->GetRegionArea(region->GetId(), true);
+					if (region2 == region1) //region1 isn't used for the error
+						continue;
+
+					allowable = merge->IsAllowable(regId2);
+
+					//Get weight slot of region 2
+					int regionType2 = region2->GetLayoutObjectType();
+					int slot2 = -1;
+					if (regionType2 == CLayoutObject::TYPE_LAYOUT_REGION)
+						slot2 = m_Results->GetWeightSlot((CLayoutRegion*)region2, true);
+					else
+						slot2 = weights->GetSlot(CLayoutRegion::TYPE_INVALID, CUniString());
 
 					//Error Type Weight
 					if (m_Results->GetLayoutObjectType() == CLayoutObject::TYPE_READING_ORDER_GROUP)
 						weight = m_Profile->GetErrorTypeWeightForReadingOrderGroup(errorType);
 					else if (m_Results->GetLayoutObjectType() != CLayoutObject::TYPE_LAYOUT_REGION) //Text line, word, glyph
-						weight = m_Profile->GetErrorTypeWeightForTextSubStructure(errorType, regionType);
-					else if (subType.IsEmpty()) //Layout region without subtype
-						weight = m_Profile->GetErrorTypeWeight(errorType, layoutRegionType1, allowable);
-					else //Text region
-						weight = m_Profile->GetErrorTypeWeight(errorType, layoutRegionType1, subType, allowable);
+						weight = m_Profile->GetErrorTypeWeightForTextSubStructure(errorType, regionType1);
+					else //Layout regions (with or without subtypes)
+						weight = weights->GetErrorTypeWeight(errorType, slot1, slot2, allowable);
 					//Region Type Weight
 					if (m_Results->GetLayoutObjectType() == CLayoutObject::TYPE_LAYOUT_REGION)
+						weight *= weights->GetRegionTypeWeight(slot1);
+
+					//Apply overlap weight
+					//  The overlap weight is the 1 / (number of involved regions - 1)
+					//  The overlap weight is used to avoid double penalizing merge errors 
+					//  of merges with many regions.
+					weight *= overlapWeight;
+
+					//Area error
+					if (m_UsePixelArea)
 					{
-						if (subType.IsEmpty())
-							weight *= m_Profile->GetRegionTypeWeight(layoutRegionType1);
-						else
-							weight *= m_Profile->GetRegionTypeWeight(layoutRegionType1, subType);
+						weightedArea += weight * overlap->GetOverlapPixelCount(region2->GetId());
+					}
+					else
+					{
+						weightedArea += weight * overlap->GetOverlapArea(region2->GetId());
 					}
-
-					//Area error (includes count as well)
-					weightedArea = weight * (1.0-relativeSplitArea) 
-									* (log((double)err->GetCount()) + 0.31)		//natural logarithm (+0.31 so that the minimum (split into 2 regions) is 1.0 (ln(2)=0.69))
-									* groundTruthRegionArea;
 
 					//Count error
-					weightedCount = weight * err->GetCount();
+					weightedCount += weight;
 
-					err->SetWeightedAreaError(weightedArea);
-					err->SetWeightedCountError(weightedCount);
-					m_OverallWeightedAreaError += weightedArea;
-					m_OverallWeightedCountError += weightedCount;
 				}
+				delete regions2;
+
+				itMergingRegions++;
 			}
-			//Merge
-			else if (errorType == CLayoutObjectEvaluationError::TYPE_MERGE)
-			{
-				CEvaluationErrorMerge * merge = (CEvaluationErrorMerge*)err;
+		}
+		//Misclassification
+		else if (errorType == CLayoutObjectEvaluationError::TYPE_MISCLASS
+			&& 	(m_Results->GetLayoutObjectType() == CLayoutObject::TYPE_LAYOUT_REGION //Misclassification only for layout regions
+			  || m_Results->GetLayoutObjectType() == CLayoutObject::TYPE_READING_ORDER_GROUP)) //or reading order groups
+		{
+			CEvaluationErrorMisclass * misclass = (CEvaluationErrorMisclass*)err;
 
-				CUniString regId = merge->GetLayoutObject();
-				CLayoutObject * region1 = m_Results->GetDocumentLayoutObject(regId, true);
+			CUniString regId = misclass->GetLayoutObject();
+			CLayoutObject * region1 = m_Results->GetDocumentLayoutObject(regId, true);
 
-				if (region1->GetLayoutObjectType() != CLayoutObject::TYPE_LAYOUT_REGION
-					||	(((CLayoutRegion*)region1)->GetType() & m_LayoutRegionType) != 0) //Type filter
-				{
-					//Get type and subtype of region 1
-					int regionType1 = region1->GetLayoutObjectType();
-					CUniString subType1;
-					if (regionType1 == CLayoutObject::TYPE_LAYOUT_REGION)
-					{
-						CLayoutRegion * layoutReg = (CLayoutRegion*)region1;
-						layoutRegionType1 = layoutReg->GetType();
-						subType1 = CLayoutEvaluation::GetLayoutRegionSubtype(layoutReg, m_Profile);
-					}
+			weighted.m_FilterObject = region1;
 
-					//Get the seperate error for each merged region
-					map<CUniString, COverlapRects *> * mergingRegions = merge->GetMergingRegions();
+			//Get type and weight slot of region 1
+			int regionType1 = region1->GetLayoutObjectType();
+			int slot1 = -1;
+			if (regionType1 == CLayoutObject::TYPE_LAYOUT_REGION)
+			{
+				CLayoutRegion * layoutReg = (CLayoutRegion*)region1;
+				layoutRegionType1 = layoutReg->GetType();
+				slot1 = m_Results->GetWeightSlot(layoutReg, true);
+			}
+			else
+				slot1 = weights->GetSlot(layoutRegionType1, CUniString());
 
-					map<CUniString, COverlapRects *>::iterator itMergingRegions = mergingRegions->begin();
-					while (itMergingRegions != mergingRegions->end())
-					{
-						COverlapRects * overlap = (*itMergingRegions).second;
-						vector<CUniString> * regions2 = overlap->GetRegions();
-
-						double overlapWeight = 0.0;
-						overlapWeight = 1.0 / ((double)regions2->size()); // - 1.0);  //CC 21.7.10 The -1 is not needed anymore
-						//if (m_UsePixelArea)
-						//	overlapWeight = (double)overlap->GetOverlapPixelCount(region1) / (double)overlap->GetPixelCount();
-						//else
-						//	overlapWeight = (double)overlap->GetOverlapArea(region1) / (double)overlap->GetArea();
-
-						for (unsigned int i=0; i<regions2->size() ;i++)
-						{
-							CUniString regId2 = regions2->at(i);
-							CLayoutObject * region2 = m_Results->GetDocumentLayoutObject(regId2, true);
-
-							if (region2 == region1) //region1 isn't used for the error
-								continue;
-
-							allowable = merge->IsAllowable(regId2);
-
-							//Get type and subtype of region 2
-							int regionType2 = region2->GetLayoutObjectType();
-							int layoutRegionType2 = CLayoutRegion::TYPE_INVALID;
-							CUniString subType2;
-							if (regionType2 == CLayoutObject::TYPE_LAYOUT_REGION)
-							{
-								CLayoutRegion * layoutReg = (CLayoutRegion*)region2;
-								layoutRegionType2 = layoutReg->GetType();
-								subType2 = CLayoutEvaluation::GetLayoutRegionSubtype(layoutReg, m_Profile);
-							}
-
-							//Error Type Weight
-							if (m_Results->GetLayoutObjectType() == CLayoutObject::TYPE_READING_ORDER_GROUP)
-								weight = m_Profile->GetErrorTypeWeightForReadingOrderGroup(errorType);
-							else if (m_Results->GetLayoutObjectType() != CLayoutObject::TYPE_LAYOUT_REGION) //Text line, word, glyph
-								weight = m_Profile->GetErrorTypeWeightForTextSubStructure(errorType, regionType1);
-							else if (!subType1.IsEmpty() && !subType2.IsEmpty())
-								weight = m_Profile->GetErrorTypeWeight(errorType, layoutRegionType1, subType1, 
-																		layoutRegionType2, subType2, allowable);
-							else if (!subType1.IsEmpty())
-								weight = m_Profile->GetErrorTypeWeight(errorType, layoutRegionType1, subType1, 
-																		layoutRegionType2, allowable);
-							else if (!subType2.IsEmpty())
-								weight = m_Profile->GetErrorTypeWeight(errorType, layoutRegionType1, 
-																		layoutRegionType2, subType2, allowable);
-							else
-								weight = m_Profile->GetErrorTypeWeight(errorType, layoutRegionType1, 
-																		layoutRegionType2, allowable);
-							//Region Type Weight
-							if (m_Results->GetLayoutObjectType() == CLayoutObject::TYPE_LAYOUT_REGION)
-							{
-								if (subType1.IsEmpty())
-									weight *= m_Profile->GetRegionTypeWeight(layoutRegionType1);
-								else
-									weight *= m_Profile->GetRegionTypeWeight(layoutRegionType1, subType1);
-							}
-
-							//Apply overlap weight
-							//  The overlap weight is the 1 / (number of involved regions - 1)
-							//  The overlap weight is used to avoid double penalizing merge errors 
-							//  of merges with many regions.
-							weight *= overlapWeight;
-
-							//Area error
-							if (m_UsePixelArea)
-							{
-								weightedArea += weight * overlap->GetOverlapPixelCount(region2->GetId());
-							}
-							else
-							{
-								weightedArea += weight * overlap->GetOverlapArea(region2->GetId());
-							}
-
-							//Count error
-							weightedCount += weight;
-
-						}
-						delete regions2;
-
-						itMergingRegions++;
-					}
+			//Get the seperate error for each misclassified region
+			COverlapRects * overlap = misclass->GetMisclassRegions();
+			vector<CUniString> * regions2 = overlap->GetRegions();
 
-					//Set the weighted error
-					err->SetWeightedAreaError(weightedArea);
-					err->SetWeightedCountError(weightedCount);
-					m_OverallWeightedAreaError += weightedArea;
-					m_OverallWeightedCountError += weightedCount;
-				}
-			}
-			//Misclassification
-			else if (errorType == CLayoutObjectEvaluationError::TYPE_MISCLASS
-				&& 	(m_Results->GetLayoutObjectType() == CLayoutObject::TYPE_LAYOUT_REGION //Misclassification only for layout regions
-				  || m_Results->GetLayoutObjectType() == CLayoutObject::TYPE_READING_ORDER_GROUP)) //or reading order groups
+			for (unsigned int i=0; i<regions2->size() ;i++)
 			{
-				CEvaluationErrorMisclass * misclass = (CEvaluationErrorMisclass*)err;
+				CUniString regId2 = regions2->at(i);
+				CLayoutObject * region2 = m_Results->GetDocumentLayoutObject(regId2, false);
+				//Get weight slot of region 2
+				int regionType2 = region2->GetLayoutObjectType();
+				int slot2 = -1;
+				if (regionType2 == CLayoutObject::TYPE_LAYOUT_REGION)
+					slot2 = m_Results->GetWeightSlot((CLayoutRegion*)region2, false);
+				else
+					slot2 = weights->GetSlot(0, CUniString());
+
+				//Error Type Weight
+				if (m_Results->GetLayoutObjectType() == CLayoutObject::TYPE_READING_ORDER_GROUP)
+					weight = m_Profile->GetErrorTypeWeightForReadingOrderGroup(errorType);
+				else //Layout region (with or without subtypes)
+					weight = weights->GetErrorTypeWeight(errorType, slot1, slot2, allowable);
+				//Region Type Weight
+				if (m_Results->GetLayoutObjectType() == CLayoutObject::TYPE_LAYOUT_REGION)
+					weight *= weights->GetRegionTypeWeight(slot1);
+
+				//Area error
+				if (m_UsePixelArea)
+				{
+					weightedArea += weight * overlap->GetOverlapPixelCount(region2->GetId());
+				}
+				else
+				{
+					weightedArea += weight * overlap->GetOverlapArea(region2->GetId());
+				}
 
-				CUniString regId = misclass->GetLayoutObject();
-				CLayoutObject * region1 = m_Results->GetDocumentLayoutObject(regId, true);
+				//Count error
+				weightedCount += weight;
+			}
+			delete regions2;
+		}
+	}
 
-				if (region1->GetLayoutObjectType() != CLayoutObject::TYPE_LAYOUT_REGION
-					||	(((CLayoutRegion*)region1)->GetType() & m_LayoutRegionType) != 0) //Type filter
-				{
-					//Get type and subtype of region 1
-					int regionType1 = region1->GetLayoutObjectType();
-					CUniString subType1;
-					if (regionType1 == CLayoutObject::TYPE_LAYOUT_REGION)
-					{
-						CLayoutRegion * layoutReg = (CLayoutRegion*)region1;
-						layoutRegionType1 = layoutReg->GetType();
-						subType1 = CLayoutEvaluation::GetLayoutRegionSubtype(layoutReg, m_Profile);
-					}
+	weighted.m_LayoutRegionType = layoutRegionType1;
+	weighted.m_WeightedArea = weightedArea;
+	weighted.m_WeightedCount = weightedCount;
+}
 
-					//Get the seperate error for each misclassified region
-					COverlapRects * overlap = misclass->GetMisclassRegions();
-					vector<CUniString> * regions2 = overlap->GetRegions();
+/*
+ * Adds the given weighted error to the overall errors, if the involved object passes the region type filter.
+ * Errors that don't pass are added with zero values (as for false alarms).
+ */
+void CLayoutObjectEvaluationMetrics::AddWeightedError(CWeightedError & weighted)
+{
+	int errorType = weighted.m_ErrorType;
+	int layoutRegionType1 = CLayoutRegion::TYPE_INVALID;
+	double weightedArea = 0.0;
+	double weightedCount = 0.0;
 
-					for (unsigned int i=0; i<regions2->size() ;i++)
-					{
-						CUniString regId2 = regions2->at(i);
-						CLayoutObject * region2 = m_Results->GetDocumentLayoutObject(regId2, false);
-						//Get type and subtype of region 2
-						int regionType2 = region2->GetLayoutObjectType();
-						int layoutRegionType2 = 0;
-						CUniString subType2;
-						if (regionType2 == CLayoutObject::TYPE_LAYOUT_REGION)
-						{
-							CLayoutRegion * layoutReg = (CLayoutRegion*)region2;
-							layoutRegionType2 = layoutReg->GetType();
-							subType2 = CLayoutEvaluation::GetLayoutRegionSubtype(layoutReg, m_Profile);
-						}
-
-						//Error Type Weight
-						if (m_Results->GetLayoutObjectType() == CLayoutObject::TYPE_READING_ORDER_GROUP)
-							weight = m_Profile->GetErrorTypeWeightForReadingOrderGroup(errorType);
-						else //Layout region
-						{
-							if (!subType1.IsEmpty() && !subType2.IsEmpty())
-								weight = m_Profile->GetErrorTypeWeight(errorType, layoutRegionType1, subType1,
-									layoutRegionType2, subType2, allowable);
-							else if (!subType1.IsEmpty())
-								weight = m_Profile->GetErrorTypeWeight(errorType, layoutRegionType1, subType1,
-									layoutRegionType2, allowable);
-							else if (!subType2.IsEmpty())
-								weight = m_Profile->GetErrorTypeWeight(errorType, layoutRegionType1,
-									layoutRegionType2, subType2, allowable);
-							else
-								weight = m_Profile->GetErrorTypeWeight(errorType, layoutRegionType1,
-									layoutRegionType2, allowable);
-						}
-						//Region Type Weight
-						if (m_Results->GetLayoutObjectType() == CLayoutObject::TYPE_LAYOUT_REGION)
-						{
-							if (subType1.IsEmpty())
-								weight *= m_Profile->GetRegionTypeWeight(layoutRegionType1);
-							else
-								weight *= m_Profile->GetRegionTypeWeight(layoutRegionType1, subType1);
-						}
-
-						//Area error
-						if (m_UsePixelArea)
-						{
-							weightedArea += weight * overlap->GetOverlapPixelCount(region2->GetId());
-						}
-						else
-						{
-							weightedArea += weight * overlap->GetOverlapArea(region2->GetId());
-						}
-
-						//Count error
-						weightedCount += weight;
-					}
-					delete regions2;
+	if (weighted.m_FilterObject != NULL && PassesTypeFilter(weighted.m_FilterObject, false))
+	{
+		layoutRegionType1 = weighted.m_LayoutRegionType;
+		weightedArea = weighted.m_WeightedArea;
+		weightedCount = weighted.m_WeightedCount;
+
+		weighted.m_Error->SetWeightedAreaError(weightedArea);
+		weighted.m_Error->SetWeightedCountError(weightedCount);
+		m_OverallWeightedAreaError += weightedArea;
+		m_OverallWeightedCountError += weightedCount;
+	}
 
-					//Set the weighted error
-					err->SetWeightedAreaError(weightedArea);
-					err->SetWeightedCountError(weightedCount);
-					m_OverallWeightedAreaError += weightedArea;
-					m_OverallWeightedCountError += weightedCount;
-				}
-			}
-		}
+	//Overall area error per error type
+	map<int, double>::iterator itErr = m_OverallWeightedAreaErrorPerErrorType.find(errorType);
+	if (itErr == m_OverallWeightedAreaErrorPerErrorType.end()) //Not found
+		m_OverallWeightedAreaErrorPerErrorType.insert(pair<int, double>(errorType, weightedArea));
+	else
+		(*itErr).second += weightedArea;
+	//Overall count error per error type
+	itErr = m_OverallWeightedCountErrorPerErrorType.find(errorType);
+	if (itErr == m_OverallWeightedCountErrorPerErrorType.end()) //Not found
+		m_OverallWeightedCountErrorPerErrorType.insert(pair<int, double>(errorType, weightedCount));
+	else
+		(*itErr).second += weightedCount;
 
-		//Overall area error per error type
-		map<int, double>::iterator itErr = m_OverallWeightedAreaErrorPerErrorType.find(errorType);
-		if (itErr == m_OverallWeightedAreaErrorPerErrorType.end()) //Not found
-			m_OverallWeightedAreaErrorPerErrorType.insert(pair<int, double>(errorType, weightedArea));
+	if (m_Results->GetLayoutObjectType() == CLayoutObject::TYPE_LAYOUT_REGION)
+	{
+		//Overall area error per region type
+		itErr = m_OverallWeightedAreaErrorPerRegionType.find(layoutRegionType1);
+		if (itErr == m_OverallWeightedAreaErrorPerRegionType.end()) //Not found
+			m_OverallWeightedAreaErrorPerRegionType.insert(pair<int, double>(layoutRegionType1, weightedArea));
 		else
 			(*itErr).second += weightedArea;
-		//Overall count error per error type
-		itErr = m_OverallWeightedCountErrorPerErrorType.find(errorType);
-		if (itErr == m_OverallWeightedCountErrorPerErrorType.end()) //Not found
-			m_OverallWeightedCountErrorPerErrorType.insert(pair<int, double>(errorType, weightedCount));
+		//Overall count error per region type
+		itErr = m_OverallWeightedCountErrorPerRegionType.find(layoutRegionType1);
+		if (itErr == m_OverallWeightedCountErrorPerRegionType.end()) //Not found
+			m_OverallWeightedCountErrorPerRegionType.insert(pair<int, double>(layoutRegionType1, weightedCount));
 		else
 			(*itErr).second += weightedCount;
-
-		if (m_Results->GetLayoutObjectType() == CLayoutObject::TYPE_LAYOUT_REGION)
-		{
-			//Overall area error per region type
-			itErr = m_OverallWeightedAreaErrorPerRegionType.find(layoutRegionType1);
-			if (itErr == m_OverallWeightedAreaErrorPerRegionType.end()) //Not found
-				m_OverallWeightedAreaErrorPerRegionType.insert(pair<int, double>(layoutRegionType1, weightedArea));
-			else
-				(*itErr).second += weightedArea;
-			//Overall count error per region type
-			itErr = m_OverallWeightedCountErrorPerRegionType.find(layoutRegionType1);
-			if (itErr == m_OverallWeightedCountErrorPerRegionType.end()) //Not found
-				m_OverallWeightedCountErrorPerRegionType.insert(pair<int, double>(layoutRegionType1, weightedCount));
-			else
-				(*itErr).second += weightedCount;
-		}
 	}
+}
 
+/*
+ * Calculates the success rates from the overall weighted errors per error type
+ */
+void CLayoutObjectEvaluationMetrics::CalculateWeightedSuccessRates()
+{
 	//Area Success Rates
 	map<int, double>::iterator itErr = m_OverallWeightedAreaErrorPerErrorType.begin();
 	while (itErr != m_OverallWeightedAreaErrorPerErrorType.end())
@@ -1221,166 +1272,89 @@ void CLayoutObjectEvaluationMetrics::CalculateReadingOrderError()
 
 /*
  * Simple counting of errors without applying weights.
+ * The errors are counted for this metrics object and the given region type specific metrics (optional) in one pass.
+ * If 'typeMetricsOnly' is set, the rates of this object are not changed.
  */
-void CLayoutObjectEvaluationMetrics::CalculateSimpleCountBasedErrorRates()
+void CLayoutObjectEvaluationMetrics::CalculateSimpleCountBasedErrorRates(vector<CLayoutObjectEvaluationMetrics*> * typeMetrics, bool typeMetricsOnly /*= false*/)
 {
-	map<CUniString, CLayoutObjectEvaluationError*> * errmap = NULL;
-	int count = 0;
-	int maximum = 0;
-
-	//False Detection
-	errmap = m_Results->GetRegionsForErrorType(CLayoutObjectEvaluationError::TYPE_INVENT);
-	count = 0;
-	if (errmap != NULL)
-	{
-		if (m_LayoutRegionType == CLayoutRegion::TYPE_ALL)
-			count = (int)errmap->size();
-		else //special layout region type (image, table, ...)
-		{
-			map<CUniString, CLayoutObjectEvaluationError*>::iterator it = errmap->begin();
-			while (it != errmap->end())
-			{
-				CLayoutObject * region = m_Results->GetDocumentLayoutObject((*it).first, false);
-				if (region->GetLayoutObjectType() == CLayoutObject::TYPE_LAYOUT_REGION
-					&& (((CLayoutRegion*)region)->GetType() & m_LayoutRegionType) != 0)
-					count++;
-				it++;
-			}
-		}
-	}
-	maximum = m_ImageArea / 100; //TODO make configurable
-	if (count > maximum)
-		count = maximum;
-	maximum = max(maximum, 1);
-	//TODO use logarithmic function
-	m_ErrorRatePerTypeBasedOnSimpleCount.insert(pair<int,double>(CLayoutObjectEvaluationError::TYPE_INVENT, 
-											(double)count / (double)maximum));
-	
-	//Merge
-	errmap = m_Results->GetRegionsForErrorType(CLayoutObjectEvaluationError::TYPE_MERGE);
-	count = 0;
-	if (errmap != NULL)
+	vector<int> errorTypes;
+	errorTypes.push_back(CLayoutObjectEvaluationError::TYPE_INVENT);
+	errorTypes.push_back(CLayoutObjectEvaluationError::TYPE_MERGE);
+	if (m_Results->GetLayoutObjectType() == CLayoutObject::TYPE_LAYOUT_REGION  //Only on block level (not line, word or glyph)
+		|| m_Results->GetLayoutObjectType() == CLayoutObject::TYPE_READING_ORDER_GROUP) //Or group
 	{
-		if (m_LayoutRegionType == CLayoutRegion::TYPE_ALL)
-			count = (int)errmap->size();
-		else //special layout region type (image, table, ...)
-		{
-			map<CUniString, CLayoutObjectEvaluationError*>::iterator it = errmap->begin();
-			while (it != errmap->end())
-			{
-				CLayoutObject * region = m_Results->GetDocumentLayoutObject((*it).first, true);
-				if (region->GetLayoutObjectType() == CLayoutObject::TYPE_LAYOUT_REGION
-					&& (((CLayoutRegion*)region)->GetType() & m_LayoutRegionType) != 0)
-					count++;
-				it++;
-			}
-		}
+		errorTypes.push_back(CLayoutObjectEvaluationError::TYPE_MISCLASS);
 	}
-	maximum = max(m_NumberOfGroundTruthRegions, 1); //Is fixed
-	m_ErrorRatePerTypeBasedOnSimpleCount.insert(pair<int,double>(CLayoutObjectEvaluationError::TYPE_MERGE, 
-											(double)count / (double)maximum));
+	errorTypes.push_back(CLayoutObjectEvaluationError::TYPE_MISS);
+	errorTypes.push_back(CLayoutObjectEvaluationError::TYPE_PART_MISS);
+	errorTypes.push_back(CLayoutObjectEvaluationError::TYPE_SPLIT);
 
-	//Misclass
-	if (m_Results->GetLayoutObjectType() == CLayoutObject::TYPE_LAYOUT_REGION  //Only on block level (not line, word or glyph)
-		|| m_Results->GetLayoutObjectType() == CLayoutObject::TYPE_READING_ORDER_GROUP) //Or group
+	unsigned int typeMetricsCount = typeMetrics != NULL ? (unsigned int)typeMetrics->size() : 0;
+	vector<int> typeCounts(typeMetricsCount);
+
+	for (unsigned int e=0; e<errorTypes.size(); e++)
 	{
-		errmap = m_Results->GetRegionsForErrorType(CLayoutObjectEvaluationError::TYPE_MISCLASS);
-		count = 0;
+		int errorType = errorTypes[e];
+		map<CUniString, CLayoutObjectEvaluationError*> * errmap = m_Results->GetRegionsForErrorType(errorType);
+		int count = 0;
+		typeCounts.assign(typeMetricsCount, 0);
 		if (errmap != NULL)
 		{
 			if (m_LayoutRegionType == CLayoutRegion::TYPE_ALL)
 				count = (int)errmap->size();
-			else //special layout region type (image, table, ...)
+
+			if (m_LayoutRegionType != CLayoutRegion::TYPE_ALL || typeMetricsCount > 0) //special layout region type (image, table, ...)
 			{
 				map<CUniString, CLayoutObjectEvaluationError*>::iterator it = errmap->begin();
 				while (it != errmap->end())
 				{
-					CLayoutObject * region = m_Results->GetDocumentLayoutObject((*it).first, true);
-					if (region->GetLayoutObjectType() == CLayoutObject::TYPE_LAYOUT_REGION
-						&& (((CLayoutRegion*)region)->GetType() & m_LayoutRegionType) != 0)
+					CLayoutObject * region = m_Results->GetDocumentLayoutObject((*it).first, errorType != CLayoutObjectEvaluationError::TYPE_INVENT);
+					if (m_LayoutRegionType != CLayoutRegion::TYPE_ALL && PassesTypeFilter(region, true))
 						count++;
+					for (unsigned int i=0; i<typeMetricsCount; i++)
+						if (typeMetrics->at(i)->PassesTypeFilter(region, true))
+							typeCounts[i]++;
 					it++;
 				}
 			}
 		}
-		maximum = max(m_NumberOfGroundTruthRegions, 1); //Is fixed
-		m_ErrorRatePerTypeBasedOnSimpleCount.insert(pair<int,double>(CLayoutObjectEvaluationError::TYPE_MISCLASS, 
-												(double)count / (double)maximum));
+		if (!typeMetricsOnly)
+			SetSimpleCountBasedErrorRate(errorType, count);
+		for (unsigned int i=0; i<typeMetricsCount; i++)
+			typeMetrics->at(i)->SetSimpleCountBasedErrorRate(errorType, typeCounts[i]);
 	}
 
-	//Miss
-	errmap = m_Results->GetRegionsForErrorType(CLayoutObjectEvaluationError::TYPE_MISS);
-	count = 0;
-	if (errmap != NULL)
-	{
-		if (m_LayoutRegionType == CLayoutRegion::TYPE_ALL)
-			count = (int)errmap->size();
-		else //special layout region type (image, table, ...)
-		{
-			map<CUniString, CLayoutObjectEvaluationError*>::iterator it = errmap->begin();
-			while (it != errmap->end())
-			{
-				CLayoutObject * region = m_Results->GetDocumentLayoutObject((*it).first, true);
-				if (region->GetLayoutObjectType() == CLayoutObject::TYPE_LAYOUT_REGION
-					&& (((CLayoutRegion*)region)->GetType() & m_LayoutRegionType) != 0)
-					count++;
-				it++;
-			}
-		}
-	}
-	maximum = max(m_NumberOfGroundTruthRegions, 1); //Is fixed
-	m_ErrorRatePerTypeBasedOnSimpleCount.insert(pair<int,double>(CLayoutObjectEvaluationError::TYPE_MISS, 
-											(double)count / (double)maximum));
-
-	//Partial Miss
-	errmap = m_Results->GetRegionsForErrorType(CLayoutObjectEvaluationError::TYPE_PART_MISS);
-	count = 0;
-	if (errmap != NULL)
-	{
-		if (m_LayoutRegionType == CLayoutRegion::TYPE_ALL)
-			count = (int)errmap->size();
-		else //special layout region type (image, table, ...)
-		{
-			map<CUniString, CLayoutObjectEvaluationError*>::iterator it = errmap->begin();
-			while (it != errmap->end())
-			{
-				CLayoutObject * region = m_Results->GetDocumentLayoutObject((*it).first, true);
-				if (region->GetLayoutObjectType() == CLayoutObject::TYPE_LAYOUT_REGION
-					&& (((CLayoutRegion*)region)->GetType() & m_LayoutRegionType) != 0)
-					count++;
-				it++;
-			}
-		}
-	}
-	maximum = max(m_NumberOfGroundTruthRegions, 1); //Is fixed
-	m_ErrorRatePerTypeBasedOnSimpleCount.insert(pair<int,double>(CLayoutObjectEvaluationError::TYPE_PART_MISS, 
-											(double)count / (double)maximum));
-
-	//Split
-	errmap = m_Results->GetRegionsForErrorType(CLayoutObjectEvaluationError::TYPE_SPLIT);
-	count = 0;
-	if (errmap != NULL)
+	if (!typeMetricsOnly)
+		CalculateOverallSimpleCountBasedErrorRate();
+	for (unsigned int i=0; i<typeMetricsCount; i++)
+		typeMetrics->at(i)->CalculateOverallSimpleCountBasedErrorRate();
+}
+
+/*
+ * Sets the simple error rate for the given error type (error count relative to a maximum).
+ */
+void CLayoutObjectEvaluationMetrics::SetSimpleCountBasedErrorRate(int errorType, int count)
+{
+	int maximum = 0;
+	if (errorType == CLayoutObjectEvaluationError::TYPE_INVENT)
 	{
-		if (m_LayoutRegionType == CLayoutRegion::TYPE_ALL)
-			count = (int)errmap->size();
-		else //special layout region type (image, table, ...)
-		{
-			map<CUniString, CLayoutObjectEvaluationError*>::iterator it = errmap->begin();
-			while (it != errmap->end())
-			{
-				CLayoutObject * region = m_Results->GetDocumentLayoutObject((*it).first, true);
-				if (region->GetLayoutObjectType() == CLayoutObject::TYPE_LAYOUT_REGION
-					&& (((CLayoutRegion*)region)->GetType() & m_LayoutRegionType) != 0)
-					count++;
-				it++;
-			}
-		}
+		maximum = m_ImageArea / 100; //TODO make configurable
+		if (count > maximum)
+			count = maximum;
+		maximum = max(maximum, 1);
+		//TODO use logarithmic function
 	}
-	maximum = max(m_NumberOfGroundTruthRegions, 1); //Is fixed
-	m_ErrorRatePerTypeBasedOnSimpleCount.insert(pair<int,double>(CLayoutObjectEvaluationError::TYPE_SPLIT, 
-											(double)count / (double)maximum));
+	else
+		maximum = max(m_NumberOfGroundTruthRegions, 1); //Is fixed
 
-	//Overall
+	m_ErrorRatePerTypeBasedOnSimpleCount.insert(pair<int,double>(errorType, (double)count / (double)maximum));
+}
+
+/*
+ * Average of the simple error rates of all error types
+ */
+void CLayoutObjectEvaluationMetrics::CalculateOverallSimpleCountBasedErrorRate()
+{
 	map<int,double>::iterator it = m_ErrorRatePerTypeBasedOnSimpleCount.begin();
 	double overall = 0.0;
 	while (it != m_ErrorRatePerTypeBasedOnSimpleCount.end())
@@ -1582,10 +1556,10 @@ void CLayoutObjectEvaluationMetrics::CalculateRecallAndPrecision()
 		return;
 	}
 
-	COpenCvBiLevelImage * image = m_Results->GetLayoutEvaluation()->GetBilevelImage();
+	CLayoutEvaluation * layoutEval = m_Results->GetLayoutEvaluation();
 	CLayoutObjectIterator * it = CLayoutObjectIterator::GetLayoutObjectIterator(m_Results->GetLayoutEvaluation()->GetGroundTruth(),
 																m_Results->GetLayoutObjectType());
-	int overallRecallAreaNonStrict = 0;
+	long overallRecallAreaNonStrict = 0L;
 	CLayoutObject * groundTruthReg;
 	int gtLayoutRegType;
 	//Iterate over all regions
@@ -1618,16 +1592,14 @@ void CLayoutObjectEvaluationMetrics::CalculateRecallAndPrecision()
 		}
 
 		//Get overlapping segmentation result regions
-		set<CUniString> * overlappingRegions = m_Results->GetGroundTruthOverlaps(groundTruthReg->GetId());
+		COverlapRow * overlappingRegions = m_Results->GetGroundTruthOverlaps(groundTruthReg->GetId());
 
 		if (overlappingRegions != NULL && overlappingRegions->size() > 0)
 		{
 			CLayoutObjectOverlap * overlap = NULL;
 			if (overlappingRegions->size() == 1) //only one region overlaps -> look in the single overlap map
 			{
-				CUniString segResRegionId = (*overlappingRegions->begin());
-				CLayoutObject * segResultRegion = m_Results->GetDocumentLayoutObject(segResRegionId, false);
-				overlap = m_Results->GetOverlapIntervalRep(groundTruthReg->GetId(), segResultRegion->GetId());
+				overlap = overlappingRegions->GetEntry(0)->m_Overlap;
 			}
 			else //more than one region overlap -> look in the multi overlap map
 			{
@@ -1655,17 +1627,14 @@ void CLayoutObjectEvaluationMetrics::CalculateRecallAndPrecision()
 					//Pixel Count
 					if (m_UsePixelArea)
 					{
-						int pixelCount = 0;
+						long pixelCount = 0L;
 						if (rects != NULL && !rects->empty()) //Found recalled intervall rects
-						{
-							if (image != NULL)
-								pixelCount = image->CountPixels(rects, true);
-						}
+							pixelCount = layoutEval->CountPixels(rects, true);
 						map<int,int>::iterator itCount = m_RecallPixelCountPerType.find(gtLayoutRegType);
 						if (itCount == m_RecallPixelCountPerType.end()) //not in map yet
-							m_RecallPixelCountPerType.insert(pair<int,int>(gtLayoutRegType, pixelCount));
+							m_RecallPixelCountPerType.insert(pair<int,int>(gtLayoutRegType, (int)pixelCount));
 						else //already in map
-							(*itCount).second += pixelCount;
+							(*itCount).second += (int)pixelCount;
 					}
 
 					for (unsigned int i=0; i<rects->size(); i++)
@@ -1677,12 +1646,9 @@ void CLayoutObjectEvaluationMetrics::CalculateRecallAndPrecision()
 				vector<CRect *> * rects = overlap->GetRecalledRects(groundTruthReg, false);
 				if (rects != NULL && !rects->empty()) //Found recalled intervall rects
 				{
-					int area = 0;
+					long area = 0L;
 					if (m_UsePixelArea) //Pixel Count
-					{
-						if (image != NULL)
-							area = image->CountPixels(rects, true);
-					}
+						area = layoutEval->CountPixels(rects, true);
 					else //Area
 					{
 						for (unsigned int i=0; i<rects->size(); i++)
@@ -1909,18 +1875,18 @@ void CLayoutObjectEvaluationMetrics::CalculateOCRSuccessRate()
 
 		//Find overlapping glyphs from the segmentation result
 		glyph2 = NULL;
-		set<CUniString> * overlappingRegions = m_Results->GetGroundTruthOverlaps(glyph1->GetId());
+		COverlapRow * overlappingRegions = m_Results->GetGroundTruthOverlaps(glyph1->GetId());
 		if (overlappingRegions != NULL)
 		{
 			//Find the most overlapping glyph
 			long maxOverlapArea = 0;
 			CGlyph * curr = NULL;
-			for (set<CUniString>::iterator it2 = overlappingRegions->begin(); it2 != overlappingRegions->end(); it2++)
+			for (COverlapRow::iterator it2 = overlappingRegions->begin(); it2 != overlappingRegions->end(); it2++)
 			{
 				curr = (CGlyph*)segResult->FindLayoutObject(CLayoutObject::TYPE_GLYPH, (*it2));
 				if (curr == NULL)
 					continue;
-				CLayoutObjectOverlap * overlap = m_Results->GetOverlapIntervalRep(glyph1->GetId(), curr->GetId());
+				CLayoutObjectOverlap * overlap = it2.GetEntry()->m_Overlap;
 				if (overlap != NULL && overlap->GetOverlapArea() > maxOverlapArea)
 				{
 					maxOverlapArea = overlap->GetOverlapArea();
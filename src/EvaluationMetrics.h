@@ -15,6 +15,7 @@ namespace PRImA
 class CFunction;
 class CEvaluationResults;
 class CEvaluationProfile;
+class CEvaluationWeightTable;
 
 /*
  * Class CEvaluationMetrics
@@ -109,6 +110,9 @@ public:
 						CLayoutObjectEvaluationMetrics * metricsForAllTypes = NULL);
 	~CLayoutObjectEvaluationMetrics();
 
+	void Calculate(std::vector<CLayoutObjectEvaluationMetrics*> * typeMetrics = NULL);
+	void CalculateTypeMetrics(std::vector<CLayoutObjectEvaluationMetrics*> * typeMetrics);
+
 	inline int GetRegionType() { return m_LayoutRegionType; };
 
 	//*** General figures ***//
@@ -248,10 +252,30 @@ public:
 	inline void SetGlyphStatistics(CGlyphStatistics * statistics) { delete m_GlyphStatistics; m_GlyphStatistics = statistics; };
 
 private:
-	void CalculateGeneralFigures();
-	void CalculateWeightedErrors();
+	/*
+	 * Weighted values of one error, independent of the region type filter
+	 */
+	struct CWeightedError
+	{
+		CLayoutObjectEvaluationError *	m_Error;
+		int				m_ErrorType;
+		CLayoutObject *	m_FilterObject;		//Object the region type filter is applied to (NULL if the error has no weighted values)
+		int				m_LayoutRegionType;	//Region type for the errors per region type
+		double			m_WeightedArea;
+		double			m_WeightedCount;
+	};
+
+	void CalculateGeneralFigures(std::vector<CLayoutObjectEvaluationMetrics*> * typeMetrics, bool typeMetricsOnly = false);
+	void CountRegionFigures();
+	void AddRegionFigures(CLayoutObject * object, bool groundTruth, long area, long pixelCount);
+	void CalculateWeightedErrors(std::vector<CLayoutObjectEvaluationMetrics*> * typeMetrics, bool typeMetricsOnly = false);
+	void WeightError(CLayoutObjectEvaluationError * err, CEvaluationWeightTable * weights, CWeightedError & weighted);
+	void AddWeightedError(CWeightedError & weighted);
+	void CalculateWeightedSuccessRates();
 	void CalculateReadingOrderError();
-	void CalculateSimpleCountBasedErrorRates();
+	void CalculateSimpleCountBasedErrorRates(std::vector<CLayoutObjectEvaluationMetrics*> * typeMetrics, bool typeMetricsOnly = false);
+	void SetSimpleCountBasedErrorRate(int errorType, int count);
+	void CalculateOverallSimpleCountBasedErrorRate();
 	void CalculateOverallSuccessRate();
 	void CalculateRecallAndPrecision();
 	void CalculateOCRSuccessRate();
@@ -264,6 +288,8 @@ private:
 	void SetWeightedAreaInfluencePerType(int errorType, double influence);
 	void SetWeightedCountInfluencePerType(int errorType, double influence);
 
+	bool PassesTypeFilter(CLayoutObject * object, bool layoutRegionsOnly);
+
 	bool IsDigitCharacter(CUniString c);
 	bool IsNumericalCharacter(CUniString c);
 
@@ -7,6 +7,7 @@
 
 #include "stdafx.h"
 #include "EvaluationProfile.h"
+#include "EvaluationWeightTable.h"
 
 using namespace PRImA;
 using namespace std;
@@ -125,6 +126,11 @@ CEvaluationProfile::CEvaluationProfile(CXmlValidator * pageLayoutXmlValidator)
 		"Maximum bounding box overlap in pixels for split/merge allowable check",
 		20, 0, 200, 1); //(init, min, max, step)
 
+	m_UseLabelRaster.Init(PARAM_USE_LABEL_RASTER,
+		"Use label raster",
+		"Calculate overlap areas and pixel counts by rasterising all regions into label planes (faster for pages with many regions)",
+		false);
+
 	//General settings parameter map
 	m_GeneralSettings.Add(&m_UsePixelArea);
 	m_GeneralSettings.Add(&m_ReadingOrientationThreshold);
@@ -136,6 +142,7 @@ CEvaluationProfile::CEvaluationProfile(CXmlValidator * pageLayoutXmlValidator)
 	m_GeneralSettings.Add(&m_DefaultTextType);
 	m_GeneralSettings.Add(&m_IgnoreEmbeddedTextMisclass);
 	m_GeneralSettings.Add(&m_EvaluateNestedRegions);
+	m_GeneralSettings.Add(&m_UseLabelRaster);
 
 	m_ReadingOrderWeight = NULL;
 	m_IncludedBackgroundBorderWeight = NULL;
@@ -464,6 +471,7 @@ void CEvaluationProfile::Reset()
 	m_DefaultReadingOrientation.SetValue(0.0);
 	m_DefaultReadingOrientationUsage.SetValue(CUniString(USAGE_AS_DEFINED_IN_GROUNDTRUTH));
 	m_IgnoreEmbeddedTextMisclass.SetValue(false);
+	m_UseLabelRaster.SetValue(false);
 
 	//Error type weights
 	map<int, CErrorTypeWeight *>::iterator itErrType = m_ErrorTypeWeights.begin();
@@ -503,6 +511,49 @@ void CEvaluationProfile::Reset()
 	}
 
 	m_FilePath.Clear();
+
+	InvalidateWeightTable();
+}
+
+/*
+ * Compiles a new weight table from the current weight values and makes it the current table (synchronised).
+ * Tables returned earlier are not affected (they are released when the last holder lets go of them).
+ */
+shared_ptr<CEvaluationWeightTable> CEvaluationProfile::CompileWeightTable()
+{
+	shared_ptr<CEvaluationWeightTable> table(new CEvaluationWeightTable(this));
+	CSingleLock lock(&m_WeightTableCriticalSect);
+	lock.Lock();
+	m_WeightTable = table;
+	lock.Unlock();
+	return table;
+}
+
+/*
+ * Returns the current weight table with the flattened error type and region type weights.
+ * The table is compiled if it doesn't exist yet or has been invalidated (synchronised).
+ */
+shared_ptr<CEvaluationWeightTable> CEvaluationProfile::GetWeightTable()
+{
+	CSingleLock lock(&m_WeightTableCriticalSect);
+	lock.Lock();
+	shared_ptr<CEvaluationWeightTable> table = m_WeightTable;
+	lock.Unlock();
+	if (!table)
+		table = CompileWeightTable();
+	return table;
+}
+
+/*
+ * Drops the current weight table (a new one is compiled on next use).
+ * Holders of the old table can keep using it.
+ */
+void CEvaluationProfile::InvalidateWeightTable()
+{
+	CSingleLock lock(&m_WeightTableCriticalSect);
+	lock.Lock();
+	m_WeightTable.reset();
+	lock.Unlock();
 }
 
 /*
@@ -1247,6 +1298,8 @@ void CEvaluationProfile::AddErrorTypeWeight(CErrorTypeWeight * weight)
 		m_ErrorTypeWeights.erase(it);
 	}
 	m_ErrorTypeWeights.insert(pair<int, CErrorTypeWeight*>(weight->GetType(), weight));
+
+	InvalidateWeightTable();
 }
 
 void CEvaluationProfile::AddRegionTypeWeight(CLayoutObjectTypeWeight * weight)
@@ -1258,6 +1311,8 @@ void CEvaluationProfile::AddRegionTypeWeight(CLayoutObjectTypeWeight * weight)
 		m_RegionTypeWeights.erase(it);
 	}
 	m_RegionTypeWeights.insert(pair<int, CLayoutObjectTypeWeight*>(weight->GetType(), weight));
+
+	InvalidateWeightTable();
 }
 
 
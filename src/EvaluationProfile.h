@@ -8,6 +8,7 @@
 
 #include "Parameter.h"
 #include <map>
+#include <memory>
 #include "LayoutEvaluation.h"
 #include "xmlvalidator.h"
 
@@ -22,6 +23,7 @@ class CSubTypeWeight;
 class CReadingOrderWeight;
 class CWeight;
 class CReadingOrderPenalties;
+class CEvaluationWeightTable;
 
 /*
  * Class CEvaluationProfile
@@ -68,6 +70,9 @@ public:
 	//If set to TRUE, nested regions are taken into account, otherwise they are ignored
 	inline bool					IsEvaluateNestedRegions() { return m_EvaluateNestedRegions.GetValue(); };
 
+	//If set to TRUE, overlap areas and pixel counts are calculated with the label raster engine (see CLabelRasterOverlap)
+	inline bool					IsUseLabelRaster() { return m_UseLabelRaster.GetValue(); };
+
 
 	inline std::map<int, CErrorTypeWeight *> * GetErrorTypeWeights() { return &m_ErrorTypeWeights; };
 	inline std::map<int, CLayoutObjectTypeWeight *> * GetRegionTypeWeights() { return &m_RegionTypeWeights; };
@@ -129,6 +134,13 @@ public:
 
 	void Reset();
 
+	//Flattened error type and region type weights for fast lookup (see CEvaluationWeightTable).
+	//A table is a snapshot of the weight values. CompileWeightTable creates a new snapshot (called at the start
+	//of each evaluation run, so changed weight values are picked up). Tables handed out earlier stay valid.
+	std::shared_ptr<CEvaluationWeightTable>	CompileWeightTable();
+	std::shared_ptr<CEvaluationWeightTable>	GetWeightTable();
+	void									InvalidateWeightTable();
+
 	inline CUniString		GetFilePath() { return m_FilePath; };
 	inline void				SetFilePath(CUniString path) { m_FilePath = path; };
 
@@ -215,6 +227,9 @@ private:
 	static const int	PARAM_MAX_OVERLAP_FOR_ALLOWABLE_SPLIT_AND_MERGE = 2010;
 	CIntParameter		m_MaxOverlapForAllowableSplitAndMerge;	//Maximum bounding box overlap in pixels (used for allowable merges and splits)
 
+	static const int	PARAM_USE_LABEL_RASTER = 2011;
+	CBoolParameter		m_UseLabelRaster;	//If set to TRUE, overlap areas and pixel counts are calculated with the label raster engine
+
 	CStringParameter	m_DefaultTextType;
 
 	CParameterMap		m_GeneralSettings;
@@ -240,6 +255,9 @@ private:
 	CXmlValidator	*	m_PageLayoutXmlValidator;
 
 	CReadingOrderPenalties * m_ReadingOrderPenalties;
+
+	std::shared_ptr<CEvaluationWeightTable> m_WeightTable;	//Current compiled weights (empty if not compiled yet)
+	CCriticalSection		m_WeightTableCriticalSect;	//The profile can be shared by several evaluators
 };
 
 
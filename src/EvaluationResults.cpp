@@ -6,6 +6,8 @@
  */
 
 #include "EvaluationResults.h"
+#include "ReadingOrderRelationMatrix.h"
+#include <algorithm>
 
 namespace PRImA
 {
@@ -33,7 +35,13 @@ CEvaluationResults::CEvaluationResults(CLayoutEvaluation * layoutEvaluation,
 	else
 		m_ReadingOrderResults = NULL; //No reading order for lines, words, glyphs
 	m_Metrics = NULL;
+	m_CalculateTypeMetricsOnDemand = false;
 	m_BorderResults = NULL;
+	m_SharedGeometry = NULL;
+	m_GroundTruthIds = NULL;
+	m_SegResultIds = NULL;
+	m_OverlapMatricesValid = true;
+	m_OverlapMapsValid = false;
 }
 
 /*
@@ -41,60 +49,25 @@ CEvaluationResults::CEvaluationResults(CLayoutEvaluation * layoutEvaluation,
  */
 CEvaluationResults::~CEvaluationResults()
 {
-	//Ground truth map
-	map<CUniString, set<CUniString>*>::iterator it = m_GroundTruthOverlaps.begin();
-	while (it != m_GroundTruthOverlaps.end())
-	{
-		delete (*it).second;
-		it++;
-	}
-
-	//Seg result map
-	it = m_SegResultOverlaps.begin();
-	while (it != m_SegResultOverlaps.end())
-	{
-		delete (*it).second;
-		it++;
-	}
-
 	//Overlap Interval Representations
-	map<CUniString, map<CUniString, CLayoutObjectOverlap*>*>::iterator gtIt = m_OverlapIntervalReps.begin();
-	while (gtIt != m_OverlapIntervalReps.end())
-	{
-		map<CUniString, CLayoutObjectOverlap*>* segMap = (*gtIt).second;
-
-		map<CUniString, CLayoutObjectOverlap*>::iterator segIt = segMap->begin();
-		while (segIt != segMap->end())
-		{
-			delete (*segIt).second; //Deletes the interval repr.
-			segIt++;
-		}
-
-		delete segMap; //deletes the map
-		gtIt++;
-	}
+	for (unsigned int i=0; i<m_OverlapIntervalReps.size(); i++)
+		for (unsigned int j=0; j<m_OverlapIntervalReps[i].size(); j++)
+			CEvaluationArena::Delete(m_OverlapIntervalReps[i][j].second); //Deletes the interval repr.
 
 	//Multi Overlap Interval Representations
-	map<CUniString, CLayoutObjectOverlap*>::iterator mIt = m_MultiOverlapIntervalReps.begin();
-	while (mIt != m_MultiOverlapIntervalReps.end())
-	{
-		delete (*mIt).second; //Deletes the interval repr.
-		mIt++;
-	}
+	for (unsigned int i=0; i<m_MultiOverlapIntervalReps.size(); i++)
+		CEvaluationArena::Delete(m_MultiOverlapIntervalReps[i]);
+	ClearOverlapMaps();
 
 	//Interval Representations
-	map<CUniString, CIntervalRepresentation*>::iterator intRepIt = m_GroundTruthIntervalReps.begin();
-	while (intRepIt != m_GroundTruthIntervalReps.end())
-	{
-		delete (*intRepIt).second; //Deletes the interval repr.
-		intRepIt++;
-	}
-	intRepIt = m_SegResultIntervalReps.begin();
-	while (intRepIt != m_SegResultIntervalReps.end())
-	{
-		delete (*intRepIt).second; //Deletes the interval repr.
-		intRepIt++;
-	}
+	for (unsigned int i=0; i<m_GroundTruthIntervalReps.size(); i++)
+		CEvaluationArena::Delete(m_GroundTruthIntervalReps[i]);
+	for (unsigned int i=0; i<m_SegResultIntervalReps.size(); i++)
+		CEvaluationArena::Delete(m_SegResultIntervalReps[i]);
+
+	//Object indices
+	delete m_GroundTruthIds;
+	delete m_SegResultIds;
 
 	//Error Type - regions map
 	map<int, map<CUniString,CLayoutObjectEvaluationError*>*>::iterator itErrTpReg = m_ErrorTypeObjectsMap.begin();
@@ -144,117 +117,246 @@ CBorderEvaluationResults * CEvaluationResults::GetBorderResults(bool create /*=
 
 /*
  * Add an overlap to the object overlap maps.
+ * 'overlap' - Can be NULL
  */
-void CEvaluationResults::AddLayoutObjectOverlap(CUniString groundTruth, CUniString segResult,
+void CEvaluationResults::AddLayoutObjectOverlap(const CUniString & groundTruth, const CUniString & segResult,
 										  CLayoutObjectOverlap * overlap)
 {
-	//Ground truth map
-	map<CUniString, set<CUniString>*>::iterator it = m_GroundTruthOverlaps.find(groundTruth);
+	int groundTruthIndex = GetObjectIndex(groundTruth, true, true);
+	int segResultIndex = GetObjectIndex(segResult, false, true);
+	if (groundTruthIndex >= (int)m_OverlapIntervalReps.size())
+		m_OverlapIntervalReps.resize(groundTruthIndex + 1);
 
-	set<CUniString> * overlaps = NULL;
-	if (it != m_GroundTruthOverlaps.end())
-		overlaps = (*it).second;
-	else
+	m_OverlapMatricesValid = false;
+	m_OverlapMapsValid = false;
+
+	//Keep the first overlap of a pair
+	vector<pair<int, CLayoutObjectOverlap*> > & overlaps = m_OverlapIntervalReps[groundTruthIndex];
+	for (unsigned int i=0; i<overlaps.size(); i++)
 	{
-		overlaps = new set<CUniString>();
-		m_GroundTruthOverlaps.insert(pair<CUniString, set<CUniString>*>(groundTruth, overlaps));
+		if (overlaps[i].first == segResultIndex)
+		{
+			if (overlaps[i].second == NULL)
+				overlaps[i].second = overlap;
+			return;
+		}
 	}
-	overlaps->insert(segResult);
+	overlaps.push_back(pair<int, CLayoutObjectOverlap*>(segResultIndex, overlap));
+}
 
-	//Segmentation result map
-	it = m_SegResultOverlaps.find(segResult);
+/*
+ * Builds the overlap matrices from the added overlaps (for fast lookups).
+ * Called automatically on the first lookup after adding overlaps. Has to be called explicitly
+ * before several threads access the overlaps.
+ * If pixel area is used (see profile), the black pixels of all overlaps are counted as well.
+ */
+void CEvaluationResults::BuildOverlapMatrices()
+{
+	m_OverlapMatricesValid = true;
 
-	overlaps = NULL;
-	if (it != m_SegResultOverlaps.end())
-		overlaps = (*it).second;
-	else
+	vector<pair<int, COverlapMatrixEntry> > entries;
+	bool countPixels = m_Profile != NULL && m_Profile->IsUsePixelArea() && m_LayoutEvaluation != NULL; //(0 if there is no image)
+	for (unsigned int i=0; i<m_OverlapIntervalReps.size(); i++)
 	{
-		overlaps = new set<CUniString>();
-		m_SegResultOverlaps.insert(pair<CUniString, set<CUniString>*>(segResult, overlaps));
+		for (unsigned int j=0; j<m_OverlapIntervalReps[i].size(); j++)
+		{
+			COverlapMatrixEntry entry;
+			entry.m_Index = m_OverlapIntervalReps[i][j].first;
+			entry.m_Overlap = m_OverlapIntervalReps[i][j].second;
+			entry.m_Area = entry.m_Overlap != NULL ? entry.m_Overlap->GetOverlapArea() : -1L;
+			entry.m_PixelCount = countPixels && entry.m_Overlap != NULL ? m_LayoutEvaluation->CountPixels(entry.m_Overlap->GetOverlapRects()) : -1L;
+			entries.push_back(pair<int, COverlapMatrixEntry>((int)i, entry));
+		}
+	}
+	if (entries.empty())
+	{
+		m_GroundTruthOverlapMatrix.Build(0, &entries, NULL, NULL);
+		m_SegResultOverlapMatrix.Build(0, &entries, NULL, NULL);
+		return;
 	}
-	overlaps->insert(groundTruth);
 
-	//Interval Representation
-	if (overlap != NULL)
+	//Ground truth -> segmentation result (entries of a row in ID order)
+	vector<int> segResultOrder;
+	GetIdOrder(m_SegResultIds, &segResultOrder);
+	m_GroundTruthOverlapMatrix.Build(m_GroundTruthIds->GetSize(), &entries, &segResultOrder, m_SegResultIds);
+
+	//Segmentation result -> ground truth
+	entries.clear();
+	m_GroundTruthOverlapMatrix.GetTransposedEntries(&entries);
+	vector<int> groundTruthOrder;
+	GetIdOrder(m_GroundTruthIds, &groundTruthOrder);
+	m_SegResultOverlapMatrix.Build(m_SegResultIds->GetSize(), &entries, &groundTruthOrder, m_GroundTruthIds);
+}
+
+/*
+ * Builds the overlap matrices (area and pixel count of each overlap) and lets the overlaps calculate the rects
+ * they otherwise determine on demand (overlap rects, unique rects of the ground truth object).
+ * Has to be called before several threads access the overlaps, so that the threads only read from the overlap objects.
+ */
+void CEvaluationResults::PrepareOverlaps()
+{
+	if (!m_OverlapMatricesValid)
+		BuildOverlapMatrices();
+
+	for (unsigned int i=0; i<m_OverlapIntervalReps.size(); i++)
 	{
-		AddOverlapIntervalRep(groundTruth, segResult, overlap);
+		for (unsigned int j=0; j<m_OverlapIntervalReps[i].size(); j++)
+		{
+			CLayoutObjectOverlap * overlap = m_OverlapIntervalReps[i][j].second;
+			if (overlap != NULL)
+				overlap->GetOverlapRects();
+		}
+
+		//Unique rects (part. miss): single overlap or multi overlap
+		CLayoutObjectOverlap * overlap = NULL;
+		if (m_OverlapIntervalReps[i].size() == 1)
+			overlap = m_OverlapIntervalReps[i][0].second;
+		else if (i < m_MultiOverlapIntervalReps.size())
+			overlap = m_MultiOverlapIntervalReps[i];
+		CLayoutObject * groundTruthObject = overlap != NULL ? GetDocumentLayoutObject(m_GroundTruthIds->GetId(i), true) : NULL;
+		if (groundTruthObject != NULL)
+			overlap->GetUniqueRects(groundTruthObject);
 	}
 }
 
 /*
- * Returns all overlapping segmentation result regions for the given ground truth region (or NULL).
+ * Calculates the position of each object index when sorting the objects by ID.
  */
-set<CUniString> * CEvaluationResults::GetGroundTruthOverlaps(CUniString groundTruth)
+void CEvaluationResults::GetIdOrder(CLayoutObjectIdTable * ids, vector<int> * order)
 {
-	map<CUniString, set<CUniString>*>::iterator it = m_GroundTruthOverlaps.find(groundTruth);
+	vector<int> sorted(ids->GetSize());
+	for (int i=0; i<ids->GetSize(); i++)
+		sorted[i] = i;
+	sort(sorted.begin(), sorted.end(), [ids](int a, int b) { return ids->GetId(a) < ids->GetId(b); });
 
-	set<CUniString> * ret = NULL;
-	if (it != m_GroundTruthOverlaps.end())
-		ret = (*it).second;
-	return ret;
+	order->resize(sorted.size());
+	for (unsigned int i=0; i<sorted.size(); i++)
+		order->at(sorted[i]) = (int)i;
+}
+
+/*
+ * Returns all overlapping segmentation result regions for the given ground truth region (or NULL).
+ */
+COverlapRow * CEvaluationResults::GetGroundTruthOverlaps(const CUniString & groundTruth)
+{
+	if (!m_OverlapMatricesValid)
+		BuildOverlapMatrices();
+	return m_GroundTruthOverlapMatrix.GetRow(GetObjectIndex(groundTruth, true, false));
 }
 
 /*
  * Returns all overlapping ground truth result regions for the given segmentation region (or NULL).
  */
-set<CUniString> * CEvaluationResults::GetSegResultOverlaps(CUniString segResult)
+COverlapRow * CEvaluationResults::GetSegResultOverlaps(const CUniString & segResult)
 {
-	map<CUniString, set<CUniString>*>::iterator it = m_SegResultOverlaps.find(segResult);
+	if (!m_OverlapMatricesValid)
+		BuildOverlapMatrices();
+	return m_SegResultOverlapMatrix.GetRow(GetObjectIndex(segResult, false, false));
+}
 
-	set<CUniString> * ret = NULL;
-	if (it != m_SegResultOverlaps.end())
-		ret = (*it).second;
-	return ret;
+/*
+ * Returns all overlaps as map [ground truth object ID, set of overlapping segmentation result object IDs].
+ * The map is built from the overlap pairs on the first call after overlaps have been added.
+ */
+map<CUniString, set<CUniString>*> * CEvaluationResults::GetGroundTruthOverlaps()
+{
+	if (!m_OverlapMapsValid)
+		BuildOverlapMaps();
+	return &m_GroundTruthOverlapMap;
 }
 
 /*
- * Gets the overlap interval representation for the given regions
+ * Returns all overlaps as map [segmentation result object ID, set of overlapping ground truth object IDs].
+ * The map is built from the overlap pairs on the first call after overlaps have been added.
  */
-CLayoutObjectOverlap * CEvaluationResults::GetOverlapIntervalRep(CUniString groundTruth, CUniString segResult)
+map<CUniString, set<CUniString>*> * CEvaluationResults::GetSegResultOverlaps()
 {
-	map<CUniString, map<CUniString, CLayoutObjectOverlap*>*>::iterator itg = m_OverlapIntervalReps.find(groundTruth);
+	if (!m_OverlapMapsValid)
+		BuildOverlapMaps();
+	return &m_SegResultOverlapMap;
+}
 
-	if (itg == m_OverlapIntervalReps.end())
-		return NULL;
-	map<CUniString, CLayoutObjectOverlap*>* mapseg = (*itg).second;
+/*
+ * Fills the overlap maps (see GetGroundTruthOverlaps()) from the overlap pairs.
+ */
+void CEvaluationResults::BuildOverlapMaps()
+{
+	ClearOverlapMaps();
+	for (unsigned int i=0; i<m_OverlapIntervalReps.size(); i++)
+	{
+		if (m_OverlapIntervalReps[i].empty())
+			continue;
+		CUniString groundTruthId = m_GroundTruthIds->GetId(i);
+		set<CUniString> * segResultIds = new set<CUniString>();
+		m_GroundTruthOverlapMap.insert(pair<CUniString, set<CUniString>*>(groundTruthId, segResultIds));
 
-	map<CUniString, CLayoutObjectOverlap*>::iterator its = mapseg->find(segResult);
-	if (its == mapseg->end())
-		return NULL;
-	return (*its).second;
+		for (unsigned int j=0; j<m_OverlapIntervalReps[i].size(); j++)
+		{
+			CUniString segResultId = m_SegResultIds->GetId(m_OverlapIntervalReps[i][j].first);
+			segResultIds->insert(segResultId);
+
+			map<CUniString, set<CUniString>*>::iterator it = m_SegResultOverlapMap.find(segResultId);
+			if (it == m_SegResultOverlapMap.end())
+				it = m_SegResultOverlapMap.insert(pair<CUniString, set<CUniString>*>(segResultId, new set<CUniString>())).first;
+			(*it).second->insert(groundTruthId);
+		}
+	}
+	m_OverlapMapsValid = true;
 }
 
 /*
- * Gets the overlap interval representation for the given ground truth and all overlapping
- * segentation result regions.
+ * Deletes the overlap maps (see GetGroundTruthOverlaps())
  */
-CLayoutObjectOverlap * CEvaluationResults::GetMultiOverlapIntervalRep(CUniString groundTruth)
+void CEvaluationResults::ClearOverlapMaps()
 {
-	map<CUniString, CLayoutObjectOverlap*>::iterator it = m_MultiOverlapIntervalReps.find(groundTruth);
-
-	if (it == m_MultiOverlapIntervalReps.end())
-		return NULL;
-	return (*it).second;
+	for (map<CUniString, set<CUniString>*>::iterator it = m_GroundTruthOverlapMap.begin(); it != m_GroundTruthOverlapMap.end(); it++)
+		delete (*it).second;
+	m_GroundTruthOverlapMap.clear();
+	for (map<CUniString, set<CUniString>*>::iterator it = m_SegResultOverlapMap.begin(); it != m_SegResultOverlapMap.end(); it++)
+		delete (*it).second;
+	m_SegResultOverlapMap.clear();
+	m_OverlapMapsValid = false;
 }
 
 /*
- * Add an overlap interval representation for the given regions
+ * Returns the IDs of all ground truth (or segmentation result) objects that overlap with at least one object (sorted by ID).
  */
-void CEvaluationResults::AddOverlapIntervalRep(CUniString groundTruth, CUniString segResult, 
-											   CLayoutObjectOverlap * overlap)
+void CEvaluationResults::GetOverlappingObjects(bool isGroundTruth, vector<CUniString> * objectIds)
 {
-	map<CUniString, map<CUniString, CLayoutObjectOverlap*>*>::iterator itg = m_OverlapIntervalReps.find(groundTruth);
+	if (!m_OverlapMatricesValid)
+		BuildOverlapMatrices();
+	COverlapMatrix & matrix = isGroundTruth ? m_GroundTruthOverlapMatrix : m_SegResultOverlapMatrix;
+	CLayoutObjectIdTable * ids = isGroundTruth ? m_GroundTruthIds : m_SegResultIds;
+	for (int i=0; i<matrix.GetRowCount(); i++)
+		if (matrix.GetRow(i) != NULL)
+			objectIds->push_back(ids->GetId(i));
+	sort(objectIds->begin(), objectIds->end());
+}
 
-	map<CUniString, CLayoutObjectOverlap*>* mapseg = NULL;
-	if (itg == m_OverlapIntervalReps.end())
-	{
-		mapseg = new map<CUniString, CLayoutObjectOverlap*>();
-		m_OverlapIntervalReps.insert(pair<CUniString, map<CUniString, CLayoutObjectOverlap*>*>(groundTruth, mapseg));
-	}
-	else
-		mapseg = (*itg).second;
+/*
+ * Gets the overlap interval representation for the given regions
+ */
+CLayoutObjectOverlap * CEvaluationResults::GetOverlapIntervalRep(const CUniString & groundTruth, const CUniString & segResult)
+{
+	COverlapRow * overlaps = GetGroundTruthOverlaps(groundTruth);
+	if (overlaps == NULL)
+		return NULL;
+	COverlapMatrixEntry * entry = overlaps->Find(GetObjectIndex(segResult, false, false));
+	if (entry == NULL)
+		return NULL;
+	return entry->m_Overlap;
+}
 
-	mapseg->insert(pair<CUniString, CLayoutObjectOverlap*>(segResult, overlap));
+/*
+ * Gets the overlap interval representation for the given ground truth and all overlapping
+ * segentation result regions.
+ */
+CLayoutObjectOverlap * CEvaluationResults::GetMultiOverlapIntervalRep(const CUniString & groundTruth)
+{
+	int index = GetObjectIndex(groundTruth, true, false);
+	if (index < 0 || index >= (int)m_MultiOverlapIntervalReps.size())
+		return NULL;
+	return m_MultiOverlapIntervalReps[index];
 }
 
 /*
@@ -263,7 +365,11 @@ void CEvaluationResults::AddOverlapIntervalRep(CUniString groundTruth, CUniStrin
  */
 void CEvaluationResults::AddMultiOverlapIntervalRep(CLayoutObject * groundTruth, CLayoutObjectOverlap * overlap)
 {
-	m_MultiOverlapIntervalReps.insert(pair<CUniString, CLayoutObjectOverlap*>(groundTruth->GetId(), overlap));
+	int index = GetObjectIndex(groundTruth->GetId(), true, true);
+	if (index >= (int)m_MultiOverlapIntervalReps.size())
+		m_MultiOverlapIntervalReps.resize(index + 1, NULL);
+	if (m_MultiOverlapIntervalReps[index] == NULL) //Keep the first one
+		m_MultiOverlapIntervalReps[index] = overlap;
 }
 
 /*
@@ -272,7 +378,7 @@ void CEvaluationResults::AddMultiOverlapIntervalRep(CLayoutObject * groundTruth,
  * 'createIfNotExists' - If true and the object doesn't exist yet, a LayoutObjectEvaluationResult
  *                       object for the given object will be created and stored.
  */
-CLayoutObjectEvaluationResult * CEvaluationResults::GetGroundTruthObjectResult(CUniString layoutObject, bool createIfNotExists)
+CLayoutObjectEvaluationResult * CEvaluationResults::GetGroundTruthObjectResult(const CUniString & layoutObject, bool createIfNotExists)
 {
 	map<CUniString, CLayoutObjectEvaluationResult*>::iterator it = m_GroundTruthObjectResults.find(layoutObject);
 
@@ -293,7 +399,7 @@ CLayoutObjectEvaluationResult * CEvaluationResults::GetGroundTruthObjectResult(C
  * 'createIfNotExists' - If true and the object doesn't exist yet, a LayoutObjectEvaluationResult
  *                       object for the given object will be created and stored.
  */
-CLayoutObjectEvaluationResult * CEvaluationResults::GetSegResultObjectResult(CUniString layoutObject, bool createIfNotExists)
+CLayoutObjectEvaluationResult * CEvaluationResults::GetSegResultObjectResult(const CUniString & layoutObject, bool createIfNotExists)
 {
 	map<CUniString, CLayoutObjectEvaluationResult*>::iterator it = m_SegResultObjectResults.find(layoutObject);
 
@@ -308,6 +414,26 @@ CLayoutObjectEvaluationResult * CEvaluationResults::GetSegResultObjectResult(CUn
 	return ret;
 }
 
+/*
+ * Adds the given (detached) result object to the ground truth object results.
+ * The results object takes ownership and the errors of the result are registered in the error type map.
+ */
+void CEvaluationResults::AddGroundTruthObjectResult(CLayoutObjectEvaluationResult * result)
+{
+	m_GroundTruthObjectResults.insert(pair<CUniString, CLayoutObjectEvaluationResult*>(result->GetRegion(), result));
+	result->SetResults(this);
+}
+
+/*
+ * Adds the given (detached) result object to the segmentation result object results.
+ * The results object takes ownership and the errors of the result are registered in the error type map.
+ */
+void CEvaluationResults::AddSegResultObjectResult(CLayoutObjectEvaluationResult * result)
+{
+	m_SegResultObjectResults.insert(pair<CUniString, CLayoutObjectEvaluationResult*>(result->GetRegion(), result));
+	result->SetResults(this);
+}
+
 /*
  * Add the given interval representation to the internal map.
  */
@@ -315,25 +441,33 @@ void CEvaluationResults::AddIntervalRepresentation(CLayoutObject * object,
 												   CIntervalRepresentation * intRepr, 
 												   bool isGroundTruth)
 {
-	if (isGroundTruth)
-		m_GroundTruthIntervalReps.insert(pair<CUniString, CIntervalRepresentation*>(object->GetId(), intRepr));
-	else //seg result
-		m_SegResultIntervalReps.insert(pair<CUniString, CIntervalRepresentation*>(object->GetId(), intRepr));
+	int index = GetObjectIndex(object->GetId(), isGroundTruth, true);
+	vector<CIntervalRepresentation*> & intReps = isGroundTruth ? m_GroundTruthIntervalReps : m_SegResultIntervalReps;
+	if (index >= (int)intReps.size())
+		intReps.resize(index + 1, NULL);
+	if (intReps[index] == NULL) //Keep the first one
+		intReps[index] = intRepr;
 }
 
 /*
  * Returns the interval representation for the given layout object. If it's not found in the internal map it is created and stored.
+ * If shared geometry has been set, the interval representation is taken from there.
  */
-CIntervalRepresentation * CEvaluationResults::GetIntervalRepresentation(CUniString objectId, 
+CIntervalRepresentation * CEvaluationResults::GetIntervalRepresentation(const CUniString & objectId, 
 																		bool createIfNotExists, 
 																		bool isGroundTruth)
 {
-	map<CUniString, CIntervalRepresentation*>::iterator it = isGroundTruth ? m_GroundTruthIntervalReps.find(objectId) : m_SegResultIntervalReps.find(objectId);
-	map<CUniString, CIntervalRepresentation*>::iterator end = isGroundTruth ? m_GroundTruthIntervalReps.end() : m_SegResultIntervalReps.end();
+	if (m_SharedGeometry != NULL)
+		return m_SharedGeometry->GetIntervalRepresentation(objectId, createIfNotExists, isGroundTruth);
+
+	vector<CIntervalRepresentation*> & intReps = isGroundTruth ? m_GroundTruthIntervalReps : m_SegResultIntervalReps;
+	int index = GetObjectIndex(objectId, isGroundTruth, false);
 
 	CIntervalRepresentation * ret = NULL;
+	if (index >= 0 && index < (int)intReps.size())
+		ret = intReps[index];
 
-	if (it == end && createIfNotExists) //not found
+	if (ret == NULL && createIfNotExists) //not found
 	{
 		CLayoutObject * layoutObject = GetDocumentLayoutObject(objectId, isGroundTruth);
 		if (layoutObject->GetLayoutObjectType() == CLayoutObject::TYPE_READING_ORDER_GROUP)
@@ -341,12 +475,10 @@ CIntervalRepresentation * CEvaluationResults::GetIntervalRepresentation(CUniStri
 		else
 		{
 			RestrictToDocumentDimensions(layoutObject->GetCoords(), m_LayoutEvaluation->GetGroundTruth()->GetWidth(), m_LayoutEvaluation->GetGroundTruth()->GetHeight());
-			ret = new CIntervalRepresentation(layoutObject->GetCoords(), false, layoutObject);
+			ret = CEvaluationArena::New<CIntervalRepresentation>(layoutObject->GetCoords(), false, layoutObject);
 		}
 		AddIntervalRepresentation(layoutObject, ret, isGroundTruth);
 	}
-	else
-		ret = (*it).second;
 
 	return ret;
 }
@@ -372,7 +504,7 @@ CIntervalRepresentation * CEvaluationResults::CalculateIntervalRepresentation(CR
 		}
 	}
 	//Create merged interval representation
-	CIntervalRepresentation * ret = new CIntervalRepresentation(&intReps);
+	CIntervalRepresentation * ret = CEvaluationArena::New<CIntervalRepresentation>(&intReps);
 
 	//Clean up
 	for (list<CIntervalRepresentation*>::iterator it = intReps.begin(); it != intReps.end(); it++)
@@ -406,25 +538,36 @@ void CEvaluationResults::RestrictToDocumentDimensions(CLayoutPolygon * coords, i
 	}
 }
 
+/*
+ * Stores the number of black pixels of the given region (calculated elsewhere, e.g. by the label raster overlap engine).
+ * Ignored if shared geometry has been set or if the pixel count exists already.
+ */
+void CEvaluationResults::AddPixelCount(const CUniString & region, long pixelCount, bool isGroundTruth)
+{
+	if (m_SharedGeometry != NULL)
+		return;
+	int index = GetObjectIndex(region, isGroundTruth, true);
+	vector<long> & pixelCounts = isGroundTruth ? m_GroundTruthPixelCounts : m_SegResultPixelCounts;
+	if (index >= (int)pixelCounts.size())
+		pixelCounts.resize(index + 1, -1L);
+	if (pixelCounts[index] < 0L) //Keep the first one
+		pixelCounts[index] = pixelCount;
+}
+
 /*
  * Returns the number of black pixels within the given region.
+ * If shared geometry has been set, the pixel count is taken from there.
  */
-long CEvaluationResults::GetPixelCount(CUniString region, bool isGroundTruth)
+long CEvaluationResults::GetPixelCount(const CUniString & region, bool isGroundTruth)
 {
-	//Look in the map first
-	map<CUniString,long>::iterator it;
-	if (isGroundTruth)
-	{
-		it = m_GroundTruthPixelCounts.find(region);
-		if (it != m_GroundTruthPixelCounts.end()) //found
-			return (*it).second;
-	}
-	else //seg result
-	{
-		it = m_SegResultPixelCounts.find(region);
-		if (it != m_SegResultPixelCounts.end()) //found
-			return (*it).second;
-	}
+	if (m_SharedGeometry != NULL)
+		return m_SharedGeometry->GetPixelCount(region, isGroundTruth);
+
+	//Look in the stored counts first
+	vector<long> & pixelCounts = isGroundTruth ? m_GroundTruthPixelCounts : m_SegResultPixelCounts;
+	int index = GetObjectIndex(region, isGroundTruth, false);
+	if (index >= 0 && index < (int)pixelCounts.size() && pixelCounts[index] >= 0L) //found
+		return pixelCounts[index];
 
 	COpenCvBiLevelImage * img = m_LayoutEvaluation->GetBilevelImage();
 	CIntervalRepresentation * intRepr = GetIntervalRepresentation(region, true, isGroundTruth);
@@ -432,22 +575,13 @@ long CEvaluationResults::GetPixelCount(CUniString region, bool isGroundTruth)
 
 	//Count (using interval representation)
 	if (img != NULL)
-	{
-		for (int i=0; i<intRepr->GetIntervalCount(); i++)
-		{
-			CInterval * interval = intRepr->GetInterval(i);
-			vector<int> * parts = interval->GetIntervalSegments();
-			for (unsigned int j=0; (int)j<(int)parts->size()-1; j+=2)
-			{
-				pixelCount += img->CountPixels(	parts->at(j), interval->GetStart(),
-												parts->at(j+1), interval->GetEnd());
-			}
-		}
-	}
-	if (isGroundTruth)
-		m_GroundTruthPixelCounts.insert(pair<CUniString,long>(region, pixelCount)); //store
-	else //seg result
-		m_SegResultPixelCounts.insert(pair<CUniString,long>(region, pixelCount)); //store
+		pixelCount = m_LayoutEvaluation->CountPixels(intRepr);
+
+	//Store
+	index = GetObjectIndex(region, isGroundTruth, true);
+	if (index >= (int)pixelCounts.size())
+		pixelCounts.resize(index + 1, -1L);
+	pixelCounts[index] = pixelCount;
 
 	return pixelCount;
 }
@@ -456,7 +590,7 @@ long CEvaluationResults::GetPixelCount(CUniString region, bool isGroundTruth)
  * Retunrs the area of the specified region.
  * The area is retrieved from the interval representation.
  */
-long CEvaluationResults::GetRegionArea(CUniString region, bool isGroundTruth)
+long CEvaluationResults::GetRegionArea(const CUniString & region, bool isGroundTruth)
 {
 	CIntervalRepresentation * intRepr = GetIntervalRepresentation(region, true, isGroundTruth);
 	return intRepr->GetArea();
@@ -514,10 +648,20 @@ void CEvaluationResults::SetMetrics(CEvaluationMetrics * metrics)
 {
 	delete m_Metrics;
 	m_Metrics = metrics;
+	m_CalculateTypeMetricsOnDemand = false; //Not calculated from this results object
 }
 
-CLayoutObject * CEvaluationResults::GetDocumentLayoutObject(CUniString objectId, bool isGroundTruth)
+CLayoutObject * CEvaluationResults::GetDocumentLayoutObject(const CUniString & objectId, bool isGroundTruth)
 {
+	//Look in the object index first
+	int index = GetObjectIndex(objectId, isGroundTruth, false);
+	if (index >= 0)
+	{
+		CLayoutObject * object = isGroundTruth ? m_GroundTruthIds->GetObject(index) : m_SegResultIds->GetObject(index);
+		if (object != NULL)
+			return object;
+	}
+
 	if (isGroundTruth)
 	{
 		if (m_LayoutEvaluation != NULL && m_LayoutEvaluation->GetGroundTruth() != NULL)
@@ -531,12 +675,159 @@ CLayoutObject * CEvaluationResults::GetDocumentLayoutObject(CUniString objectId,
 	return NULL;
 }
 
+/*
+ * Returns the dense index of the given object (ground truth and segmentation result objects have separate indices).
+ * The index tables are created on first use and contain all objects of the layout object type of these results.
+ * Other IDs are appended if 'addIfNotExists' is true.
+ * Returns -1 if the ID is not in the table and not added.
+ */
+int CEvaluationResults::GetObjectIndex(const CUniString & objectId, bool isGroundTruth, bool addIfNotExists)
+{
+	CLayoutObjectIdTable * ids = isGroundTruth ? m_GroundTruthIds : m_SegResultIds;
+	if (ids == NULL)
+	{
+		if (!addIfNotExists) //Nothing stored yet
+			return -1;
+		CPageLayout * pageLayout = NULL;
+		if (m_LayoutEvaluation != NULL)
+			pageLayout = isGroundTruth ? m_LayoutEvaluation->GetGroundTruth() : m_LayoutEvaluation->GetSegResult();
+		ids = new CLayoutObjectIdTable(pageLayout, m_LayoutObjectType);
+		if (isGroundTruth)
+			m_GroundTruthIds = ids;
+		else
+			m_SegResultIds = ids;
+		if (m_LayoutObjectType == CLayoutObject::TYPE_LAYOUT_REGION)
+			ResolveSubtypes(ids);
+	}
+
+	int index = ids->GetIndex(objectId);
+	if (index < 0 && addIfNotExists)
+		index = ids->Add(objectId, NULL);
+	return index;
+}
+
+/*
+ * Resolves the subtypes of all layout regions in the given index table (depends on the profile, e.g. default text type).
+ * The tables are created before the worker threads access them, so no synchronisation is needed.
+ */
+void CEvaluationResults::ResolveSubtypes(CLayoutObjectIdTable * ids)
+{
+	for (int i=0; i<ids->GetSize(); i++)
+	{
+		CLayoutObject * object = ids->GetObject(i);
+		if (object == NULL || object->GetLayoutObjectType() != CLayoutObject::TYPE_LAYOUT_REGION)
+			continue;
+		CUniString subtype = CLayoutEvaluation::GetLayoutRegionSubtype((CLayoutRegion*)object, m_Profile);
+		ids->SetSubtype(i, subtype.IsEmpty() ? CLayoutObjectIdTable::SUBTYPE_NONE 
+											: InternSubtype(((CLayoutRegion*)object)->GetType(), subtype));
+	}
+}
+
+/*
+ * Returns the index of the given subtype of the given region type (adds it if not there yet).
+ */
+int CEvaluationResults::InternSubtype(int regionType, const CUniString & subtype)
+{
+	for (unsigned int i=0; i<m_Subtypes.size(); i++)
+		if (m_SubtypeRegionTypes[i] == regionType && m_Subtypes[i] == subtype)
+			return (int)i;
+	m_Subtypes.push_back(subtype);
+	m_SubtypeRegionTypes.push_back(regionType);
+	return (int)m_Subtypes.size() - 1;
+}
+
+/*
+ * Returns the interned subtype of the given layout region.
+ * Equal subtypes of the same region type have equal indices (for ground truth and segmentation result).
+ * Returns CLayoutObjectIdTable::SUBTYPE_NONE if the region has no subtype and
+ * CLayoutObjectIdTable::SUBTYPE_UNRESOLVED if the region is not in the index tables.
+ */
+int CEvaluationResults::GetSubtypeIndex(CLayoutRegion * region, bool isGroundTruth)
+{
+	int index = GetObjectIndex(region->GetId(), isGroundTruth, false);
+	if (index < 0)
+		return CLayoutObjectIdTable::SUBTYPE_UNRESOLVED;
+	CLayoutObjectIdTable * ids = isGroundTruth ? m_GroundTruthIds : m_SegResultIds;
+	if (ids->GetObject(index) != region) //Different object with the same ID
+		return CLayoutObjectIdTable::SUBTYPE_UNRESOLVED;
+	return ids->GetSubtype(index);
+}
+
+/*
+ * Returns the subtype of the given layout region (empty if it has no subtype).
+ * Uses the resolved subtype if possible, see CLayoutEvaluation::GetLayoutRegionSubtype.
+ */
+CUniString CEvaluationResults::GetLayoutRegionSubtype(CLayoutRegion * region, bool isGroundTruth)
+{
+	int subtype = GetSubtypeIndex(region, isGroundTruth);
+	if (subtype == CLayoutObjectIdTable::SUBTYPE_UNRESOLVED)
+		return CLayoutEvaluation::GetLayoutRegionSubtype(region, m_Profile);
+	return GetSubtypeName(subtype);
+}
+
+/*
+ * Returns the slot of the given layout region in the weight table (see GetWeightTable() and CEvaluationWeightTable::GetSlot).
+ * Uses the interned subtype, so no strings are compared for regions in the index tables.
+ */
+int CEvaluationResults::GetWeightSlot(CLayoutRegion * region, bool isGroundTruth)
+{
+	CEvaluationWeightTable * weights = GetWeightTable();
+	int subtype = GetSubtypeIndex(region, isGroundTruth);
+	if (subtype == CLayoutObjectIdTable::SUBTYPE_NONE)
+		return weights->GetSlot(region->GetType(), CUniString());
+	if (subtype == CLayoutObjectIdTable::SUBTYPE_UNRESOLVED)
+		return weights->GetSlot(region->GetType(), CLayoutEvaluation::GetLayoutRegionSubtype(region, m_Profile));
+	if (subtype < (int)m_SubtypeWeightSlots.size())
+		return m_SubtypeWeightSlots[subtype];
+	return weights->GetSlot(region->GetType(), m_Subtypes[subtype]); //Interned after the table was set
+}
+
+/*
+ * Returns the weight table used for the metrics (the current table of the profile if no metrics have been calculated yet)
+ */
+CEvaluationWeightTable * CEvaluationResults::GetWeightTable()
+{
+	if (!m_WeightTable)
+	{
+		m_WeightTable = m_Profile->GetWeightTable();
+		MapSubtypesToWeightSlots();
+	}
+	return m_WeightTable.get();
+}
+
+/*
+ * Looks up the weight table slots of all interned subtypes (see GetWeightSlot).
+ */
+void CEvaluationResults::MapSubtypesToWeightSlots()
+{
+	m_SubtypeWeightSlots.resize(m_Subtypes.size());
+	for (unsigned int i=0; i<m_Subtypes.size(); i++)
+		m_SubtypeWeightSlots[i] = m_WeightTable->GetSlot(m_SubtypeRegionTypes[i], m_Subtypes[i]);
+}
+
 /*
  * Calculate the measures, metrics, rates based on the raw evaluation data.
+ *
+ * 'eagerRegionTypes' (optional) - Layout region types (see CLayoutRegion::TYPE_...) for which the type specific
+ *                                 metrics are calculated in the same pass as the metrics for all types.
+ *                                 Metrics of other types are calculated on first access (see GetMetrics(int)).
  */
-void CEvaluationResults::CalculateMetrics()
+void CEvaluationResults::CalculateMetrics(vector<int> * eagerRegionTypes /*= NULL*/)
 {
 	delete m_Metrics;
+	map<int,CLayoutObjectEvaluationMetrics *>::iterator itMetrics = m_MetricsPerLayoutRegionType.begin();
+	while (itMetrics != m_MetricsPerLayoutRegionType.end())
+	{
+		delete (*itMetrics).second;
+		itMetrics++;
+	}
+	m_MetricsPerLayoutRegionType.clear();
+	m_CalculateTypeMetricsOnDemand = false;
+
+	//Current weights of the profile (kept for the metrics that are calculated on demand later)
+	m_WeightTable = m_Profile->GetWeightTable();
+	MapSubtypesToWeightSlots();
+
 	//Border
 	if (m_LayoutObjectType == CLayoutObject::TYPE_BORDER)
 	{
@@ -544,57 +835,112 @@ void CEvaluationResults::CalculateMetrics()
 	}
 	else //Layout object
 	{
-		m_Metrics = new CLayoutObjectEvaluationMetrics(this, m_Profile, true);
+		CLayoutObjectEvaluationMetrics * metrics = new CLayoutObjectEvaluationMetrics(this, m_Profile, false);
+		m_Metrics = metrics;
 
+		//Region type specific metrics (calculated in the same pass as the metrics for all types)
+		vector<CLayoutObjectEvaluationMetrics*> typeMetrics;
 		if (m_LayoutObjectType == CLayoutObject::TYPE_LAYOUT_REGION)
 		{
-			m_MetricsPerLayoutRegionType.insert(pair<int,CLayoutObjectEvaluationMetrics *>(CLayoutRegion::TYPE_CHART,
-				new CLayoutObjectEvaluationMetrics(this, m_Profile, true, CLayoutRegion::TYPE_CHART, (CLayoutObjectEvaluationMetrics*)m_Metrics)));
-			//m_MetricsPerLayoutRegionType.insert(pair<int,CLayoutObjectEvaluationMetrics *>(CLayoutRegion::TYPE_FRAME,
-			//	new CLayoutObjectEvaluationMetrics(this, m_Profile, true, CLayoutRegion::TYPE_FRAME, (CLayoutObjectEvaluationMetrics*)m_Metrics)));
-			m_MetricsPerLayoutRegionType.insert(pair<int,CLayoutObjectEvaluationMetrics *>(CLayoutRegion::TYPE_GRAPHIC,
-				new CLayoutObjectEvaluationMetrics(this, m_Profile, true, CLayoutRegion::TYPE_GRAPHIC, (CLayoutObjectEvaluationMetrics*)m_Metrics)));
-			m_MetricsPerLayoutRegionType.insert(pair<int,CLayoutObjectEvaluationMetrics *>(CLayoutRegion::TYPE_IMAGE,
-				new CLayoutObjectEvaluationMetrics(this, m_Profile, true, CLayoutRegion::TYPE_IMAGE, (CLayoutObjectEvaluationMetrics*)m_Metrics)));
-			m_MetricsPerLayoutRegionType.insert(pair<int,CLayoutObjectEvaluationMetrics *>(CLayoutRegion::TYPE_LINEART,
-				new CLayoutObjectEvaluationMetrics(this, m_Profile, true, CLayoutRegion::TYPE_LINEART, (CLayoutObjectEvaluationMetrics*)m_Metrics)));
-			m_MetricsPerLayoutRegionType.insert(pair<int, CLayoutObjectEvaluationMetrics *>(CLayoutRegion::TYPE_MAP,
-				new CLayoutObjectEvaluationMetrics(this, m_Profile, true, CLayoutRegion::TYPE_MAP, (CLayoutObjectEvaluationMetrics*)m_Metrics)));
-			m_MetricsPerLayoutRegionType.insert(pair<int,CLayoutObjectEvaluationMetrics *>(CLayoutRegion::TYPE_MATHS,
-				new CLayoutObjectEvaluationMetrics(this, m_Profile, true, CLayoutRegion::TYPE_MATHS, (CLayoutObjectEvaluationMetrics*)m_Metrics)));
-			m_MetricsPerLayoutRegionType.insert(pair<int,CLayoutObjectEvaluationMetrics *>(CLayoutRegion::TYPE_NOISE,
-				new CLayoutObjectEvaluationMetrics(this, m_Profile, true, CLayoutRegion::TYPE_NOISE, (CLayoutObjectEvaluationMetrics*)m_Metrics)));
-			m_MetricsPerLayoutRegionType.insert(pair<int,CLayoutObjectEvaluationMetrics *>(CLayoutRegion::TYPE_SEPARATOR,
-				new CLayoutObjectEvaluationMetrics(this, m_Profile, true, CLayoutRegion::TYPE_SEPARATOR, (CLayoutObjectEvaluationMetrics*)m_Metrics)));
-			m_MetricsPerLayoutRegionType.insert(pair<int,CLayoutObjectEvaluationMetrics *>(CLayoutRegion::TYPE_TABLE,
-				new CLayoutObjectEvaluationMetrics(this, m_Profile, true, CLayoutRegion::TYPE_TABLE, (CLayoutObjectEvaluationMetrics*)m_Metrics)));
-			m_MetricsPerLayoutRegionType.insert(pair<int,CLayoutObjectEvaluationMetrics *>(CLayoutRegion::TYPE_TEXT,
-				new CLayoutObjectEvaluationMetrics(this, m_Profile, true, CLayoutRegion::TYPE_TEXT, (CLayoutObjectEvaluationMetrics*)m_Metrics)));
-			m_MetricsPerLayoutRegionType.insert(pair<int,CLayoutObjectEvaluationMetrics *>(CLayoutRegion::TYPE_ADVERT,
-				new CLayoutObjectEvaluationMetrics(this, m_Profile, true, CLayoutRegion::TYPE_ADVERT, (CLayoutObjectEvaluationMetrics*)m_Metrics)));
-			m_MetricsPerLayoutRegionType.insert(pair<int,CLayoutObjectEvaluationMetrics *>(CLayoutRegion::TYPE_CHEM,
-				new CLayoutObjectEvaluationMetrics(this, m_Profile, true, CLayoutRegion::TYPE_CHEM, (CLayoutObjectEvaluationMetrics*)m_Metrics)));
-			m_MetricsPerLayoutRegionType.insert(pair<int,CLayoutObjectEvaluationMetrics *>(CLayoutRegion::TYPE_MUSIC,
-				new CLayoutObjectEvaluationMetrics(this, m_Profile, true, CLayoutRegion::TYPE_MUSIC, (CLayoutObjectEvaluationMetrics*)m_Metrics)));
-			m_MetricsPerLayoutRegionType.insert(pair<int, CLayoutObjectEvaluationMetrics *>(CLayoutRegion::TYPE_CUSTOM,
-				new CLayoutObjectEvaluationMetrics(this, m_Profile, true, CLayoutRegion::TYPE_CUSTOM, (CLayoutObjectEvaluationMetrics*)m_Metrics)));
-			m_MetricsPerLayoutRegionType.insert(pair<int,CLayoutObjectEvaluationMetrics *>(CLayoutRegion::TYPE_UNKNOWN,
-				new CLayoutObjectEvaluationMetrics(this, m_Profile, true, CLayoutRegion::TYPE_UNKNOWN, (CLayoutObjectEvaluationMetrics*)m_Metrics)));
+			m_CalculateTypeMetricsOnDemand = true;
+			if (eagerRegionTypes != NULL)
+			{
+				for (unsigned int i=0; i<eagerRegionTypes->size(); i++)
+				{
+					int type = eagerRegionTypes->at(i);
+					if (m_MetricsPerLayoutRegionType.find(type) != m_MetricsPerLayoutRegionType.end()) //Listed twice
+						continue;
+					CLayoutObjectEvaluationMetrics * typeSpecific = new CLayoutObjectEvaluationMetrics(this, m_Profile, false, type, metrics);
+					m_MetricsPerLayoutRegionType.insert(pair<int,CLayoutObjectEvaluationMetrics *>(type, typeSpecific));
+					typeMetrics.push_back(typeSpecific);
+				}
+			}
 		}
+
+		metrics->Calculate(&typeMetrics);
 	}
 }
 
 /*
  * Returns the specialized metrics for a layout region type (e.g. TABLE or IMAGE; see CLayoutRegion::TYPE_...).
+ * If the metrics haven't been calculated yet (and the metrics for all types were calculated by CalculateMetrics),
+ * the metrics of all missing types of GetMetricsRegionTypes() are calculated now, in one pass (synchronised).
+ * Returns NULL for types that are not in that list.
  */
 CLayoutObjectEvaluationMetrics * CEvaluationResults::GetMetrics(int layoutRegionType)
 {
+	CSingleLock lock(&m_MetricsCriticalSect);
+	lock.Lock();
+
 	map<int,CLayoutObjectEvaluationMetrics *>::iterator it = m_MetricsPerLayoutRegionType.find(layoutRegionType);
-	if (it != m_MetricsPerLayoutRegionType.end())
-		return (*it).second;
-	return NULL;
+	if (it == m_MetricsPerLayoutRegionType.end() && m_CalculateTypeMetricsOnDemand)
+	{
+		CalculateMissingTypeMetrics();
+		it = m_MetricsPerLayoutRegionType.find(layoutRegionType);
+	}
+	CLayoutObjectEvaluationMetrics * typeSpecific = it != m_MetricsPerLayoutRegionType.end() ? (*it).second : NULL;
+
+	lock.Unlock();
+	return typeSpecific;
+}
+
+/*
+ * Returns the map [layout region type, metrics].
+ * Missing region type metrics are calculated first (see GetMetrics(int)).
+ */
+map<int,CLayoutObjectEvaluationMetrics *> * CEvaluationResults::GetMetricsPerType()
+{
+	CSingleLock lock(&m_MetricsCriticalSect);
+	lock.Lock();
+	if (m_CalculateTypeMetricsOnDemand)
+		CalculateMissingTypeMetrics();
+	lock.Unlock();
+	return &m_MetricsPerLayoutRegionType;
 }
 
+/*
+ * Calculates the region type specific metrics that haven't been calculated yet.
+ * Only the region type buckets are filled (one pass over the layout objects and errors), 
+ * the metrics for all types stay unchanged. Not synchronised (caller locks).
+ */
+void CEvaluationResults::CalculateMissingTypeMetrics()
+{
+	m_CalculateTypeMetricsOnDemand = false;
+	if (m_Metrics == NULL)
+		return;
+
+	vector<int> regionTypes;
+	GetMetricsRegionTypes(regionTypes);
+
+	vector<CLayoutObjectEvaluationMetrics*> typeMetrics;
+	for (unsigned int i=0; i<regionTypes.size(); i++)
+	{
+		int type = regionTypes[i];
+		if (m_MetricsPerLayoutRegionType.find(type) != m_MetricsPerLayoutRegionType.end())
+			continue;
+		CLayoutObjectEvaluationMetrics * typeSpecific = new CLayoutObjectEvaluationMetrics(this, m_Profile, false, type, 
+																							(CLayoutObjectEvaluationMetrics*)m_Metrics);
+		m_MetricsPerLayoutRegionType.insert(pair<int,CLayoutObjectEvaluationMetrics *>(type, typeSpecific));
+		typeMetrics.push_back(typeSpecific);
+	}
+
+	((CLayoutObjectEvaluationMetrics*)m_Metrics)->CalculateTypeMetrics(&typeMetrics);
+}
+
+/*
+ * Fills the given vector with all layout region types that have specialised metrics
+ */
+void CEvaluationResults::GetMetricsRegionTypes(vector<int> & regionTypes)
+{
+	int types[] = {	CLayoutRegion::TYPE_CHART, /*CLayoutRegion::TYPE_FRAME,*/ CLayoutRegion::TYPE_GRAPHIC, 
+					CLayoutRegion::TYPE_IMAGE, CLayoutRegion::TYPE_LINEART, CLayoutRegion::TYPE_MAP, 
+					CLayoutRegion::TYPE_MATHS, CLayoutRegion::TYPE_NOISE, CLayoutRegion::TYPE_SEPARATOR, 
+					CLayoutRegion::TYPE_TABLE, CLayoutRegion::TYPE_TEXT, CLayoutRegion::TYPE_ADVERT, 
+					CLayoutRegion::TYPE_CHEM, CLayoutRegion::TYPE_MUSIC, CLayoutRegion::TYPE_CUSTOM, 
+					CLayoutRegion::TYPE_UNKNOWN };
+	for (unsigned int i=0; i<sizeof(types)/sizeof(types[0]); i++)
+		regionTypes.push_back(types[i]);
+}
 
 /*
  * Class CEvaluationError
@@ -650,10 +996,6 @@ CLayoutObjectEvaluationError::CLayoutObjectEvaluationError(int type, CUniString
  */
 CLayoutObjectEvaluationError::~CLayoutObjectEvaluationError()
 {
-	for (list<CRect*>::iterator it = m_Rects.begin(); it != m_Rects.end(); it++)
-		delete (*it);
-	for (list<CRect*>::iterator it = m_FalseAlarmRects.begin(); it != m_FalseAlarmRects.end(); it++)
-		delete (*it);
 }
 
 /*
@@ -669,24 +1011,30 @@ CLayoutObjectEvaluationError * CLayoutObjectEvaluationError::Clone()
 	copy->SetFalseAlarm(m_FalseAlarm);
 	copy->SetForNestedRegion(m_NestedRegion);
 
-	for (list<CRect*>::iterator it = m_Rects.begin(); it != m_Rects.end(); it++)
-		copy->m_Rects.push_back(new CRect((*it)));
-	for (list<CRect*>::iterator it = m_FalseAlarmRects.begin(); it != m_FalseAlarmRects.end(); it++)
-		copy->m_FalseAlarmRects.push_back(new CRect((*it)));
+	copy->m_Rects = m_Rects;
+	copy->m_FalseAlarmRects = m_FalseAlarmRects;
 
 	return copy;
 }
 
 /*
  * Adds the given rects to the internal rect list.
- * Note: Copies the rects!
+ * Note: Copies the coordinates (the rects stay with the caller).
  */
 void CLayoutObjectEvaluationError::AddRects(vector<CRect*> * rects)
 {
-	if (rects == NULL)
-		return;
-	for (unsigned int i=0; i<rects->size(); i++)
-		m_Rects.push_back(new CRect(rects->at(i))); //Copy the rects to avoid errors on destruction
+	m_Rects.Add(rects);
+}
+
+/*
+ * Adds the given rects to the internal rect list (takes over the array if the list is empty).
+ */
+void CLayoutObjectEvaluationError::AddRects(CCompactRectArray && rects)
+{
+	if (m_Rects.empty())
+		m_Rects = std::move(rects);
+	else
+		m_Rects.Add(rects);
 }
 
 CUniString CLayoutObjectEvaluationError::GetTypeName(int errorType)
@@ -748,10 +1096,8 @@ CLayoutObjectEvaluationError * CEvaluationErrorMerge::Clone()
 	copy->SetFalseAlarm(m_FalseAlarm);
 	copy->SetForNestedRegion(m_NestedRegion);
 
-	for (list<CRect*>::iterator it = m_Rects.begin(); it != m_Rects.end(); it++)
-		copy->m_Rects.push_back(new CRect((*it)));
-	for (list<CRect*>::iterator it = m_FalseAlarmRects.begin(); it != m_FalseAlarmRects.end(); it++)
-		copy->m_FalseAlarmRects.push_back(new CRect((*it)));
+	copy->m_Rects = m_Rects;
+	copy->m_FalseAlarmRects = m_FalseAlarmRects;
 
 	for (map<CUniString, bool>::iterator it = m_Allowable.begin(); it != m_Allowable.end(); it++)
 		copy->m_Allowable.insert(pair<CUniString, bool>((*it).first, (*it).second));
@@ -776,15 +1122,10 @@ void CEvaluationErrorMerge::AddErrorRects(CUniString segResultRegion, COverlapRe
 	m_MergingRegions.insert(pair<CUniString, COverlapRects *>(segResultRegion, overlapRects));
 
 	//Also add copies of the rects to the global rect list for this error
-	map<CUniString, vector<CRect*>*>::iterator it = overlapRects->m_Overlaps.begin();
+	map<CUniString, CCompactRectArray>::iterator it = overlapRects->m_Overlaps.begin();
 	while (it != overlapRects->m_Overlaps.end())
 	{
-		vector<CRect*> * rects = (*it).second;
-		if (rects != NULL)
-		{
-			for (unsigned int i=0; i<rects->size(); i++)
-				m_Rects.push_back(new CRect(rects->at(i)));
-		}
+		m_Rects.Add((*it).second);
 		it++;
 	}
 
@@ -836,13 +1177,35 @@ CFuzzyReadingOrderRelation::CFuzzyReadingOrderRelation(double weight,
 	m_Weight = weight;
 	m_Region1 = reg1;
 	m_Region2 = reg2;
-	m_Relation = relation;
+	m_Relation = CReadingOrderRelationMatrix::ToMask(relation);
+}
+
+/*
+ * Constructor
+ * 'relationMask' - Set of possible relations as bitmask (see CReadingOrderRelationMatrix)
+ */
+CFuzzyReadingOrderRelation::CFuzzyReadingOrderRelation(double weight, 
+													   CUniString reg1, CUniString reg2, 
+													   unsigned int relationMask)
+{
+	m_Weight = weight;
+	m_Region1 = reg1;
+	m_Region2 = reg2;
+	m_Relation = relationMask;
 }
 
 CFuzzyReadingOrderRelation::~CFuzzyReadingOrderRelation()
 {
 }
 
+/*
+ * Returns the set of possible relations (CReadingOrder::RELATION_...)
+ */
+set<int> CFuzzyReadingOrderRelation::GetRelation()
+{
+	return CReadingOrderRelationMatrix::ToSet(m_Relation);
+}
+
 
 /*
  * Class CReadingOrderError
@@ -863,12 +1226,40 @@ CReadingOrderError::CReadingOrderError(CUniString reg1, CUniString reg2,
 {
 	m_Region1 = reg1;
 	m_Region2 = reg2;
-	m_SegResultRelation = segResultRelation;
+	m_SegResultRelation = CReadingOrderRelationMatrix::ToMask(segResultRelation);
 	m_GroundTruthRelation = groundTruthRelation;
 	m_Penalty = 0;
 	CalculatePenalty(profile);
 }
 
+/*
+ * Constructor
+ * 'segResultRelationMask' - Set of possible relations as bitmask (see CReadingOrderRelationMatrix)
+ */
+CReadingOrderError::CReadingOrderError(CUniString reg1, CUniString reg2, 
+									   unsigned int segResultRelationMask, 
+									   const vector<CFuzzyReadingOrderRelation> & groundTruthRelation,
+									   CEvaluationProfile * profile) 
+							: CEvaluationError()
+{
+	m_Region1 = reg1;
+	m_Region2 = reg2;
+	m_SegResultRelation = segResultRelationMask;
+	m_GroundTruthRelation = groundTruthRelation;
+	m_Penalty = 0;
+	CalculatePenalty(profile);
+}
+
+/*
+ * Returns the relation according to the segmentation result reading order as set (CReadingOrder::RELATION_...)
+ */
+set<int> * CReadingOrderError::GetSegResultRelation()
+{
+	if (m_SegResultRelationSet.empty())
+		m_SegResultRelationSet = CReadingOrderRelationMatrix::ToSet(m_SegResultRelation);
+	return &m_SegResultRelationSet;
+}
+
 /*
  * Destructor
  */
@@ -889,7 +1280,7 @@ void CReadingOrderError::CalculatePenalty(CEvaluationProfile * profile)
 		int selectedGroundTruthRel = 0;
 		int selectedSegResultRel = 0;
 
-		currPenalty = CalculatePenalty(profile, m_GroundTruthRelation[i].GetRelation(), m_SegResultRelation,
+		currPenalty = CalculatePenalty(profile, m_GroundTruthRelation[i].GetRelationMask(), m_SegResultRelation,
 										selectedGroundTruthRel, selectedSegResultRel);
 
 		m_Penalty += currPenalty * m_GroundTruthRelation[i].GetWeight();
@@ -902,32 +1293,33 @@ void CReadingOrderError::CalculatePenalty(CEvaluationProfile * profile)
 }
 
 /*
- * Compares all combinations of the given relation sets and returns the minimum penalty.
+ * Compares all combinations of the given relation sets (bitmasks, see CReadingOrderRelationMatrix) and returns the minimum penalty.
  *
  * 'selectedGroundTruthRel' (out) - The ground-truth reading order relation involved in the minimal penalty.
  * 'selectedSegResultRel' (out) - The sementation result reading order relation involved in the minimal penalty.
  */
 double CReadingOrderError::CalculatePenalty(CEvaluationProfile * profile, 
-											set<int> & groundTruth, set<int> & segmentation,
+											unsigned int groundTruth, unsigned int segmentation,
 											int & selectedGroundTruthRel, int & selectedSegResultRel)
 {
 	double minPenalty = 999999.9, currPenalty;
-	set<int>::iterator itGroundTruth = groundTruth.begin();
-	while (itGroundTruth != groundTruth.end())
+	//Relations in ascending order (same as iterating over relation sets)
+	for (int groundTruthRel = 0; (groundTruth >> groundTruthRel) != 0; groundTruthRel++)
 	{
-		set<int>::iterator itSeg = segmentation.begin();
-		while (itSeg != segmentation.end())
+		if (!CReadingOrderRelationMatrix::HasRelation(groundTruth, groundTruthRel))
+			continue;
+		for (int segResultRel = 0; (segmentation >> segResultRel) != 0; segResultRel++)
 		{
-			currPenalty = CalculatePenalty(profile, (*itGroundTruth), (*itSeg));
+			if (!CReadingOrderRelationMatrix::HasRelation(segmentation, segResultRel))
+				continue;
+			currPenalty = CalculatePenalty(profile, groundTruthRel, segResultRel);
 			if (currPenalty < minPenalty)
 			{
 				minPenalty = currPenalty;
-				selectedGroundTruthRel = (*itGroundTruth);
-				selectedSegResultRel = (*itSeg);
+				selectedGroundTruthRel = groundTruthRel;
+				selectedSegResultRel = segResultRel;
 			}
-			itSeg++;
 		}
-		itGroundTruth++;
 	}
 	return minPenalty;
 }
@@ -1029,10 +1421,8 @@ CLayoutObjectEvaluationError * CEvaluationErrorMisclass::Clone()
 	copy->SetFalseAlarm(m_FalseAlarm);
 	copy->SetForNestedRegion(m_NestedRegion);
 
-	for (list<CRect*>::iterator it = m_Rects.begin(); it != m_Rects.end(); it++)
-		copy->m_Rects.push_back(new CRect((*it)));
-	for (list<CRect*>::iterator it = m_FalseAlarmRects.begin(); it != m_FalseAlarmRects.end(); it++)
-		copy->m_FalseAlarmRects.push_back(new CRect((*it)));
+	copy->m_Rects = m_Rects;
+	copy->m_FalseAlarmRects = m_FalseAlarmRects;
 
 	copy->m_ErrorAreas.CopyFrom(&m_ErrorAreas, true);
 
@@ -1042,6 +1432,17 @@ CLayoutObjectEvaluationError * CEvaluationErrorMisclass::Clone()
 /*
  * Adds the given error rects to the internal maps (also to the base class map!)
  */
+void CEvaluationErrorMisclass::AddErrorRects(CUniString overlappingRegion, CLayoutObjectOverlap * overlap,
+											 bool countPixels, CLayoutEvaluation * layoutEval)
+{
+	m_ErrorAreas.AddOverlapRects(	overlappingRegion, overlap, 
+									countPixels, layoutEval);
+	AddRects(overlap->GetOverlapRects());
+}
+
+/*
+ * Adds the given error rects to the internal maps (pixels counted directly in the given image)
+ */
 void CEvaluationErrorMisclass::AddErrorRects(CUniString overlappingRegion, CLayoutObjectOverlap * overlap,
 											 bool countPixels, COpenCvBiLevelImage * image)
 {
@@ -1087,10 +1488,8 @@ CLayoutObjectEvaluationError * CEvaluationErrorSplit::Clone()
 	copy->SetAllowable(m_Allowable);
 	copy->SetForNestedRegion(m_NestedRegion);
 
-	for (list<CRect*>::iterator it = m_Rects.begin(); it != m_Rects.end(); it++)
-		copy->m_Rects.push_back(new CRect((*it)));
-	for (list<CRect*>::iterator it = m_FalseAlarmRects.begin(); it != m_FalseAlarmRects.end(); it++)
-		copy->m_FalseAlarmRects.push_back(new CRect((*it)));
+	copy->m_Rects = m_Rects;
+	copy->m_FalseAlarmRects = m_FalseAlarmRects;
 
 	copy->m_SplittingRegions.CopyFrom(&m_SplittingRegions, true);
 
@@ -1100,6 +1499,18 @@ CLayoutObjectEvaluationError * CEvaluationErrorSplit::Clone()
 /*
  * Adds the given error rects to the internal maps (also to the base class map!)
  */
+void CEvaluationErrorSplit::AddErrorRects(CUniString overlappingRegion, CLayoutObjectOverlap * overlap,
+											 bool countPixels, CLayoutEvaluation * layoutEval)
+{
+	m_SplittingRegions.AddOverlapRects(	overlappingRegion, overlap, 
+									countPixels, layoutEval);
+	m_Area = m_SplittingRegions.GetArea();
+	AddRects(overlap->GetOverlapRects());
+}
+
+/*
+ * Adds the given error rects to the internal maps (pixels counted directly in the given image)
+ */
 void CEvaluationErrorSplit::AddErrorRects(CUniString overlappingRegion, CLayoutObjectOverlap * overlap,
 											 bool countPixels, COpenCvBiLevelImage * image)
 {
@@ -1120,6 +1531,8 @@ void CEvaluationErrorSplit::AddErrorRects(CUniString overlappingRegion, CLayoutO
 
 /*
  * Constructor
+ *
+ * 'results' - Parent results object (can be NULL for a detached result, see SetResults())
  */
 CLayoutObjectEvaluationResult::CLayoutObjectEvaluationResult(CEvaluationResults * results,
 									 CUniString region)
@@ -1159,13 +1572,35 @@ CLayoutObjectEvaluationResult * CLayoutObjectEvaluationResult::Clone(CEvaluation
 
 /*
  * Adds the given error to the internal maps.
+ * For a detached result (no parent results object), the error type specific list is updated in SetResults().
  */
 void CLayoutObjectEvaluationResult::AddError(CLayoutObjectEvaluationError * error)
 {
 	m_Errors.insert(pair<int, CLayoutObjectEvaluationError*>(error->GetType(), error));
 	//Add it also to the error type specific list
-	map<CUniString, CLayoutObjectEvaluationError*> * regions = m_Results->GetRegionsForErrorType(error->GetType(), true);
-	regions->insert(pair<CUniString, CLayoutObjectEvaluationError*>(m_Region, error));
+	if (m_Results != NULL)
+	{
+		map<CUniString, CLayoutObjectEvaluationError*> * regions = m_Results->GetRegionsForErrorType(error->GetType(), true);
+		regions->insert(pair<CUniString, CLayoutObjectEvaluationError*>(m_Region, error));
+	}
+}
+
+/*
+ * Sets the parent results object and adds all errors to its error type specific lists.
+ * Used for results that have been created detached (e.g. by a worker thread).
+ */
+void CLayoutObjectEvaluationResult::SetResults(CEvaluationResults * results)
+{
+	m_Results = results;
+	if (m_Results == NULL)
+		return;
+	map<int, CLayoutObjectEvaluationError*>::iterator it = m_Errors.begin();
+	while (it != m_Errors.end())
+	{
+		map<CUniString, CLayoutObjectEvaluationError*> * regions = m_Results->GetRegionsForErrorType((*it).first, true);
+		regions->insert(pair<CUniString, CLayoutObjectEvaluationError*>(m_Region, (*it).second));
+		it++;
+	}
 }
 
 /*
@@ -1199,44 +1634,54 @@ COverlapRects::COverlapRects()
  */
 COverlapRects::~COverlapRects()
 {
-	map<CUniString, vector<CRect*>*>::iterator it = m_Overlaps.begin();
-	while (it != m_Overlaps.end())
-	{
-		vector<CRect*> * vec = (*it).second;
-		if (vec != NULL)
-		{
-			for (unsigned int i=0; i<vec->size(); i++)
-				delete vec->at(i);
-			delete vec;
-		}
-		it++;
-	}
-	m_Overlaps.clear();
 }
 
 /*
  * Adds the given CRects to the internal map.
- * Note: The vector and the rects are copied.
+ * Note: The rect coordinates are copied.
+ */
+void COverlapRects::AddOverlapRects(CUniString overlappingObject, CLayoutObjectOverlap * overlap,
+									bool countPixels, CLayoutEvaluation * layoutEval)
+{
+	long count = -1L;
+	if (countPixels && layoutEval != NULL && layoutEval->GetBilevelImage() != NULL)
+		count = layoutEval->CountPixels(overlap->GetOverlapRects());
+	AddOverlapRects(overlappingObject, overlap, count);
+}
+
+/*
+ * Adds the given CRects to the internal map (pixels counted directly in the given image).
+ * Note: The rect coordinates are copied.
  */
 void COverlapRects::AddOverlapRects(CUniString overlappingObject, CLayoutObjectOverlap * overlap,
 									bool countPixels, COpenCvBiLevelImage * image)
+{
+	long count = -1L;
+	if (countPixels && image != NULL)
+		count = image->CountPixels(overlap->GetOverlapRects());
+	AddOverlapRects(overlappingObject, overlap, count);
+}
+
+/*
+ * Adds the given CRects to the internal map.
+ * 'pixelCount' - Black pixels in the overlap (-1 = not counted)
+ */
+void COverlapRects::AddOverlapRects(CUniString overlappingObject, CLayoutObjectOverlap * overlap, long pixelCount)
 {
 	vector<CRect*> * rects = overlap->GetOverlapRects();
-	vector<CRect*> * copy = new vector<CRect*>();
-	for (unsigned int i=0; i<rects->size(); i++)
-		copy->push_back(new CRect(rects->at(i)));
-	m_Overlaps.insert(pair<CUniString, vector<CRect*>*>(overlappingObject, copy));
+	CCompactRectArray copy;
+	copy.Add(rects);
+	m_Overlaps.insert(pair<CUniString, CCompactRectArray>(overlappingObject, std::move(copy)));
 
 	//Set area and pixel count as well
 	m_OverlapArea.insert(pair<CUniString, long>(overlappingObject, overlap->GetOverlapArea()));
 	m_OverallArea += overlap->GetOverlapArea();
 
-	if (countPixels && image != NULL)
+	if (pixelCount >= 0)
 	{
-		long count = image->CountPixels(copy);
 		m_PixelCount.insert(pair<CUniString, long>(overlappingObject,
-													count));
-		m_OverallPixelCount += count;
+													pixelCount));
+		m_OverallPixelCount += pixelCount;
 	}
 }
 
@@ -1245,7 +1690,7 @@ void COverlapRects::AddOverlapRects(CUniString overlappingObject, CLayoutObjectO
  */
 void COverlapRects::AddOverlap(CUniString overlappingObject, long area, long pixelCount)
 {
-	m_Overlaps.insert(pair<CUniString, vector<CRect*>*>(overlappingObject, NULL)); //No rects available
+	m_Overlaps.insert(pair<CUniString, CCompactRectArray>(overlappingObject, CCompactRectArray())); //No rects available
 
 	m_OverlapArea.insert(pair<CUniString, long>(overlappingObject, area));
 	m_OverallArea += area;
@@ -1301,26 +1746,11 @@ void COverlapRects::CopyFrom(COverlapRects * rects, bool deepCopy /*= false*/)
 		itCount++;
 	}
 
-	map<CUniString, vector<CRect*>*>::iterator it = rects->m_Overlaps.begin();
+	//Rects are stored by value (always a deep copy)
+	map<CUniString, CCompactRectArray>::iterator it = rects->m_Overlaps.begin();
 	while (it != rects->m_Overlaps.end())
 	{
-		vector<CRect*> * vec = (*it).second;
-		vector<CRect*> * copyVec = new vector<CRect*>();
-		if (vec != NULL)
-		{
-			if (deepCopy) //Create new objects
-			{
-				for (unsigned int i = 0; i < vec->size(); i++)
-					copyVec->push_back(new CRect(vec->at(i)));
-			}
-			else //Copy pointers
-			{
-				for (unsigned int i = 0; i < vec->size(); i++)
-					copyVec->push_back(vec->at(i));
-			}
-		}
-
-		m_Overlaps.insert(pair<CUniString, vector<CRect*>*>((*it).first, copyVec));
+		m_Overlaps.insert(pair<CUniString, CCompactRectArray>((*it).first, (*it).second));
 		it++;
 	}
 
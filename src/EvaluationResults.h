@@ -9,6 +9,10 @@
 #include "LayoutEvaluation.h"
 #include "EvaluationProfile.h"
 #include "EvaluationMetrics.h"
+#include "LayoutObjectIdTable.h"
+#include "OverlapMatrix.h"
+#include "EvaluationArena.h"
+#include "CompactRectArray.h"
 
 namespace PRImA
 {	
@@ -40,25 +44,34 @@ public:
 	~CEvaluationResults();
 
 private:
-	//Map [ground truth object, overlapping segmentation result objects]
-	std::map<CUniString, set<CUniString>*>		m_GroundTruthOverlaps;
+	//Dense object indices for the vectors below (created on first use, see GetObjectIndex())
+	CLayoutObjectIdTable	*	m_GroundTruthIds;
+	CLayoutObjectIdTable	*	m_SegResultIds;
 
-	//Map [segmentation result object, overlapping ground truth objects]
-	std::map<CUniString, set<CUniString>*>		m_SegResultOverlaps;
+	//Overlapping ground truth object - segmentation result object pairs with RegionOverlap (can be NULL) as added
+	//  (vector [ground truth index, list of [segmentation result index, RegionOverlap]])
+	std::vector<std::vector<std::pair<int, CLayoutObjectOverlap*> > >	m_OverlapIntervalReps;
 
-	//Map with RegionOverlap for each ground truth object - segmentation result object pair
-	std::map<CUniString, std::map<CUniString, CLayoutObjectOverlap*>*>	m_OverlapIntervalReps;
+	//Overlapping pairs for lookups (built from m_OverlapIntervalReps, see BuildOverlapMatrices())
+	COverlapMatrix	m_GroundTruthOverlapMatrix;		//Rows: ground truth objects, columns: segmentation result objects
+	COverlapMatrix	m_SegResultOverlapMatrix;		//Transposed
+	bool			m_OverlapMatricesValid;
 
-	//Map [ground truth object, RegionOverlap with all overlapping segmentation result objects]
-	std::map<CUniString, CLayoutObjectOverlap*>		m_MultiOverlapIntervalReps;
+	//Overlapping objects as maps [object ID, set of overlapping object IDs] (built on request from the overlap pairs, see GetGroundTruthOverlaps())
+	std::map<CUniString, std::set<CUniString>*>	m_GroundTruthOverlapMap;
+	std::map<CUniString, std::set<CUniString>*>	m_SegResultOverlapMap;
+	bool										m_OverlapMapsValid;
 
-	//Map [object, IntervalRepresentation]
-	std::map<CUniString, CIntervalRepresentation*>	m_GroundTruthIntervalReps;
-	std::map<CUniString, CIntervalRepresentation*>	m_SegResultIntervalReps;
+	//Vector [ground truth index, RegionOverlap with all overlapping segmentation result objects]
+	std::vector<CLayoutObjectOverlap*>		m_MultiOverlapIntervalReps;
 
-	//Map [object, number of black pixels]
-	std::map<CUniString, long>	m_GroundTruthPixelCounts;
-	std::map<CUniString, long>	m_SegResultPixelCounts;
+	//Vector [object index, IntervalRepresentation] (NULL if not created yet)
+	std::vector<CIntervalRepresentation*>	m_GroundTruthIntervalReps;
+	std::vector<CIntervalRepresentation*>	m_SegResultIntervalReps;
+
+	//Vector [object index, number of black pixels] (-1 if not counted yet)
+	std::vector<long>	m_GroundTruthPixelCounts;
+	std::vector<long>	m_SegResultPixelCounts;
 
 	//Map [object, EvaluationResult]
 	std::map<CUniString, CLayoutObjectEvaluationResult*>	m_GroundTruthObjectResults;
@@ -75,34 +88,58 @@ private:
 
 	CEvaluationMetrics					*	m_Metrics;						//Figures, numbers, success rates, ...
 	std::map<int,CLayoutObjectEvaluationMetrics *>		m_MetricsPerLayoutRegionType;	//map [layout region type, metrics]
+	bool									m_CalculateTypeMetricsOnDemand;	//Missing region type metrics are calculated on first access (GetMetrics(int), GetMetricsPerType())
+	CCriticalSection						m_MetricsCriticalSect;			//For synchronization (on demand metrics)
+	std::shared_ptr<CEvaluationWeightTable>	m_WeightTable;					//Weights used for the metrics (snapshot taken in CalculateMetrics)
 
 	CBorderEvaluationResults * m_BorderResults;
 
-public:
-	void						AddLayoutObjectOverlap(CUniString groundTruth, CUniString segResult, 
-													 CLayoutObjectOverlap * overlap);
-	std::set<CUniString>			*	GetGroundTruthOverlaps(CUniString groundTruth);
-	std::set<CUniString>			*	GetSegResultOverlaps(CUniString segResult);
-	inline std::map<CUniString, std::set<CUniString>*> * GetGroundTruthOverlaps() { return &m_GroundTruthOverlaps; };
-	inline std::map<CUniString, std::set<CUniString>*> * GetSegResultOverlaps() { return &m_SegResultOverlaps; };
+	CEvaluationResults	*	m_SharedGeometry;	//Read-only source for interval representations and pixel counts (not owned, can be NULL)
 
-	CLayoutObjectOverlap			*	GetOverlapIntervalRep(CUniString groundTruth, CUniString segResult);
+	std::vector<CUniString>	m_Subtypes;				//Interned layout region subtypes (resolved once per region, see GetSubtypeIndex)
+	std::vector<int>		m_SubtypeRegionTypes;	//[subtype index] -> layout region type the subtype belongs to
+	std::vector<int>		m_SubtypeWeightSlots;	//[subtype index] -> slot in m_WeightTable (see GetWeightSlot)
 
-	CLayoutObjectOverlap			*	GetMultiOverlapIntervalRep(CUniString groundTruth);
-
-	CLayoutObjectEvaluationResult		*	GetGroundTruthObjectResult(CUniString layoutObject, bool createIfNotExists = false);
-	CLayoutObjectEvaluationResult		*	GetSegResultObjectResult(CUniString layoutObject, bool createIfNotExists = false);
+public:
+	void						AddLayoutObjectOverlap(const CUniString & groundTruth, const CUniString & segResult, 
+													 CLayoutObjectOverlap * overlap);
+	COverlapRow					*	GetGroundTruthOverlaps(const CUniString & groundTruth);
+	COverlapRow					*	GetSegResultOverlaps(const CUniString & segResult);
+	//All overlaps as map [object ID, set of overlapping object IDs] (built on first call after adding overlaps, not synchronised).
+	//The per-object lookups above are faster.
+	std::map<CUniString, std::set<CUniString>*> *	GetGroundTruthOverlaps();
+	std::map<CUniString, std::set<CUniString>*> *	GetSegResultOverlaps();
+	void							GetOverlappingObjects(bool isGroundTruth, std::vector<CUniString> * objectIds);
+	void							BuildOverlapMatrices();
+	void							PrepareOverlaps();
+
+	CLayoutObjectOverlap			*	GetOverlapIntervalRep(const CUniString & groundTruth, const CUniString & segResult);
+
+	CLayoutObjectOverlap			*	GetMultiOverlapIntervalRep(const CUniString & groundTruth);
+
+	CLayoutObjectEvaluationResult		*	GetGroundTruthObjectResult(const CUniString & layoutObject, bool createIfNotExists = false);
+	CLayoutObjectEvaluationResult		*	GetSegResultObjectResult(const CUniString & layoutObject, bool createIfNotExists = false);
 	inline std::map<CUniString, CLayoutObjectEvaluationResult*> * GetGroundTruthObjectResults() { return &m_GroundTruthObjectResults; };
 	inline std::map<CUniString, CLayoutObjectEvaluationResult*> * GetSegResultObjectResults() { return &m_SegResultObjectResults; };
+	void								AddGroundTruthObjectResult(CLayoutObjectEvaluationResult * result);
+	void								AddSegResultObjectResult(CLayoutObjectEvaluationResult * result);
 
 	void						AddMultiOverlapIntervalRep(CLayoutObject * groundTruth, CLayoutObjectOverlap * overlap);
 
 	void						AddIntervalRepresentation(CLayoutObject * region, CIntervalRepresentation * intRepr, bool isGroundTruth);
-	CIntervalRepresentation *	GetIntervalRepresentation(CUniString region, bool createIfNotExists, bool isGroundTruth);
+	CIntervalRepresentation *	GetIntervalRepresentation(const CUniString & region, bool createIfNotExists, bool isGroundTruth);
+
+	long						GetPixelCount(const CUniString & region, bool isGroundTruth);
+	void						AddPixelCount(const CUniString & region, long pixelCount, bool isGroundTruth);
 
-	long						GetPixelCount(CUniString region, bool isGroundTruth);
+	long						GetRegionArea(const CUniString & region, bool isGroundTruth);
 
-	long						GetRegionArea(CUniString region, bool isGroundTruth);
+	int							GetSubtypeIndex(CLayoutRegion * region, bool isGroundTruth);
+	inline CUniString			GetSubtypeName(int subtypeIndex) { return subtypeIndex >= 0 ? m_Subtypes[subtypeIndex] : CUniString(); };
+	CUniString					GetLayoutRegionSubtype(CLayoutRegion * region, bool isGroundTruth);
+	int							GetWeightSlot(CLayoutRegion * region, bool isGroundTruth);
+
+	inline void					SetSharedGeometry(CEvaluationResults * sharedGeometry) { m_SharedGeometry = sharedGeometry; };
 
 	inline CLayoutEvaluation *	GetLayoutEvaluation() { return m_LayoutEvaluation; };
 
@@ -116,24 +153,32 @@ public:
 
 	inline CEvaluationMetrics	*	GetMetrics() { return m_Metrics; };
 	CLayoutObjectEvaluationMetrics	*	GetMetrics(int layoutRegionType);
-	inline std::map<int,CLayoutObjectEvaluationMetrics *>	*	GetMetricsPerType() { return &m_MetricsPerLayoutRegionType; };
-	void						CalculateMetrics();
+	std::map<int,CLayoutObjectEvaluationMetrics *>	*	GetMetricsPerType();
+	void						CalculateMetrics(std::vector<int> * eagerRegionTypes = NULL);
+	static void					GetMetricsRegionTypes(std::vector<int> & regionTypes);
 	void						SetMetrics(CEvaluationMetrics * metrics);
 
 	inline CEvaluationProfile * GetProfile() { return m_Profile; }
+	CEvaluationWeightTable	*	GetWeightTable();
 
-	CLayoutObject					  * GetDocumentLayoutObject(CUniString objectId, bool isGroundTruth);
+	CLayoutObject					  * GetDocumentLayoutObject(const CUniString & objectId, bool isGroundTruth);
 
 	CBorderEvaluationResults * GetBorderResults(bool create = false);
 	void ClearBorderResults();
 	void SetBorderResults(CBorderEvaluationResults * res);
 
 private:
-	void						AddOverlapIntervalRep(CUniString groundTruth, CUniString segResult, 
-													  CLayoutObjectOverlap * overlap);
+	int							GetObjectIndex(const CUniString & objectId, bool isGroundTruth, bool addIfNotExists);
+	void						ResolveSubtypes(CLayoutObjectIdTable * ids);
+	int							InternSubtype(int regionType, const CUniString & subtype);
+	void						MapSubtypesToWeightSlots();
 	void						RestrictToDocumentDimensions(CLayoutPolygon * coords, int width, int height);
 
 	CIntervalRepresentation * CalculateIntervalRepresentation(CReadingOrderGroup * group, CPageLayout * pageLayout);
+	void						GetIdOrder(CLayoutObjectIdTable * ids, std::vector<int> * order);
+	void						CalculateMissingTypeMetrics();
+	void						BuildOverlapMaps();
+	void						ClearOverlapMaps();
 
 };
 
@@ -177,6 +222,10 @@ public:
 	CEvaluationError();
 	virtual ~CEvaluationError();
 
+	//Allocated from the current evaluation arena (see CEvaluationArena)
+	static inline void *	operator new(size_t size) { return CEvaluationArena::AllocateObject(size); };
+	static inline void		operator delete(void * object) { CEvaluationArena::ReleaseObject(object); };
+
 	virtual CUniString GetName() = 0;
 
 	inline void		SetWeightedAreaError(double err) { m_WeightedAreaError = err; };
@@ -220,9 +269,10 @@ public:
 
 	inline CUniString		GetName() { return GetTypeName(m_Type) ;};	//returns 'Merge', 'Split', ... depending on the error type
 
-	inline std::list<CRect*> *	GetRects() { return &m_Rects; };						//Collection of rectangles that decribe the error region
-	inline std::list<CRect*> *	GetFalseAlarmRects() { return &m_FalseAlarmRects; };	//Collection of rectangles that decribe the error region that doesn't contain foreground pixels
+	inline CCompactRectArray *	GetRects() { return &m_Rects; };						//Collection of rectangles that decribe the error region
+	inline CCompactRectArray *	GetFalseAlarmRects() { return &m_FalseAlarmRects; };	//Collection of rectangles that decribe the error region that doesn't contain foreground pixels
 	void					AddRects(vector<CRect*> * rects);
+	void					AddRects(CCompactRectArray && rects);
 	inline int				GetCount() { return m_Count; };
 	inline void				SetCount(int count) { m_Count = count; };
 	inline bool				IsFalseAlarm() { return m_FalseAlarm; };
@@ -241,8 +291,8 @@ protected:
 	long			m_Area;				//Error area
 	long			m_PixelCount;		//Error foreground pixel count
 	int				m_Count;			//Error count
-	std::list<CRect*>	m_Rects;			//Error region
-	std::list<CRect*>	m_FalseAlarmRects;	//Error false alarm region
+	CCompactRectArray	m_Rects;			//Error region
+	CCompactRectArray	m_FalseAlarmRects;	//Error false alarm region
 	bool			m_FalseAlarm;		//Is the error a false alarm (is the case if there are no foreground pixels at all invloved)
 	bool			m_NestedRegion;		//Is the error for a nested region?
 };
@@ -261,6 +311,12 @@ class COverlapRects
 public:
 	COverlapRects();
 	~COverlapRects();
+
+	static inline void *	operator new(size_t size) { return CEvaluationArena::AllocateObject(size); };
+	static inline void		operator delete(void * object) { CEvaluationArena::ReleaseObject(object); };
+
+	void AddOverlapRects(CUniString overlappingObject, CLayoutObjectOverlap * overlap,
+						bool countPixels, CLayoutEvaluation * layoutEval);
 	void AddOverlapRects(CUniString overlappingObject, CLayoutObjectOverlap * overlap,
 						bool countPixels, COpenCvBiLevelImage * image);
 	long GetOverlapArea(CUniString region);
@@ -273,9 +329,12 @@ public:
 
 	void CopyFrom(COverlapRects * rects, bool deepCopy = false);
 
+private:
+	void AddOverlapRects(CUniString overlappingObject, CLayoutObjectOverlap * overlap, long pixelCount);
+
 public:
-	//Map [overlappingObject, list of overlap rects]
-	std::map<CUniString, std::vector<CRect*>*> m_Overlaps;
+	//Map [overlappingObject, overlap rects]
+	std::map<CUniString, CCompactRectArray> m_Overlaps;
 
 private:
 	//Overlap area per object
@@ -334,10 +393,12 @@ class CFuzzyReadingOrderRelation
 {
 public:
 	CFuzzyReadingOrderRelation(double weight, CUniString reg1, CUniString reg2, std::set<int> relation);
+	CFuzzyReadingOrderRelation(double weight, CUniString reg1, CUniString reg2, unsigned int relationMask);
 	~CFuzzyReadingOrderRelation();
 
 	inline double GetWeight() { return m_Weight; };
-	inline std::set<int> GetRelation() {return m_Relation; };
+	std::set<int> GetRelation();
+	inline unsigned int GetRelationMask() {return m_Relation; };	//Bit n set = relation n (see CReadingOrderRelationMatrix)
 
 	inline CUniString GetRegion1() { return m_Region1; };
 	inline CUniString GetRegion2() { return m_Region2; };
@@ -353,7 +414,7 @@ private:
 	double			m_Weight;
 	CUniString		m_Region1;
 	CUniString		m_Region2;
-	std::set<int>		m_Relation;		//Set of possible relations
+	unsigned int	m_Relation;		//Set of possible relations (bit n set = CReadingOrder::RELATION_... n)
 
 	double			m_Penalty;						//Penalty for
 	int				m_CausingGroundTruthRelation;	//Reading order relations
@@ -375,6 +436,8 @@ class CReadingOrderError : public CEvaluationError
 public:
 	CReadingOrderError(CUniString reg1, CUniString reg2, std::set<int> segResultRelation,
 		std::vector<CFuzzyReadingOrderRelation> groundTruthRelation, CEvaluationProfile * profile);
+	CReadingOrderError(CUniString reg1, CUniString reg2, unsigned int segResultRelationMask,
+		const std::vector<CFuzzyReadingOrderRelation> & groundTruthRelation, CEvaluationProfile * profile);
 	~CReadingOrderError();
 
 	inline CUniString		GetName() { return CUniString(_T("Reading Order")); };
@@ -389,18 +452,20 @@ public:
 
 	static double GetMaxPenalty(CEvaluationProfile * profile);  //Max error per region pair
 
-	inline std::set<int> * GetSegResultRelation() { return &m_SegResultRelation; };
+	std::set<int> * GetSegResultRelation();
+	inline unsigned int GetSegResultRelationMask() { return m_SegResultRelation; };	//Bit n set = relation n (see CReadingOrderRelationMatrix)
 
 
 protected:
 	void CalculatePenalty(CEvaluationProfile * profile);
-	double CalculatePenalty(CEvaluationProfile * profile, std::set<int> & groundTruth, std::set<int> & segmentation,
+	double CalculatePenalty(CEvaluationProfile * profile, unsigned int groundTruth, unsigned int segmentation,
 							int & selectedGroundTruthRel, int & selectedSegResultRel);
 	double CalculatePenalty(CEvaluationProfile * profile, int groundTruthRel, int segmentationRel);
 
 	CUniString		m_Region1;
 	CUniString		m_Region2;
-	std::set<int>		m_SegResultRelation;					//Relation between Reg1 and Reg2 according to the segmentation result reading order
+	unsigned int	m_SegResultRelation;					//Relation between Reg1 and Reg2 according to the segmentation result reading order (bitmask)
+	std::set<int>	m_SegResultRelationSet;					//Same as set (created on first call of GetSegResultRelation)
 	std::vector<CFuzzyReadingOrderRelation>	m_GroundTruthRelation;	//Relation between Reg1 and Reg2 according to the ground-truth
 	double			m_Penalty;								//Penalty points
 };
@@ -422,6 +487,8 @@ public:
 
 	virtual CLayoutObjectEvaluationError * Clone();
 
+	void AddErrorRects(	CUniString overlappingRegion, CLayoutObjectOverlap * overlap,
+						bool countPixels, CLayoutEvaluation * layoutEval);
 	void AddErrorRects(	CUniString overlappingRegion, CLayoutObjectOverlap * overlap,
 						bool countPixels, COpenCvBiLevelImage * image);
 	inline COverlapRects * GetMisclassRegions() { return &m_ErrorAreas; };
@@ -449,6 +516,8 @@ public:
 
 	virtual CLayoutObjectEvaluationError * Clone();
 
+	void AddErrorRects(	CUniString overlappingRegion, CLayoutObjectOverlap * overlap,
+						bool countPixels, CLayoutEvaluation * layoutEval);
 	void AddErrorRects(	CUniString overlappingRegion, CLayoutObjectOverlap * overlap,
 						bool countPixels, COpenCvBiLevelImage * image);
 	inline COverlapRects * GetSplittingRegions() { return &m_SplittingRegions; };
@@ -478,12 +547,17 @@ public:
 	CLayoutObjectEvaluationResult(CEvaluationResults * results, CUniString region);
 	~CLayoutObjectEvaluationResult();
 
+	static inline void *	operator new(size_t size) { return CEvaluationArena::AllocateObject(size); };
+	static inline void		operator delete(void * object) { CEvaluationArena::ReleaseObject(object); };
+
 	CLayoutObjectEvaluationResult * Clone(CEvaluationResults * parentResults);
 
 	void						AddError(CLayoutObjectEvaluationError * error);
 	CLayoutObjectEvaluationError	*	GetError(int errType);
 	inline CUniString			GetRegion() { return m_Region; };
 
+	void						SetResults(CEvaluationResults * results);
+
 	inline std::map<int, CLayoutObjectEvaluationError*> * GetErrors() { return &m_Errors; };
 	
 private:
@@ -0,0 +1,213 @@
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include "stdafx.h"
+#include "EvaluationWeightTable.h"
+#include "EvaluationProfile.h"
+
+using namespace std;
+
+namespace PRImA
+{
+
+/*
+ * Class CEvaluationWeightTable
+ *
+ * Compiled (flattened) form of the error type and region type weights of an evaluation profile.
+ * Each combination of region type and subtype (including 'no subtype') gets a dense slot index.
+ * Looking up a weight for one or two slots is then a single array access.
+ */
+
+/*
+ * Constructor (compiles the table)
+ */
+CEvaluationWeightTable::CEvaluationWeightTable(CEvaluationProfile * profile)
+{
+	//Collect all region types and subtypes used in the weight tree
+	map<int, vector<CUniString> > subTypes;	//map [region type, subtypes]
+	map<int, bool> errorTypes;				//map [error type, has region type 2 weights]
+
+	map<int, CErrorTypeWeight *> * errorTypeWeights = profile->GetErrorTypeWeights();
+	for (map<int, CErrorTypeWeight *>::iterator it = errorTypeWeights->begin(); it != errorTypeWeights->end(); it++)
+	{
+		bool hasRegionType2 = false;
+		map<int, CLayoutObjectTypeWeight*> * regionTypeWeights = (*it).second->GetRegionTypeWeights();
+		for (map<int, CLayoutObjectTypeWeight*>::iterator itRt = regionTypeWeights->begin(); itRt != regionTypeWeights->end(); itRt++)
+			CollectTypes((*itRt).second, subTypes, hasRegionType2);
+		errorTypes.insert(pair<int, bool>((*it).first, hasRegionType2));
+	}
+	map<int, CLayoutObjectTypeWeight *> * regionTypeWeights = profile->GetRegionTypeWeights();
+	for (map<int, CLayoutObjectTypeWeight *>::iterator it = regionTypeWeights->begin(); it != regionTypeWeights->end(); it++)
+	{
+		bool dummy = false;
+		CollectTypes((*it).second, subTypes, dummy);
+	}
+
+	//Slots (region type without subtype, followed by the subtypes)
+	m_MinRegionType = 0;
+	int maxRegionType = -1;
+	if (!subTypes.empty())
+	{
+		m_MinRegionType = (*subTypes.begin()).first;
+		maxRegionType = (*subTypes.rbegin()).first;
+	}
+	m_RegionTypeSlots.assign(maxRegionType - m_MinRegionType + 1, -1);
+	for (map<int, vector<CUniString> >::iterator it = subTypes.begin(); it != subTypes.end(); it++)
+	{
+		m_RegionTypeSlots[(*it).first - m_MinRegionType] = (int)m_SlotRegionTypes.size();
+		m_SlotRegionTypes.push_back((*it).first);
+		m_SlotSubTypes.push_back(CUniString());
+		vector<CUniString> & types = (*it).second;
+		for (unsigned int i=0; i<types.size(); i++)
+		{
+			m_SlotRegionTypes.push_back((*it).first);
+			m_SlotSubTypes.push_back(types[i]);
+		}
+	}
+	m_SlotCount = (int)m_SlotRegionTypes.size();
+
+	//Error type weights
+	m_ErrorTypeCount = errorTypes.empty() ? 0 : max(0, (*errorTypes.rbegin()).first + 1);
+	m_SingleWeights.assign((size_t)m_ErrorTypeCount * m_SlotCount * 2, -1.0);
+	m_PairOffsets.assign(m_ErrorTypeCount, -1);
+	for (map<int, bool>::iterator it = errorTypes.begin(); it != errorTypes.end(); it++)
+	{
+		int errorType = (*it).first;
+		if (errorType < 0)
+			continue;
+		for (int slot=0; slot<m_SlotCount; slot++)
+		{
+			m_SingleWeights[((size_t)errorType * m_SlotCount + slot) * 2] = GetProfileWeight(profile, errorType, slot, false);
+			m_SingleWeights[((size_t)errorType * m_SlotCount + slot) * 2 + 1] = GetProfileWeight(profile, errorType, slot, true);
+		}
+
+		//Region type 2 (merge and misclassification)
+		if ((*it).second)
+		{
+			m_PairOffsets[errorType] = (int)m_PairWeights.size();
+			m_PairWeights.resize(m_PairWeights.size() + (size_t)m_SlotCount * m_SlotCount * 2, -1.0);
+			double * pairWeights = &m_PairWeights[m_PairOffsets[errorType]];
+			for (int slot=0; slot<m_SlotCount; slot++)
+			{
+				for (int slot2=0; slot2<m_SlotCount; slot2++)
+				{
+					pairWeights[((size_t)slot * m_SlotCount + slot2) * 2] = GetProfileWeight(profile, errorType, slot, slot2, false);
+					pairWeights[((size_t)slot * m_SlotCount + slot2) * 2 + 1] = GetProfileWeight(profile, errorType, slot, slot2, true);
+				}
+			}
+		}
+	}
+
+	//Region type weights
+	m_RegionTypeWeights.resize(m_SlotCount);
+	for (int slot=0; slot<m_SlotCount; slot++)
+	{
+		if (m_SlotSubTypes[slot].IsEmpty())
+			m_RegionTypeWeights[slot] = profile->GetRegionTypeWeight(m_SlotRegionTypes[slot]);
+		else
+			m_RegionTypeWeights[slot] = profile->GetRegionTypeWeight(m_SlotRegionTypes[slot], m_SlotSubTypes[slot]);
+	}
+}
+
+/*
+ * Destructor
+ */
+CEvaluationWeightTable::~CEvaluationWeightTable()
+{
+}
+
+/*
+ * Returns the slot for the given region type and subtype (empty subtype for the region type itself).
+ * Returns -1 if the combination is not part of the profile.
+ */
+int CEvaluationWeightTable::GetSlot(int regionType, const CUniString & subType)
+{
+	if (regionType < m_MinRegionType || regionType - m_MinRegionType >= (int)m_RegionTypeSlots.size())
+		return -1;
+	int slot = m_RegionTypeSlots[regionType - m_MinRegionType];
+	if (slot < 0 || subType.IsEmpty())
+		return slot;
+
+	//Subtypes follow the slot of the region type
+	for (int i=slot+1; i<m_SlotCount && m_SlotRegionTypes[i] == regionType; i++)
+		if (m_SlotSubTypes[i] == subType)
+			return i;
+	return -1;
+}
+
+/*
+ * Adds the region type of the given weight and all region types and subtypes below it.
+ * 'hasRegionType2' - Set to true if there are region type 2 weights below the given weight
+ */
+void CEvaluationWeightTable::CollectTypes(CLayoutObjectTypeWeight * weight, map<int, vector<CUniString> > & subTypes,
+										  bool & hasRegionType2)
+{
+	vector<CUniString> & types = subTypes[weight->GetType()];
+
+	map<CUniString, CSubTypeWeight*> * subTypeWeights = weight->GetSubTypeWeights();
+	for (map<CUniString, CSubTypeWeight*>::iterator it = subTypeWeights->begin(); it != subTypeWeights->end(); it++)
+	{
+		AddSubType(types, (*it).first);
+
+		map<int, CLayoutObjectTypeWeight*> * regionTypeWeights = (*it).second->GetRegionTypeWeights();
+		for (map<int, CLayoutObjectTypeWeight*>::iterator itRt = regionTypeWeights->begin(); itRt != regionTypeWeights->end(); itRt++)
+		{
+			hasRegionType2 = true;
+			bool dummy = false;
+			CollectTypes((*itRt).second, subTypes, dummy);
+		}
+	}
+
+	map<int, CLayoutObjectTypeWeight*> * regionTypeWeights = weight->GetRegionTypeWeights();
+	for (map<int, CLayoutObjectTypeWeight*>::iterator it = regionTypeWeights->begin(); it != regionTypeWeights->end(); it++)
+	{
+		hasRegionType2 = true;
+		bool dummy = false;
+		CollectTypes((*it).second, subTypes, dummy);
+	}
+}
+
+/*
+ * Adds the subtype to the list if it isn't in there yet.
+ */
+void CEvaluationWeightTable::AddSubType(vector<CUniString> & subTypes, const CUniString & subType)
+{
+	for (unsigned int i=0; i<subTypes.size(); i++)
+		if (subTypes[i] == subType)
+			return;
+	subTypes.push_back(subType);
+}
+
+/*
+ * Looks up the weight for one slot in the weight tree of the profile.
+ */
+double CEvaluationWeightTable::GetProfileWeight(CEvaluationProfile * profile, int errorType, int slot, bool allowable)
+{
+	if (m_SlotSubTypes[slot].IsEmpty())
+		return profile->GetErrorTypeWeight(errorType, m_SlotRegionTypes[slot], allowable);
+	return profile->GetErrorTypeWeight(errorType, m_SlotRegionTypes[slot], m_SlotSubTypes[slot], allowable);
+}
+
+/*
+ * Looks up the weight for two slots (region type 1 and 2) in the weight tree of the profile.
+ */
+double CEvaluationWeightTable::GetProfileWeight(CEvaluationProfile * profile, int errorType, int slot, int slot2, bool allowable)
+{
+	int regionType = m_SlotRegionTypes[slot];
+	int regionType2 = m_SlotRegionTypes[slot2];
+	CUniString & subType = m_SlotSubTypes[slot];
+	CUniString & subType2 = m_SlotSubTypes[slot2];
+
+	if (!subType.IsEmpty() && !subType2.IsEmpty())
+		return profile->GetErrorTypeWeight(errorType, regionType, subType, regionType2, subType2, allowable);
+	else if (!subType.IsEmpty())
+		return profile->GetErrorTypeWeight(errorType, regionType, subType, regionType2, allowable);
+	else if (!subType2.IsEmpty())
+		return profile->GetErrorTypeWeight(errorType, regionType, regionType2, subType2, allowable);
+	return profile->GetErrorTypeWeight(errorType, regionType, regionType2, allowable);
+}
+
+} //end namespace
@@ -0,0 +1,78 @@
+#pragma once
+
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include "ExtraString.h"
+#include <vector>
+#include <map>
+
+namespace PRImA
+{
+
+class CEvaluationProfile;
+class CLayoutObjectTypeWeight;
+
+/*
+ * Class CEvaluationWeightTable
+ *
+ * Compiled (flattened) form of the error type and region type weights of an evaluation profile.
+ * Each combination of region type and subtype (including 'no subtype') gets a dense slot index.
+ * Looking up a weight for one or two slots is then a single array access.
+ *
+ * The table is a snapshot of the weight values at the time of compilation
+ * (see CEvaluationProfile::CompileWeightTable). It is shared via shared_ptr, so a table stays valid
+ * for its holders (e.g. CEvaluationResults) when the profile compiles a new one.
+ */
+class CEvaluationWeightTable
+{
+public:
+	CEvaluationWeightTable(CEvaluationProfile * profile);
+	~CEvaluationWeightTable();
+
+	int		GetSlot(int regionType, const CUniString & subType);
+
+	//Same values as CEvaluationProfile::GetErrorTypeWeight(errorType, regionType, [subType,] allowable) (-1 if not defined)
+	inline double	GetErrorTypeWeight(int errorType, int slot, bool allowable)
+	{
+		if (slot < 0 || errorType < 0 || errorType >= m_ErrorTypeCount)
+			return -1.0;
+		return m_SingleWeights[((size_t)errorType * m_SlotCount + slot) * 2 + (allowable ? 1 : 0)];
+	};
+
+	//Same values as CEvaluationProfile::GetErrorTypeWeight(errorType, regionType, [subType,] regionType2, [subType2,] allowable) (-1 if not defined)
+	inline double	GetErrorTypeWeight(int errorType, int slot, int slot2, bool allowable)
+	{
+		if (slot < 0 || slot2 < 0 || errorType < 0 || errorType >= m_ErrorTypeCount || m_PairOffsets[errorType] < 0)
+			return -1.0;
+		return m_PairWeights[(size_t)m_PairOffsets[errorType] + ((size_t)slot * m_SlotCount + slot2) * 2 + (allowable ? 1 : 0)];
+	};
+
+	//Same values as CEvaluationProfile::GetRegionTypeWeight(regionType, [subType]) (-1 if not defined)
+	inline double	GetRegionTypeWeight(int slot) { return slot >= 0 ? m_RegionTypeWeights[slot] : -1.0; };
+
+private:
+	void	CollectTypes(CLayoutObjectTypeWeight * weight, std::map<int, std::vector<CUniString> > & subTypes, bool & hasRegionType2);
+	void	AddSubType(std::vector<CUniString> & subTypes, const CUniString & subType);
+	double	GetProfileWeight(CEvaluationProfile * profile, int errorType, int slot, bool allowable);
+	double	GetProfileWeight(CEvaluationProfile * profile, int errorType, int slot, int slot2, bool allowable);
+
+private:
+	int					m_MinRegionType;
+	std::vector<int>	m_RegionTypeSlots;	//[region type - m_MinRegionType] -> slot of the region type without subtype (-1 = unknown type)
+
+	int						m_SlotCount;
+	std::vector<int>		m_SlotRegionTypes;	//[slot] -> region type
+	std::vector<CUniString>	m_SlotSubTypes;		//[slot] -> subtype (empty for the region type itself)
+
+	int					m_ErrorTypeCount;	//Error types 0..m_ErrorTypeCount-1 (see CLayoutObjectEvaluationError::TYPE_...)
+	std::vector<double>	m_SingleWeights;	//[error type, slot, allowable]
+	std::vector<int>	m_PairOffsets;		//[error type] -> offset in m_PairWeights (-1 = no weights for region type 2)
+	std::vector<double>	m_PairWeights;		//[error type][slot, slot 2, allowable]
+	std::vector<double>	m_RegionTypeWeights;	//[slot]
+};
+
+} //end namespace
@@ -0,0 +1,239 @@
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include "stdafx.h"
+#include "IntervalOverlapSweep.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace PRImA
+{
+
+/*
+ * Class CIntervalOverlapSweep
+ *
+ * Calculates the overlap areas of many ground truth / segmentation result interval representation
+ * pairs in one pass. All intervals are sorted by their first row and swept top to bottom.
+ * Only bands that are active at the same time and overlap horizontally are intersected
+ * (see CIntervalOverlapActiveBands). Coordinates are inclusive.
+ */
+
+/*
+ * Calculates the overlap area for each of the given pairs.
+ *
+ * 'groundTruth' - Interval representations of the ground truth objects (NULL entries are ignored)
+ * 'segResult' - Interval representations of the segmentation result objects (NULL entries are ignored)
+ * 'pairs' - Pairs [ground truth index, segmentation result index], sorted
+ * 'pairStart' - Position of the first pair of each ground truth object within 'pairs' (groundTruth->size()+1 entries)
+ * 'overlapAreas' (out) - Overlap area for each pair (same order as 'pairs')
+ */
+void CIntervalOverlapSweep::CalculateOverlapAreas(	vector<CIntervalRepresentation*> * groundTruth,
+													vector<CIntervalRepresentation*> * segResult,
+													vector<pair<int,int>> * pairs, vector<int> * pairStart,
+													vector<long> * overlapAreas)
+{
+	overlapAreas->assign(pairs->size(), 0L);
+	if (pairs->empty())
+		return;
+
+	//Only objects that are part of a pair are swept
+	vector<bool> segResultUsed(segResult->size(), false);
+	for (unsigned int i=0; i<pairs->size(); i++)
+		segResultUsed[pairs->at(i).second] = true;
+
+	vector<CIntervalOverlapBand> groundTruthBands;
+	for (int i=0; i<(int)groundTruth->size(); i++)
+		if (pairStart->at(i+1) > pairStart->at(i) && groundTruth->at(i) != NULL)
+			AddBands(groundTruth->at(i), i, &groundTruthBands);
+
+	vector<CIntervalOverlapBand> segResultBands;
+	for (int i=0; i<(int)segResult->size(); i++)
+		if (segResultUsed[i] && segResult->at(i) != NULL)
+			AddBands(segResult->at(i), i, &segResultBands);
+
+	auto byFirstRow = [](const CIntervalOverlapBand & a, const CIntervalOverlapBand & b) { return a.m_Y1 < b.m_Y1; };
+	sort(groundTruthBands.begin(), groundTruthBands.end(), byFirstRow);
+	sort(segResultBands.begin(), segResultBands.end(), byFirstRow);
+
+	//Sweep (merge the two sorted band lists)
+	//  When a band starts, it is intersected with the active bands of the other kind that overlap it horizontally.
+	//  These started at the same row or above and have not ended yet. Each band pair is therefore visited exactly once.
+	CIntervalOverlapActiveBands activeGroundTruth(GetMaxWidth(&groundTruthBands));
+	CIntervalOverlapActiveBands activeSegResult(GetMaxWidth(&segResultBands));
+	vector<CIntervalOverlapBand*> overlapping;
+	unsigned int g = 0, s = 0;
+	while (g < groundTruthBands.size() || s < segResultBands.size())
+	{
+		bool isGroundTruth = s >= segResultBands.size()
+							|| (g < groundTruthBands.size() && groundTruthBands[g].m_Y1 <= segResultBands[s].m_Y1);
+		CIntervalOverlapBand * band = isGroundTruth ? &groundTruthBands[g++] : &segResultBands[s++];
+
+		CIntervalOverlapActiveBands * others = isGroundTruth ? &activeSegResult : &activeGroundTruth;
+		others->RemoveExpired(band->m_Y1);
+		others->FindOverlapping(band, &overlapping);
+
+		for (unsigned int i=0; i<overlapping.size(); i++)
+		{
+			CIntervalOverlapBand * other = overlapping[i];
+			long width = GetSegmentOverlap(band->m_Segments, other->m_Segments);
+			if (width == 0)
+				continue;
+
+			int groundTruthIndex = isGroundTruth ? band->m_Owner : other->m_Owner;
+			int segResultIndex = isGroundTruth ? other->m_Owner : band->m_Owner;
+			int pairIndex = FindPair(pairs, pairStart, groundTruthIndex, segResultIndex);
+			if (pairIndex >= 0)
+				overlapAreas->at(pairIndex) += width * (long)(min(band->m_Y2, other->m_Y2) - band->m_Y1 + 1);
+		}
+
+		CIntervalOverlapActiveBands * own = isGroundTruth ? &activeGroundTruth : &activeSegResult;
+		own->RemoveExpired(band->m_Y1);
+		own->Add(band);
+	}
+}
+
+/*
+ * Adds the non-empty intervals of the given interval representation to the band list.
+ */
+void CIntervalOverlapSweep::AddBands(CIntervalRepresentation * intRepr, int owner, vector<CIntervalOverlapBand> * bands)
+{
+	for (int i=0; i<intRepr->GetIntervalCount(); i++)
+	{
+		CInterval * interval = intRepr->GetInterval(i);
+		vector<int> * segments = interval->GetIntervalSegments();
+		if (segments->size() < 2)
+			continue;
+
+		CIntervalOverlapBand band;
+		band.m_Y1 = interval->GetStart();
+		band.m_Y2 = interval->GetEnd();
+		band.m_X1 = segments->front();
+		band.m_X2 = segments->at(segments->size() - (segments->size() % 2) - 1);
+		band.m_Owner = owner;
+		band.m_Segments = segments;
+		bands->push_back(band);
+	}
+}
+
+/*
+ * Returns the maximum width (last column - first column) of the given bands
+ */
+int CIntervalOverlapSweep::GetMaxWidth(vector<CIntervalOverlapBand> * bands)
+{
+	int maxWidth = 0;
+	for (unsigned int i=0; i<bands->size(); i++)
+		maxWidth = max(maxWidth, bands->at(i).m_X2 - bands->at(i).m_X1);
+	return maxWidth;
+}
+
+/*
+ * Returns the number of columns covered by both segment lists.
+ * The segments (pairs [x1, x2]) of each list have to be sorted and disjoint.
+ */
+long CIntervalOverlapSweep::GetSegmentOverlap(vector<int> * segments1, vector<int> * segments2)
+{
+	long width = 0L;
+	unsigned int i = 0, j = 0;
+	while (i+1 < segments1->size() && j+1 < segments2->size())
+	{
+		int x1 = max(segments1->at(i), segments2->at(j));
+		int x2 = min(segments1->at(i+1), segments2->at(j+1));
+		if (x2 >= x1)
+			width += x2 - x1 + 1;
+
+		//Advance the segment that ends first
+		if (segments1->at(i+1) < segments2->at(j+1))
+			i += 2;
+		else
+			j += 2;
+	}
+	return width;
+}
+
+/*
+ * Returns the position of the given pair within the pair list or -1.
+ */
+int CIntervalOverlapSweep::FindPair(vector<pair<int,int>> * pairs, vector<int> * pairStart, int groundTruth, int segResult)
+{
+	vector<pair<int,int>>::iterator begin = pairs->begin() + pairStart->at(groundTruth);
+	vector<pair<int,int>>::iterator end = pairs->begin() + pairStart->at(groundTruth+1);
+	vector<pair<int,int>>::iterator it = lower_bound(begin, end, pair<int,int>(groundTruth, segResult));
+	if (it == end || it->second != segResult)
+		return -1;
+	return (int)(it - pairs->begin());
+}
+
+
+
+/*
+ * Class CIntervalOverlapActiveBands
+ *
+ * Bands that are active during the overlap sweep, ordered by their left edge.
+ * Bands overlapping a given horizontal extent are found by a range lookup
+ * (left edge between x1 - maximum band width and x2) instead of testing all active bands.
+ */
+
+/*
+ * Constructor
+ *
+ * 'maxWidth' - Maximum width (last column - first column) of all bands that will be added
+ */
+CIntervalOverlapActiveBands::CIntervalOverlapActiveBands(int maxWidth)
+{
+	m_MaxWidth = maxWidth;
+}
+
+/*
+ * Comparison for the expiry heap (the band with the smallest last row is on top)
+ */
+static bool EndsLater(const pair<int, multimap<int, CIntervalOverlapBand*>::iterator> & a,
+					  const pair<int, multimap<int, CIntervalOverlapBand*>::iterator> & b)
+{
+	return a.first > b.first;
+}
+
+/*
+ * Adds the given band
+ */
+void CIntervalOverlapActiveBands::Add(CIntervalOverlapBand * band)
+{
+	CBandMap::iterator it = m_Bands.insert(pair<int, CIntervalOverlapBand*>(band->m_X1, band));
+	m_Expiry.push_back(pair<int, CBandMap::iterator>(band->m_Y2, it));
+	push_heap(m_Expiry.begin(), m_Expiry.end(), EndsLater);
+}
+
+/*
+ * Removes all bands that end above the given row.
+ */
+void CIntervalOverlapActiveBands::RemoveExpired(int row)
+{
+	while (!m_Expiry.empty() && m_Expiry.front().first < row)
+	{
+		m_Bands.erase(m_Expiry.front().second);
+		pop_heap(m_Expiry.begin(), m_Expiry.end(), EndsLater);
+		m_Expiry.pop_back();
+	}
+}
+
+/*
+ * Collects the bands whose horizontal extent overlaps the extent of the given band.
+ *
+ * 'overlapping' (out) - The bands (the list is cleared first)
+ */
+void CIntervalOverlapActiveBands::FindOverlapping(CIntervalOverlapBand * band, vector<CIntervalOverlapBand*> * overlapping)
+{
+	overlapping->clear();
+	CBandMap::iterator it = m_Bands.lower_bound(band->m_X1 - m_MaxWidth);
+	CBandMap::iterator end = m_Bands.upper_bound(band->m_X2);
+	for (; it != end; it++)
+	{
+		if ((*it).second->m_X2 >= band->m_X1)
+			overlapping->push_back((*it).second);
+	}
+}
+
+} //end namespace
@@ -0,0 +1,83 @@
+#pragma once
+
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include "IntervalRepresentation.h"
+#include <vector>
+#include <map>
+
+namespace PRImA
+{
+
+/*
+ * Class CIntervalOverlapBand
+ *
+ * One interval (horizontal band) of an interval representation, as used by the overlap sweep.
+ */
+class CIntervalOverlapBand
+{
+public:
+	int m_Y1;					//First row
+	int m_Y2;					//Last row
+	int m_X1;					//Horizontal extent of all segments
+	int m_X2;
+	int m_Owner;				//Index of the interval representation
+	std::vector<int> * m_Segments;	//Pairs [x1, x2] (not owned)
+};
+
+
+/*
+ * Class CIntervalOverlapActiveBands
+ *
+ * Bands that are active during the overlap sweep, ordered by their left edge.
+ * Bands overlapping a given horizontal extent are found by a range lookup
+ * (left edge between x1 - maximum band width and x2) instead of testing all active bands.
+ */
+class CIntervalOverlapActiveBands
+{
+public:
+	CIntervalOverlapActiveBands(int maxWidth);
+
+	void	Add(CIntervalOverlapBand * band);
+	void	RemoveExpired(int row);
+	void	FindOverlapping(CIntervalOverlapBand * band, std::vector<CIntervalOverlapBand*> * overlapping);
+
+private:
+	typedef std::multimap<int, CIntervalOverlapBand*> CBandMap;
+
+	CBandMap	m_Bands;	//Map [first column, band]
+	std::vector<std::pair<int, CBandMap::iterator>> m_Expiry;	//Min-heap [last row, band]
+	int			m_MaxWidth;	//Maximum band width (last column - first column)
+};
+
+
+/*
+ * Class CIntervalOverlapSweep
+ *
+ * Calculates the overlap areas of many ground truth / segmentation result interval representation
+ * pairs in one pass. All intervals are sorted by their first row and swept top to bottom.
+ * Only bands that are active at the same time and overlap horizontally are intersected
+ * (see CIntervalOverlapActiveBands). Coordinates are inclusive.
+ */
+class CIntervalOverlapSweep
+{
+public:
+	static void CalculateOverlapAreas(	std::vector<CIntervalRepresentation*> * groundTruth,
+										std::vector<CIntervalRepresentation*> * segResult,
+										std::vector<std::pair<int,int>> * pairs, std::vector<int> * pairStart,
+										std::vector<long> * overlapAreas);
+
+private:
+	friend class CLabelRasterOverlap;	//Uses the band and pair helpers
+
+	static void AddBands(CIntervalRepresentation * intRepr, int owner, std::vector<CIntervalOverlapBand> * bands);
+	static int	FindPair(std::vector<std::pair<int,int>> * pairs, std::vector<int> * pairStart, int groundTruth, int segResult);
+	static int	GetMaxWidth(std::vector<CIntervalOverlapBand> * bands);
+	static long GetSegmentOverlap(std::vector<int> * segments1, std::vector<int> * segments2);
+};
+
+} //end namespace
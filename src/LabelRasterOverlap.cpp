@@ -0,0 +1,280 @@
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include "stdafx.h"
+#include "LabelRasterOverlap.h"
+#include <algorithm>
+#include <climits>
+
+using namespace std;
+
+namespace PRImA
+{
+
+/*
+ * Class CLabelRasterOverlap
+ *
+ * Alternative overlap engine for area based figures. The ground truth and the segmentation result
+ * are rasterised row by row into two label planes (label = object index + 1, 0 = no object).
+ * Each row is then scanned for runs of equal label pairs, which gives a co-occurrence histogram of
+ * pairwise overlap areas. The foreground pixels (bilevel image) are counted per label in the same pass.
+ *
+ * A label plane holds one label per pixel. In rows where objects of one layout overlap each other,
+ * the overlap areas and pixel counts are taken from the segments of the active bands instead.
+ */
+
+/*
+ * Calculates the overlap area for each of the given pairs and the foreground pixel count of each object.
+ *
+ * 'groundTruth' - Interval representations of the ground truth objects (NULL entries are ignored)
+ * 'segResult' - Interval representations of the segmentation result objects (NULL entries are ignored)
+ * 'pairs' - Pairs [ground truth index, segmentation result index], sorted (the histogram bins)
+ * 'pairStart' - Position of the first pair of each ground truth object within 'pairs' (groundTruth->size()+1 entries)
+ * 'image' - Bilevel image for the foreground pixel counts (can be NULL)
+ * 'overlapAreas' (out) - Overlap area for each pair (same order as 'pairs')
+ * 'groundTruthPixelCounts' (out) - Foreground pixel count for each ground truth object (0 if there is no image)
+ * 'segResultPixelCounts' (out) - Foreground pixel count for each segmentation result object (0 if there is no image)
+ */
+void CLabelRasterOverlap::CalculateOverlapAreas(vector<CIntervalRepresentation*> * groundTruth,
+												vector<CIntervalRepresentation*> * segResult,
+												vector<pair<int,int>> * pairs, vector<int> * pairStart,
+												COpenCvBiLevelImage * image,
+												vector<long> * overlapAreas,
+												vector<long> * groundTruthPixelCounts, vector<long> * segResultPixelCounts)
+{
+	overlapAreas->assign(pairs->size(), 0L);
+	groundTruthPixelCounts->assign(groundTruth->size(), 0L);
+	segResultPixelCounts->assign(segResult->size(), 0L);
+
+	vector<CIntervalOverlapBand> groundTruthBands;
+	for (int i=0; i<(int)groundTruth->size(); i++)
+		if (groundTruth->at(i) != NULL)
+			CIntervalOverlapSweep::AddBands(groundTruth->at(i), i, &groundTruthBands);
+
+	vector<CIntervalOverlapBand> segResultBands;
+	for (int i=0; i<(int)segResult->size(); i++)
+		if (segResult->at(i) != NULL)
+			CIntervalOverlapSweep::AddBands(segResult->at(i), i, &segResultBands);
+
+	if (groundTruthBands.empty() && segResultBands.empty())
+		return;
+
+	auto byFirstRow = [](const CIntervalOverlapBand & a, const CIntervalOverlapBand & b) { return a.m_Y1 < b.m_Y1; };
+	sort(groundTruthBands.begin(), groundTruthBands.end(), byFirstRow);
+	sort(segResultBands.begin(), segResultBands.end(), byFirstRow);
+
+	//Label planes and foreground row (one row, covering the horizontal extent of all bands)
+	int minX = INT_MAX, maxX = INT_MIN;
+	for (unsigned int i=0; i<groundTruthBands.size(); i++)
+	{
+		minX = min(minX, groundTruthBands[i].m_X1);
+		maxX = max(maxX, groundTruthBands[i].m_X2);
+	}
+	for (unsigned int i=0; i<segResultBands.size(); i++)
+	{
+		minX = min(minX, segResultBands[i].m_X1);
+		maxX = max(maxX, segResultBands[i].m_X2);
+	}
+	vector<int> groundTruthLabels(maxX - minX + 1, 0);
+	vector<int> segResultLabels(maxX - minX + 1, 0);
+	vector<unsigned char> foreground(image != NULL ? maxX - minX + 1 : 0, 0);
+
+	vector<CIntervalOverlapBand*> activeGroundTruth;
+	vector<CIntervalOverlapBand*> activeSegResult;
+	unsigned int nextGroundTruth = 0, nextSegResult = 0;
+	int row = INT_MIN;
+	while (true)
+	{
+		//Next row (skip empty rows)
+		row++;
+		if (activeGroundTruth.empty() && activeSegResult.empty())
+		{
+			if (nextGroundTruth >= groundTruthBands.size() && nextSegResult >= segResultBands.size())
+				break;
+			int nextRow = INT_MAX;
+			if (nextGroundTruth < groundTruthBands.size())
+				nextRow = groundTruthBands[nextGroundTruth].m_Y1;
+			if (nextSegResult < segResultBands.size())
+				nextRow = min(nextRow, segResultBands[nextSegResult].m_Y1);
+			row = max(row, nextRow);
+		}
+		UpdateActiveBands(&groundTruthBands, nextGroundTruth, &activeGroundTruth, row);
+		UpdateActiveBands(&segResultBands, nextSegResult, &activeSegResult, row);
+		if (activeGroundTruth.empty() && activeSegResult.empty())
+			continue;
+
+		//Rasterise
+		int first = INT_MAX, last = INT_MIN;
+		bool groundTruthUnique = FillLabelRow(&activeGroundTruth, minX, &groundTruthLabels, first, last);
+		bool segResultUnique = FillLabelRow(&activeSegResult, minX, &segResultLabels, first, last);
+		if (first > last)
+			continue;
+
+		//Overlap areas
+		if (groundTruthUnique && segResultUnique)
+		{
+			//Histogram (runs of equal label pairs)
+			int x = first;
+			while (x <= last)
+			{
+				int groundTruthLabel = groundTruthLabels[x];
+				int segResultLabel = segResultLabels[x];
+				int runEnd = x;
+				while (runEnd+1 <= last && groundTruthLabels[runEnd+1] == groundTruthLabel && segResultLabels[runEnd+1] == segResultLabel)
+					runEnd++;
+
+				if (groundTruthLabel > 0 && segResultLabel > 0)
+				{
+					int pairIndex = CIntervalOverlapSweep::FindPair(pairs, pairStart, groundTruthLabel-1, segResultLabel-1);
+					if (pairIndex >= 0)
+						overlapAreas->at(pairIndex) += runEnd - x + 1;
+				}
+				x = runEnd + 1;
+			}
+		}
+		else //Objects of one layout overlap in this row
+			AddBandOverlaps(&activeGroundTruth, &activeSegResult, pairs, pairStart, overlapAreas);
+
+		//Foreground pixel counts
+		if (image != NULL)
+		{
+			bool rowInImage = row >= 0 && row < image->GetHeight();
+			for (int x=first; x<=last; x++)
+			{
+				int imageX = x + minX;
+				foreground[x] = rowInImage && imageX >= 0 && imageX < image->GetWidth() && image->IsBlack(imageX, row) ? 1 : 0;
+			}
+
+			if (groundTruthUnique)
+				CountLabelForeground(&groundTruthLabels, &foreground, first, last, groundTruthPixelCounts);
+			else
+				CountBandForeground(&activeGroundTruth, &foreground, minX, groundTruthPixelCounts);
+			if (segResultUnique)
+				CountLabelForeground(&segResultLabels, &foreground, first, last, segResultPixelCounts);
+			else
+				CountBandForeground(&activeSegResult, &foreground, minX, segResultPixelCounts);
+		}
+
+		//Clear the used part of the label planes for the next row
+		fill(groundTruthLabels.begin() + first, groundTruthLabels.begin() + last + 1, 0);
+		fill(segResultLabels.begin() + first, segResultLabels.begin() + last + 1, 0);
+	}
+}
+
+/*
+ * Adds the bands starting at the given row to the active list and removes the ones that ended above it.
+ */
+void CLabelRasterOverlap::UpdateActiveBands(vector<CIntervalOverlapBand> * bands, unsigned int & next,
+											vector<CIntervalOverlapBand*> * active, int row)
+{
+	for (unsigned int i=0; i<active->size(); )
+	{
+		if (active->at(i)->m_Y2 < row)
+		{
+			active->at(i) = active->back();
+			active->pop_back();
+		}
+		else
+			i++;
+	}
+	while (next < bands->size() && bands->at(next).m_Y1 <= row)
+	{
+		if (bands->at(next).m_Y2 >= row)
+			active->push_back(&bands->at(next));
+		next++;
+	}
+}
+
+/*
+ * Writes the labels of the active bands into the label row.
+ * Returns false if a pixel is covered by two different objects (the labels of that row are not usable then).
+ *
+ * 'offset' - x coordinate of the first label
+ * 'first', 'last' (in/out) - Extended by the written range
+ */
+bool CLabelRasterOverlap::FillLabelRow(vector<CIntervalOverlapBand*> * active, int offset, vector<int> * labels,
+									   int & first, int & last)
+{
+	bool unique = true;
+	for (unsigned int i=0; i<active->size(); i++)
+	{
+		CIntervalOverlapBand * band = active->at(i);
+		int label = band->m_Owner + 1;
+		vector<int> * segments = band->m_Segments;
+		for (unsigned int j=0; j+1<segments->size(); j+=2)
+		{
+			int x1 = segments->at(j) - offset;
+			int x2 = segments->at(j+1) - offset;
+			for (int x=x1; x<=x2; x++)
+			{
+				int & current = labels->at(x);
+				if (current != 0 && current != label)
+					unique = false;
+				current = label;
+			}
+			first = min(first, x1);
+			last = max(last, x2);
+		}
+	}
+	return unique;
+}
+
+/*
+ * Adds the overlap areas of one row by intersecting the segments of the active bands directly
+ * (for rows where objects of one layout overlap each other).
+ */
+void CLabelRasterOverlap::AddBandOverlaps(vector<CIntervalOverlapBand*> * activeGroundTruth, vector<CIntervalOverlapBand*> * activeSegResult,
+										  vector<pair<int,int>> * pairs, vector<int> * pairStart, vector<long> * overlapAreas)
+{
+	for (unsigned int i=0; i<activeGroundTruth->size(); i++)
+	{
+		CIntervalOverlapBand * groundTruthBand = activeGroundTruth->at(i);
+		for (unsigned int j=0; j<activeSegResult->size(); j++)
+		{
+			CIntervalOverlapBand * segResultBand = activeSegResult->at(j);
+			if (segResultBand->m_X2 < groundTruthBand->m_X1 || groundTruthBand->m_X2 < segResultBand->m_X1)
+				continue;
+			int pairIndex = CIntervalOverlapSweep::FindPair(pairs, pairStart, groundTruthBand->m_Owner, segResultBand->m_Owner);
+			if (pairIndex >= 0)
+				overlapAreas->at(pairIndex) += CIntervalOverlapSweep::GetSegmentOverlap(groundTruthBand->m_Segments, segResultBand->m_Segments);
+		}
+	}
+}
+
+/*
+ * Adds the foreground pixels of one row to the counts of the objects (via the label row).
+ */
+void CLabelRasterOverlap::CountLabelForeground(vector<int> * labels, vector<unsigned char> * foreground, int first, int last,
+											   vector<long> * pixelCounts)
+{
+	for (int x=first; x<=last; x++)
+	{
+		int label = labels->at(x);
+		if (label > 0 && foreground->at(x))
+			pixelCounts->at(label-1)++;
+	}
+}
+
+/*
+ * Adds the foreground pixels of one row to the counts of the objects (via the segments of the active bands,
+ * for rows where objects of one layout overlap each other).
+ */
+void CLabelRasterOverlap::CountBandForeground(vector<CIntervalOverlapBand*> * active, vector<unsigned char> * foreground, int offset,
+											  vector<long> * pixelCounts)
+{
+	for (unsigned int i=0; i<active->size(); i++)
+	{
+		CIntervalOverlapBand * band = active->at(i);
+		vector<int> * segments = band->m_Segments;
+		long count = 0L;
+		for (unsigned int j=0; j+1<segments->size(); j+=2)
+			for (int x=segments->at(j) - offset; x<=segments->at(j+1) - offset; x++)
+				count += foreground->at(x);
+		pixelCounts->at(band->m_Owner) += count;
+	}
+}
+
+} //end namespace
@@ -0,0 +1,50 @@
+#pragma once
+
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include "IntervalOverlapSweep.h"
+#include "opencvimage.h"
+#include <vector>
+
+namespace PRImA
+{
+
+/*
+ * Class CLabelRasterOverlap
+ *
+ * Alternative overlap engine for area based figures. The ground truth and the segmentation result
+ * are rasterised row by row into two label planes (label = object index + 1, 0 = no object).
+ * Each row is then scanned for runs of equal label pairs, which gives a co-occurrence histogram of
+ * pairwise overlap areas. The foreground pixels (bilevel image) are counted per label in the same pass.
+ *
+ * A label plane holds one label per pixel. In rows where objects of one layout overlap each other,
+ * the overlap areas and pixel counts are taken from the segments of the active bands instead.
+ */
+class CLabelRasterOverlap
+{
+public:
+	static void CalculateOverlapAreas(	std::vector<CIntervalRepresentation*> * groundTruth,
+										std::vector<CIntervalRepresentation*> * segResult,
+										std::vector<std::pair<int,int>> * pairs, std::vector<int> * pairStart,
+										COpenCvBiLevelImage * image,
+										std::vector<long> * overlapAreas,
+										std::vector<long> * groundTruthPixelCounts, std::vector<long> * segResultPixelCounts);
+
+private:
+	static void UpdateActiveBands(std::vector<CIntervalOverlapBand> * bands, unsigned int & next,
+									std::vector<CIntervalOverlapBand*> * active, int row);
+	static bool FillLabelRow(std::vector<CIntervalOverlapBand*> * active, int offset, std::vector<int> * labels,
+								int & first, int & last);
+	static void AddBandOverlaps(std::vector<CIntervalOverlapBand*> * activeGroundTruth, std::vector<CIntervalOverlapBand*> * activeSegResult,
+								std::vector<std::pair<int,int>> * pairs, std::vector<int> * pairStart, std::vector<long> * overlapAreas);
+	static void CountLabelForeground(std::vector<int> * labels, std::vector<unsigned char> * foreground, int first, int last,
+										std::vector<long> * pixelCounts);
+	static void CountBandForeground(std::vector<CIntervalOverlapBand*> * active, std::vector<unsigned char> * foreground, int offset,
+										std::vector<long> * pixelCounts);
+};
+
+} //end namespace
@@ -9,6 +9,7 @@
 #include "LayoutEvaluation.h"
 #include "GraphicRegionInfo.h"
 #include "chartregioninfo.h"
+#include <algorithm>
 
 using namespace PRImA;
 using namespace std;
@@ -38,6 +39,12 @@ CLayoutEvaluation::CLayoutEvaluation(bool takeResonsibiltyForDocumentsAndImages
 	m_Height = -1;
 	m_Profile = NULL;
 	m_HasResonsibiltyForDocumentsAndImages = takeResonsibiltyForDocumentsAndImages;
+	m_UsePixelCountTable = false;
+	m_PixelCountTable = NULL;
+	m_UseBitPackedImage = false;
+	m_BitPackedImage = NULL;
+	m_HasResponsibilityForPixelCounters = true;
+	m_ForegroundPixelCount = -1L;
 }
 
 CLayoutEvaluation::~CLayoutEvaluation(void)
@@ -49,6 +56,12 @@ CLayoutEvaluation::~CLayoutEvaluation(void)
 		it++;
 	}
 
+	if (m_HasResponsibilityForPixelCounters)
+	{
+		delete m_PixelCountTable;
+		delete m_BitPackedImage;
+	}
+
 	if (m_HasResonsibiltyForDocumentsAndImages)
 	{
 		delete m_GrountTruth;
@@ -60,7 +73,7 @@ CLayoutEvaluation::~CLayoutEvaluation(void)
 
 /*
  * Copies all fields (except the evaluation results) from the given other layout evaluation object.
- * Sets hasResonsibiltyForDocumentsAndImages to FALSE.
+ * Sets hasResonsibiltyForDocumentsAndImages to FALSE. The pixel count table and the bit-packed image are shared as well.
  */
 void CLayoutEvaluation::InitialiseFrom(CLayoutEvaluation * other)
 {
@@ -80,6 +93,18 @@ void CLayoutEvaluation::InitialiseFrom(CLayoutEvaluation * other)
 	m_Height = other->m_Height;
 
 	m_Profile = other->m_Profile;
+
+	if (m_HasResponsibilityForPixelCounters)
+	{
+		delete m_PixelCountTable;
+		delete m_BitPackedImage;
+	}
+	m_UsePixelCountTable = other->m_UsePixelCountTable;
+	m_PixelCountTable = other->m_PixelCountTable;
+	m_UseBitPackedImage = other->m_UseBitPackedImage;
+	m_BitPackedImage = other->m_BitPackedImage;
+	m_HasResponsibilityForPixelCounters = false;
+	m_ForegroundPixelCount = other->m_ForegroundPixelCount;
 }
 
 int CLayoutEvaluation::GetWidth()
@@ -168,6 +193,18 @@ void CLayoutEvaluation::SetBilevelImage(COpenCvBiLevelImage * img)
 	{
 		delete m_BilevelImage;
 		m_BilevelImage = img;
+
+		//Invalidate the pixel count table and the bit-packed image
+		if (m_HasResponsibilityForPixelCounters)
+		{
+			delete m_PixelCountTable;
+			delete m_BitPackedImage;
+		}
+		m_PixelCountTable = NULL;
+		m_BitPackedImage = NULL;
+		m_HasResponsibilityForPixelCounters = true;
+		m_ForegroundPixelCount = -1L;
+
 		if (m_BilevelImage != NULL)
 		{
 			m_Width = m_BilevelImage->GetWidth();
@@ -176,6 +213,175 @@ void CLayoutEvaluation::SetBilevelImage(COpenCvBiLevelImage * img)
 	}
 }
 
+/*
+ * Returns the summed-area table for the bilevel image.
+ * The table is built on first use. Returns NULL if the table is not enabled or if there is no bilevel image.
+ */
+CPixelCountTable * CLayoutEvaluation::GetPixelCountTable()
+{
+	if (m_PixelCountTable == NULL && m_UsePixelCountTable && m_BilevelImage != NULL && m_HasResponsibilityForPixelCounters)
+		m_PixelCountTable = new CPixelCountTable(m_BilevelImage);
+	return m_PixelCountTable;
+}
+
+/*
+ * Returns the bit-packed copy of the bilevel image.
+ * The copy is built on first use. Returns NULL if it is not enabled or if there is no bilevel image.
+ */
+CBitPackedImage * CLayoutEvaluation::GetBitPackedImage()
+{
+	if (m_BitPackedImage == NULL && m_UseBitPackedImage && m_BilevelImage != NULL && m_HasResponsibilityForPixelCounters)
+		m_BitPackedImage = new CBitPackedImage(m_BilevelImage);
+	return m_BitPackedImage;
+}
+
+/*
+ * Returns the number of black pixels of the whole bilevel image (0 if there is no image).
+ * The count is determined on first use and kept until a different bilevel image is set.
+ */
+long CLayoutEvaluation::GetForegroundPixelCount()
+{
+	if (m_ForegroundPixelCount < 0L)
+	{
+		if (m_BilevelImage == NULL)
+			return 0L;
+		CPixelCountTable * table = GetPixelCountTable();
+		CBitPackedImage * packedImage = GetBitPackedImage();
+		if (table != NULL)
+			m_ForegroundPixelCount = table->CountPixels(0, 0, m_BilevelImage->GetWidth()-1, m_BilevelImage->GetHeight()-1);
+		else if (packedImage != NULL)
+			m_ForegroundPixelCount = packedImage->CountPixels(0, 0, m_BilevelImage->GetWidth()-1, m_BilevelImage->GetHeight()-1);
+		else
+			m_ForegroundPixelCount = m_BilevelImage->CountPixels(true);
+	}
+	return m_ForegroundPixelCount;
+}
+
+/*
+ * Returns the number of black pixels within the given rectangle of the bilevel image (0 if there is no image).
+ * Uses the pixel count table or the bit-packed image if enabled.
+ */
+long CLayoutEvaluation::CountPixels(int x1, int y1, int x2, int y2)
+{
+	CPixelCountTable * table = GetPixelCountTable();
+	if (table != NULL)
+		return table->CountPixels(x1, y1, x2, y2);
+	CBitPackedImage * packedImage = GetBitPackedImage();
+	if (packedImage != NULL)
+		return packedImage->CountPixels(x1, y1, x2, y2);
+	if (m_BilevelImage != NULL)
+		return m_BilevelImage->CountPixels(x1, y1, x2, y2);
+	return 0L;
+}
+
+/*
+ * Returns the number of black pixels within the given rectangle of the bilevel image (0 if there is no image).
+ * Uses the pixel count table or the bit-packed image if enabled.
+ */
+long CLayoutEvaluation::CountPixels(CRect * rect)
+{
+	CPixelCountTable * table = GetPixelCountTable();
+	if (table != NULL)
+		return table->CountPixels(rect);
+	CBitPackedImage * packedImage = GetBitPackedImage();
+	if (packedImage != NULL)
+		return packedImage->CountPixels(rect);
+	if (m_BilevelImage != NULL)
+		return m_BilevelImage->CountPixels(rect);
+	return 0L;
+}
+
+/*
+ * Returns the number of black pixels within the given rectangles of the bilevel image (0 if there is no image).
+ * Uses the pixel count table or the bit-packed image if enabled.
+ *
+ * 'rectsMayOverlap' - If true, pixels covered by several rectangles are counted once
+ *                     (same as the corresponding flag of COpenCvBiLevelImage::CountPixels)
+ */
+long CLayoutEvaluation::CountPixels(vector<CRect*> * rects, bool rectsMayOverlap /*= false*/)
+{
+	CPixelCountTable * table = GetPixelCountTable();
+	CBitPackedImage * packedImage = GetBitPackedImage();
+	if (rectsMayOverlap && (table != NULL || packedImage != NULL))
+		return CountPixelsOfUnion(rects);
+	if (table != NULL)
+		return table->CountPixels(rects);
+	if (packedImage != NULL)
+		return packedImage->CountPixels(rects);
+	if (m_BilevelImage != NULL)
+		return rectsMayOverlap ? m_BilevelImage->CountPixels(rects, true) : m_BilevelImage->CountPixels(rects);
+	return 0L;
+}
+
+/*
+ * Counts the black pixels within the union of the given (possibly overlapping) rectangles.
+ * The union is split into horizontal bands (between the top and bottom edges of the rectangles).
+ * Within each band the horizontal extents are merged and counted as disjoint rectangles.
+ */
+long CLayoutEvaluation::CountPixelsOfUnion(vector<CRect*> * rects)
+{
+	vector<int> edges;
+	for (unsigned int i=0; i<rects->size(); i++)
+	{
+		edges.push_back(rects->at(i)->top);
+		edges.push_back(rects->at(i)->bottom + 1);
+	}
+	sort(edges.begin(), edges.end());
+	edges.erase(unique(edges.begin(), edges.end()), edges.end());
+
+	long count = 0L;
+	vector<pair<int,int>> extents;
+	for (unsigned int b=0; b+1<edges.size(); b++)
+	{
+		int y1 = edges[b];
+		int y2 = edges[b+1] - 1;
+
+		extents.clear();
+		for (unsigned int i=0; i<rects->size(); i++)
+		{
+			CRect * rect = rects->at(i);
+			if (rect->top <= y1 && rect->bottom >= y2 && rect->left <= rect->right)
+				extents.push_back(pair<int,int>(rect->left, rect->right));
+		}
+		sort(extents.begin(), extents.end());
+
+		unsigned int i = 0;
+		while (i < extents.size())
+		{
+			int x1 = extents[i].first;
+			int x2 = extents[i].second;
+			for (i++; i < extents.size() && extents[i].first <= x2 + 1; i++)
+				x2 = max(x2, extents[i].second);
+			count += CountPixels(x1, y1, x2, y2);
+		}
+	}
+	return count;
+}
+
+/*
+ * Returns the number of black pixels within the area of the given interval representation (0 if there is no image).
+ * Uses the pixel count table or the bit-packed image if enabled.
+ */
+long CLayoutEvaluation::CountPixels(CIntervalRepresentation * intRepr)
+{
+	CBitPackedImage * packedImage = GetBitPackedImage();
+	if (packedImage != NULL && GetPixelCountTable() == NULL)
+		return packedImage->CountPixels(intRepr);
+
+	long pixelCount = 0L;
+	for (int i=0; i<intRepr->GetIntervalCount(); i++)
+	{
+		CInterval * interval = intRepr->GetInterval(i);
+		vector<int> * parts = interval->GetIntervalSegments();
+		for (unsigned int j=0; (int)j<(int)parts->size()-1; j+=2)
+		{
+			pixelCount += CountPixels(	parts->at(j), interval->GetStart(),
+										parts->at(j+1), interval->GetEnd());
+		}
+	}
+	return pixelCount;
+}
+
 void CLayoutEvaluation::SetColourImage(COpenCvImage * img) 
 { 
 	if (img != m_ColourImage)
@@ -219,6 +425,9 @@ void CLayoutEvaluation::DeleteResults(int layoutObjectType)
 		delete (*it).second;
 		m_Results.erase(it);
 	}
+	//Nothing refers to the arena memory any more
+	if (m_Results.empty())
+		m_Arena.Reset();
 }
 
 /*
@@ -14,6 +14,9 @@
 #include "EvaluationProfile.h"
 #include "opencvimage.h"
 #include "GlyphStatistics.h"
+#include "PixelCountTable.h"
+#include "BitPackedImage.h"
+#include "EvaluationArena.h"
 #include "EvaluationResults.h"
 
 
@@ -59,8 +62,26 @@ public:
 	void						SetBilevelImage(COpenCvBiLevelImage * img);
 	void						SetColourImage(COpenCvImage * img);
 
+	//Summed-area table for counting black pixels (see CPixelCountTable)
+	inline void					SetUsePixelCountTable(bool use) { m_UsePixelCountTable = use; };
+	inline bool					IsUsePixelCountTable() { return m_UsePixelCountTable; };
+	CPixelCountTable		*	GetPixelCountTable();
+
+	//Bit-packed copy of the bilevel image for counting black pixels (see CBitPackedImage).
+	//Kept in addition to the bilevel image (needs 1/8 of its memory).
+	inline void					SetUseBitPackedImage(bool use) { m_UseBitPackedImage = use; };
+	inline bool					IsUseBitPackedImage() { return m_UseBitPackedImage; };
+	CBitPackedImage			*	GetBitPackedImage();
+
+	long						CountPixels(int x1, int y1, int x2, int y2);
+	long						CountPixels(CRect * rect);
+	long						CountPixels(std::vector<CRect*> * rects, bool rectsMayOverlap = false);
+	long						CountPixels(CIntervalRepresentation * intRepr);
+
 	int							GetWidth();
 	int							GetHeight();
+	inline int					GetImageArea() { return GetWidth() * GetHeight(); };
+	long						GetForegroundPixelCount();
 	void						SetWidth(int w);
 	void						SetHeight(int h);
 
@@ -68,6 +89,8 @@ public:
 
 	void						DeleteResults(int layoutObjectType);
 
+	inline CEvaluationArena *	GetArena() { return &m_Arena; };
+
 	inline CEvaluationProfile * GetProfile() { return m_Profile; };
 	inline void					SetProfile(CEvaluationProfile * profile) { m_Profile = profile; };
 
@@ -78,6 +101,9 @@ public:
 
 	static CUniString GetLayoutRegionSubtype(CLayoutRegion * reg, CEvaluationProfile * profile);
 
+private:
+	long						CountPixelsOfUnion(std::vector<CRect*> * rects);
+
 private:
 	CString	m_GroundTruthLocation;	//Full path to the ground truth XML file
 	CString	m_SegResultLocation;	//Full path to the segmentation result XML file
@@ -90,6 +116,13 @@ private:
 	COpenCvBiLevelImage		*	m_BilevelImage;		//Black-and-white image
 	COpenCvImage			*	m_ColourImage;		//Colour or grey level image
 
+	bool						m_UsePixelCountTable;		//Count black pixels using the summed-area table (default: false)
+	CPixelCountTable		*	m_PixelCountTable;			//Built on first use (for the bilevel image)
+	bool						m_UseBitPackedImage;		//Count black pixels using the bit-packed image (default: false)
+	CBitPackedImage			*	m_BitPackedImage;			//Built on first use (for the bilevel image)
+	bool						m_HasResponsibilityForPixelCounters;	//False if table and packed image are shared with another layout evaluation
+	long						m_ForegroundPixelCount;		//Black pixels of the whole bilevel image (-1 = not counted yet)
+
 	int						m_Width;			//Document
 	int						m_Height;			//dimensions
 
@@ -97,6 +130,8 @@ private:
 
 	std::map<int, CEvaluationResults *> m_Results;	//Map [layoutObjectType, EvaluationResults]
 
+	CEvaluationArena	m_Arena;			//Memory for errors and object results (released when all results are deleted)
+
 	bool m_HasResonsibiltyForDocumentsAndImages;
 
 	CCriticalSection m_CriticalSect;			//For synchronization
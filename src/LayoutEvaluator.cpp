@@ -44,6 +44,7 @@ CLayoutEvaluator::CLayoutEvaluator(CLayoutEvaluation * layoutEval, CEvaluationPr
 	m_Progress = 0.0;
 
 	m_UsePixelArea = profile->IsUsePixelArea();
+	m_UseLabelRaster = profile->IsUseLabelRaster();
 
 	m_EnableErrorChecks.push_back(false);	//TYPE_NONE
 	m_EnableErrorChecks.push_back(true);	//TYPE_SPLIT
@@ -54,6 +55,13 @@ CLayoutEvaluator::CLayoutEvaluator(CLayoutEvaluation * layoutEval, CEvaluationPr
 	m_EnableErrorChecks.push_back(true);	//TYPE_INVENT
 
 	m_ConvertToIsothetic = true;
+
+	m_MaxThreads = 0;
+	m_WorkerPool = NULL;
+	m_GroundTruthRelations = NULL;
+	m_SegResultRelations = NULL;
+	m_GroundTruthPositions = NULL;
+	m_RotatedBoundingBoxes = NULL;
 }
 
 
@@ -62,6 +70,7 @@ CLayoutEvaluator::CLayoutEvaluator(CLayoutEvaluation * layoutEval, CEvaluationPr
  */
 CLayoutEvaluator::~CLayoutEvaluator()
 {
+	delete m_WorkerPool;
 }
 
 /*
@@ -79,6 +88,9 @@ void CLayoutEvaluator::RunEvaluation(CProgressMonitor * progressMonitor)
 	m_LayoutEvaluation->DeleteResults(CLayoutObject::TYPE_READING_ORDER_GROUP);
 	m_LayoutEvaluation->Unlock(lockObject);
 
+	//Errors and object results come from the arena of the layout evaluation
+	CEvaluationArena::CScope arenaScope(m_LayoutEvaluation->GetArena());
+
 	m_ProgressMonitor = progressMonitor;
 
 	int count = 0;
@@ -90,20 +102,109 @@ void CLayoutEvaluator::RunEvaluation(CProgressMonitor * progressMonitor)
 	if (m_EvaluateBorder)	count++;
 
 	m_MaxPartialProgress = 100.0 / count; //Max progress value per region level
-	
-	//TODO use threads
-	if (m_EvaluateRegions || m_EvaluateReadingOrder)
-		Evaluate(CLayoutObject::TYPE_LAYOUT_REGION);
-	if (m_EvaluateTextLines)
-		Evaluate(CLayoutObject::TYPE_TEXT_LINE);
-	if (m_EvaluateWords)
-		Evaluate(CLayoutObject::TYPE_WORD);
+
+	//The document dimensions and the pixel counters are determined lazily, make sure that happens before the workers start
+	m_LayoutEvaluation->GetWidth();
+	m_LayoutEvaluation->GetHeight();
+	m_LayoutEvaluation->GetPixelCountTable();
+	m_LayoutEvaluation->GetBitPackedImage();
+	m_LayoutEvaluation->GetForegroundPixelCount();
+
+	//Worker threads (kept for the next run if the number of threads doesn't change)
+	int threadCount = m_MaxThreads;
+	if (threadCount <= 0)
+		threadCount = (int)thread::hardware_concurrency();
+	if (m_WorkerPool != NULL && (threadCount <= 1 || m_WorkerPool->GetThreadCount() != threadCount))
+	{
+		delete m_WorkerPool;
+		m_WorkerPool = NULL;
+	}
+	if (m_WorkerPool == NULL && threadCount > 1)
+		m_WorkerPool = new CWorkerPool(threadCount);
+
+	//Flattened weights for the metrics (compiled for each run, so changed weight values are picked up)
+	m_Profile->CompileWeightTable();
+
+	//Reading order positions (used for allowable merges)
+	if (	(m_EvaluateRegions || m_EvaluateReadingOrder)
+		&&	m_LayoutEvaluation->GetGroundTruth() != NULL && m_LayoutEvaluation->GetGroundTruth()->GetReadingOrder() != NULL)
+	{
+		m_GroundTruthPositions = new CReadingOrderPositionIndex(m_LayoutEvaluation->GetGroundTruth()->GetReadingOrder());
+	}
+
+	//Reading order relations (used for all region pairs)
+	if (m_EvaluateReadingOrder)
+	{
+		if (m_LayoutEvaluation->GetGroundTruth() != NULL && m_LayoutEvaluation->GetGroundTruth()->GetReadingOrder() != NULL)
+			m_GroundTruthRelations = new CReadingOrderRelationMatrix(m_LayoutEvaluation->GetGroundTruth()->GetReadingOrder());
+		if (m_LayoutEvaluation->GetSegResult() != NULL && m_LayoutEvaluation->GetSegResult()->GetReadingOrder() != NULL)
+			m_SegResultRelations = new CReadingOrderRelationMatrix(m_LayoutEvaluation->GetSegResult()->GetReadingOrder());
+	}
+
+	//Task graph
+	//  Regions, reading order groups and border all convert the region outlines (isothetic),
+	//  so they have to run one after the other. Text lines, words and glyphs only share
+	//  read-only data with the other levels and are independent tasks.
+	//  The most expensive levels come first so that they are started as early as possible.
+	vector<vector<int>> taskChains;
 	if (m_EvaluateGlyphs)
-		Evaluate(CLayoutObject::TYPE_GLYPH);
+		taskChains.push_back(vector<int>(1, CLayoutObject::TYPE_GLYPH));
+	if (m_EvaluateWords)
+		taskChains.push_back(vector<int>(1, CLayoutObject::TYPE_WORD));
+	if (m_EvaluateTextLines)
+		taskChains.push_back(vector<int>(1, CLayoutObject::TYPE_TEXT_LINE));
+	vector<int> regionChain;
+	if (m_EvaluateRegions || m_EvaluateReadingOrder)
+		regionChain.push_back(CLayoutObject::TYPE_LAYOUT_REGION);
 	if (m_EvaluateReadingOrderGroups)
-		Evaluate(CLayoutObject::TYPE_READING_ORDER_GROUP);
+		regionChain.push_back(CLayoutObject::TYPE_READING_ORDER_GROUP);
 	if (m_EvaluateBorder)
-		Evaluate(CLayoutObject::TYPE_BORDER);
+		regionChain.push_back(CLayoutObject::TYPE_BORDER);
+	if (!regionChain.empty())
+		taskChains.push_back(regionChain);
+
+	ParallelFor((int)taskChains.size(), [&](int chainIndex)
+	{
+		vector<int> & chain = taskChains[chainIndex];
+		for (unsigned int i=0; i<chain.size(); i++)
+			Evaluate(chain[i]);
+	});
+
+	delete m_GroundTruthRelations;
+	m_GroundTruthRelations = NULL;
+	delete m_SegResultRelations;
+	m_SegResultRelations = NULL;
+	delete m_GroundTruthPositions;
+	m_GroundTruthPositions = NULL;
+	delete m_RotatedBoundingBoxes;
+	m_RotatedBoundingBoxes = NULL;
+}
+
+/*
+ * Runs the tasks 0..taskCount-1 on the worker pool (see SetMaxThreads() and CWorkerPool).
+ * Can be called from within a task. Returns when all tasks have finished.
+ * An exception thrown by a task is passed on to the caller.
+ */
+void CLayoutEvaluator::ParallelFor(int taskCount, function<void(int)> task)
+{
+	if (m_WorkerPool == NULL) //Run in calling thread
+	{
+		for (int i=0; i<taskCount; i++)
+			task(i);
+		return;
+	}
+	m_WorkerPool->ParallelFor(taskCount, task);
+}
+
+/*
+ * Returns the results for the given layout object type (synchronised access to the results map of the layout evaluation).
+ */
+CEvaluationResults * CLayoutEvaluator::GetResults(CLayoutEvaluation * layoutEval, int layoutObjectType, bool createIfNotExists /*= false*/)
+{
+	CSingleLock * lockObject = layoutEval->Lock();
+	CEvaluationResults * results = layoutEval->GetResults(layoutObjectType, createIfNotExists);
+	layoutEval->Unlock(lockObject);
+	return results;
 }
 
 /*
@@ -121,11 +222,15 @@ void CLayoutEvaluator::Evaluate(int layoutObjectType)
 		//Prepare the relevant data (interval representations, overlap maps, ...)
 		ProcessGroundTruthObjects(layoutObjectType, m_LayoutEvaluation);
 
+		//Rotated bounding boxes for allowable merges and splits (after the outlines have been converted and clipped)
+		if (layoutObjectType == CLayoutObject::TYPE_LAYOUT_REGION)
+			PrepareRotatedBoundingBoxes();
+
 		//Now find the errors
 		FindErrors(layoutObjectType, m_LayoutEvaluation);
 
-		CEvaluationResults * results = m_LayoutEvaluation->GetResults(layoutObjectType);
-		results->CalculateMetrics();
+		CEvaluationResults * results = GetResults(m_LayoutEvaluation, layoutObjectType);
+		results->CalculateMetrics(&m_EagerMetricsRegionTypes);
 	}
 }
 
@@ -138,6 +243,28 @@ void CLayoutEvaluator::EvaluateRegionsAndNestedRegions()
 	//Parent regions and nested regions are thereby evaluated separatly in different combinations.
 	//For example, parent-to-nested means the ground truth parent regions are compared with the segmentation result nested regions
 
+	//Shared preparation
+	//  Isothetic conversion, interval representations, pixel counts and the spatial indexes
+	//  are the same for all four passes. They are calculated only once and used read-only afterwards.
+	//  (Declared before the pass evaluations, so they are destroyed after them.)
+	if (m_ConvertToIsothetic)
+		ConvertToIsothetic(CLayoutObject::TYPE_LAYOUT_REGION, m_LayoutEvaluation);
+
+	CEvaluationResults sharedGeometry(m_LayoutEvaluation, m_Profile, CLayoutObject::TYPE_LAYOUT_REGION);
+	PrepareSharedGeometry(&sharedGeometry, m_LayoutEvaluation->GetGroundTruth(), true);
+	PrepareSharedGeometry(&sharedGeometry, m_LayoutEvaluation->GetSegResult(), false);
+
+	//Rotated bounding boxes for allowable merges and splits (after the outlines have been converted and clipped)
+	PrepareRotatedBoundingBoxes();
+
+	vector<CLayoutObject*> segResParentRegions;
+	GetParentRegions(m_LayoutEvaluation->GetSegResult(), &segResParentRegions);
+	CLayoutObjectIndex parentRegionsIndex(&segResParentRegions);
+
+	vector<CLayoutObject*> segResNestedRegions;
+	GetNestedRegions(m_LayoutEvaluation->GetSegResult(), &segResNestedRegions);
+	CLayoutObjectIndex nestedRegionsIndex(&segResNestedRegions);
+
 	CLayoutEvaluation evalParentToParent(false);
 	evalParentToParent.InitialiseFrom(m_LayoutEvaluation);
 
@@ -150,20 +277,23 @@ void CLayoutEvaluator::EvaluateRegionsAndNestedRegions()
 	CLayoutEvaluation evalNestedToNested(false);
 	evalNestedToNested.InitialiseFrom(m_LayoutEvaluation);
 
-	//Prepare the relevant data (interval representations, overlap maps, ...)
-	ProcessGroundTruthObjects(CLayoutObject::TYPE_LAYOUT_REGION, &evalParentToParent, NESTED_REGION_MODE_PARENT_TO_PARENT);
-	ProcessGroundTruthObjects(CLayoutObject::TYPE_LAYOUT_REGION, &evalParentToNested, NESTED_REGION_MODE_PARENT_TO_NESTED);
-	ProcessGroundTruthObjects(CLayoutObject::TYPE_LAYOUT_REGION, &evalNestedToParent, NESTED_REGION_MODE_NESTED_TO_PARENT);
-	ProcessGroundTruthObjects(CLayoutObject::TYPE_LAYOUT_REGION, &evalNestedToNested, NESTED_REGION_MODE_NESTED_TO_NESTED);
+	CLayoutEvaluation * passes[4] = { &evalParentToParent, &evalParentToNested, &evalNestedToParent, &evalNestedToNested };
+	int modes[4] = {	NESTED_REGION_MODE_PARENT_TO_PARENT, NESTED_REGION_MODE_PARENT_TO_NESTED, 
+						NESTED_REGION_MODE_NESTED_TO_PARENT, NESTED_REGION_MODE_NESTED_TO_NESTED };
+	CLayoutObjectIndex * segResIndexes[4] = { &parentRegionsIndex, &nestedRegionsIndex, &parentRegionsIndex, &nestedRegionsIndex };
 
-	//Now find the errors
-	FindErrors(CLayoutObject::TYPE_LAYOUT_REGION, &evalParentToParent, NESTED_REGION_MODE_PARENT_TO_PARENT);
-	FindErrors(CLayoutObject::TYPE_LAYOUT_REGION, &evalParentToNested, NESTED_REGION_MODE_PARENT_TO_NESTED);
-	FindErrors(CLayoutObject::TYPE_LAYOUT_REGION, &evalNestedToParent, NESTED_REGION_MODE_NESTED_TO_PARENT);
-	FindErrors(CLayoutObject::TYPE_LAYOUT_REGION, &evalNestedToNested, NESTED_REGION_MODE_NESTED_TO_NESTED);
+	for (int i=0; i<4; i++)
+		passes[i]->GetResults(CLayoutObject::TYPE_LAYOUT_REGION, true)->SetSharedGeometry(&sharedGeometry);
+
+	//Overlaps and errors (the four passes are independent)
+	ParallelFor(4, [&](int i)
+	{
+		PrepareGroundTruthRegionsLinesWordsGlyphs(CLayoutObject::TYPE_LAYOUT_REGION, passes[i], modes[i], segResIndexes[i]);
+		FindErrors(CLayoutObject::TYPE_LAYOUT_REGION, passes[i], modes[i]);
+	});
 
 	//Combine the four results
-	CEvaluationResults * targetResults = m_LayoutEvaluation->GetResults(CLayoutObject::TYPE_LAYOUT_REGION, true);
+	CEvaluationResults * targetResults = GetResults(m_LayoutEvaluation, CLayoutObject::TYPE_LAYOUT_REGION, true);
 
 	CombineTopLevelAndNestedEvaluationResults(targetResults, evalParentToParent.GetResults(CLayoutObject::TYPE_LAYOUT_REGION),
 															evalParentToNested.GetResults(CLayoutObject::TYPE_LAYOUT_REGION), 1L, 1L, 5L, 1L, 1L);
@@ -188,7 +318,7 @@ void CLayoutEvaluator::EvaluateRegionsAndNestedRegions()
 	
 	//TODO Copy anything else?
 
-	targetResults->CalculateMetrics();
+	targetResults->CalculateMetrics(&m_EagerMetricsRegionTypes);
 }
 
 /*
@@ -221,10 +351,10 @@ void CLayoutEvaluator::CombineTopLevelAndNestedEvaluationResults(CEvaluationResu
 												splitMultiplier, missMultiplier, partialMissMultiplier,
 												misclassMultiplier);
 
-		if (sameLevelError <= acrossLevelError)
-			CopyLayoutObjectEvalResults(targetResults, targetgroundTruthObjectResults, sameLevelgroundTruthObjectResult);
+		if (sameLevelError <= acrossLevelError || acrossLevelgroundTruthObjectResult == NULL)
+			MoveLayoutObjectEvalResults(targetResults, targetgroundTruthObjectResults, it);
 		else
-			CopyLayoutObjectEvalResults(targetResults, targetgroundTruthObjectResults, acrossLevelgroundTruthObjectResult);
+			MoveLayoutObjectEvalResults(targetResults, targetgroundTruthObjectResults, itAcross);
 	}
 }
 
@@ -254,18 +384,27 @@ void CLayoutEvaluator::CombineTopLevelAndNestedFalseDetectionResults(CEvaluation
 		long acrossLevelError = CalculateErrorSum(acrossLevelsegResultObjectResult, 1L, 1L, 1L, 1L, 1L);
 
 		if (sameLevelError <= acrossLevelError || acrossLevelsegResultObjectResult == NULL)
-			CopyLayoutObjectEvalResults(targetResults, targetsegResultObjectResults, sameLevelsegResultObjectResult);
+			MoveLayoutObjectEvalResults(targetResults, targetsegResultObjectResults, it);
 		else
-			CopyLayoutObjectEvalResults(targetResults, targetsegResultObjectResults, acrossLevelsegResultObjectResult);
+			MoveLayoutObjectEvalResults(targetResults, targetsegResultObjectResults, itAcross);
 	}
 }
 
 /*
- * Copies the given error object to the specified target result map
+ * Moves the result object at the given position of a pass result map to the specified target result map (no copy).
+ * The source entry is set to NULL. Nothing happens if the target already has a result for the object.
+ * Note: Errors and results are allocated from the arena of m_LayoutEvaluation (see RunEvaluation), 
+ *       so they can outlive the temporary pass evaluations.
  */
-void CLayoutEvaluator::CopyLayoutObjectEvalResults(CEvaluationResults * targetResults, map<CUniString, CLayoutObjectEvaluationResult*> * target, CLayoutObjectEvaluationResult * evalRes)
+void CLayoutEvaluator::MoveLayoutObjectEvalResults(CEvaluationResults * targetResults, map<CUniString, CLayoutObjectEvaluationResult*> * target, 
+												   map<CUniString, CLayoutObjectEvaluationResult*>::iterator source)
 {
-	target->insert(pair<CUniString, CLayoutObjectEvaluationResult*>(evalRes->GetRegion(), evalRes->Clone(targetResults)));
+	CLayoutObjectEvaluationResult * evalRes = (*source).second;
+	if (evalRes == NULL || target->find(evalRes->GetRegion()) != target->end())
+		return;
+	(*source).second = NULL;
+	evalRes->SetResults(targetResults);
+	target->insert(pair<CUniString, CLayoutObjectEvaluationResult*>(evalRes->GetRegion(), evalRes));
 }
 
 /*
@@ -377,89 +516,147 @@ void CLayoutEvaluator::PrepareGroundTruthReadingOrderGroups(CLayoutEvaluation *
 	while (objectIterator->HasNext())
 		((CReadingOrderGroup*)objectIterator->Next())->CalcCoords(layoutEval->GetSegResult());
 
-	//Build a bounding box search map for the segmentation result
-	CBoundingBoxMap * boundingBoxMap = NULL;
+	//Build a spatial index for the segmentation result
+	vector<CLayoutObject*> segResGroups;
 	objectIterator->Reset();
-	boundingBoxMap = new CBoundingBoxMap(objectIterator);
+	while (objectIterator->HasNext())
+		segResGroups.push_back(objectIterator->Next());
 	delete objectIterator;
+	CLayoutObjectIndex segResIndex(&segResGroups);
 	IncreaseProgress(m_MaxPartialProgress * 0.05); //5%
 
 	//Now iterate over the ground truth regions and find the overlapping segmentation result regions
-	CEvaluationResults * results = layoutEval->GetResults(CLayoutObject::TYPE_READING_ORDER_GROUP, true);
+	CEvaluationResults * results = GetResults(layoutEval, CLayoutObject::TYPE_READING_ORDER_GROUP, true);
+	vector<CLayoutObject*> groundTruthGroups;
 	objectIterator = new CReadingOrderGroupIterator(layoutEval->GetGroundTruth(), 2, false);
-
 	while (objectIterator->HasNext())
 	{
 		CReadingOrderGroup * group = (CReadingOrderGroup*)objectIterator->Next();
 		//Calc bounding boxes
 		group->CalcCoords(layoutEval->GetSegResult());
-		//Overlaps
-		CalculateOverlaps(group, boundingBoxMap, results);
+		groundTruthGroups.push_back(group);
 	}
 	delete objectIterator;
 
-	delete boundingBoxMap;
+	vector<pair<int,int>> candidatePairs;
+	vector<int> candidateStart;
+	vector<long> candidateAreas;
+	FindOverlapCandidates(&segResIndex, &groundTruthGroups, results, false, &candidatePairs, &candidateStart, &candidateAreas);
+
+	//Overlaps
+	COverlapShard shard;
+	for (int i=0; i<(int)groundTruthGroups.size(); i++)
+	{
+		CalculateOverlaps(groundTruthGroups[i], &segResIndex, candidatePairs.data() + candidateStart[i],
+							candidateAreas.data() + candidateStart[i], candidateStart[i+1] - candidateStart[i], results, &shard);
+	}
+	MergeOverlapShard(&shard, results);
+	results->BuildOverlapMatrices(); //Before the overlaps are accessed by several threads
+
 	IncreaseProgress(m_MaxPartialProgress * 0.3); //30%
 }
 
 /*
  * Prepare the overlap maps and other relevant stuff for regions/linse/words/glyphs.
+ *
+ * 'sharedIndex' - Prebuilt spatial index for the segmentation result objects (optional).
+ *                 If set, the caller is responsible for the isothetic conversion.
  */
-void CLayoutEvaluator::PrepareGroundTruthRegionsLinesWordsGlyphs(int layoutObjectType, CLayoutEvaluation * layoutEval, int nestedRegionsMode /*= NESTED_REGION_MODE_IGNORE*/)
+void CLayoutEvaluator::PrepareGroundTruthRegionsLinesWordsGlyphs(int layoutObjectType, CLayoutEvaluation * layoutEval, int nestedRegionsMode /*= NESTED_REGION_MODE_IGNORE*/,
+																CLayoutObjectIndex * sharedIndex /*= NULL*/)
 {
-	CEvaluationResults * results = layoutEval->GetResults(layoutObjectType, true);
+	CEvaluationResults * results = GetResults(layoutEval, layoutObjectType, true);
 	CLayoutObjectIterator * objectIterator = NULL;
 
 	//Convert to isothetic and remove loops
-	if (m_ConvertToIsothetic)
+	if (m_ConvertToIsothetic && sharedIndex == NULL)
 		ConvertToIsothetic(layoutObjectType, layoutEval);
 
-	//Build a bounding box search map for the segmentation result
-	CBoundingBoxMap * boundingBoxMap = NULL;
+	//Collect the ground truth and segmentation result objects
+	vector<CLayoutObject*> groundTruthObjects;
+	vector<CLayoutObject*> segResObjects;
 	// Regions
 	if (layoutObjectType == CLayoutObject::TYPE_LAYOUT_REGION)
 	{
-		vector<CLayoutObject*> segResRegions;
+		if (nestedRegionsMode == NESTED_REGION_MODE_PARENT_TO_PARENT || nestedRegionsMode == NESTED_REGION_MODE_PARENT_TO_NESTED)
+			GetParentRegions(layoutEval->GetGroundTruth(), &groundTruthObjects);
+		else //Nested only
+			GetNestedRegions(layoutEval->GetGroundTruth(), &groundTruthObjects);
+
 		if (nestedRegionsMode == NESTED_REGION_MODE_NESTED_TO_PARENT || nestedRegionsMode == NESTED_REGION_MODE_PARENT_TO_PARENT)
-			GetParentRegions(layoutEval->GetSegResult(), &segResRegions);
+			GetParentRegions(layoutEval->GetSegResult(), &segResObjects);
 		else //Nested only
-			GetNestedRegions(layoutEval->GetSegResult(), &segResRegions);
-		boundingBoxMap = new CBoundingBoxMap(&segResRegions);
+			GetNestedRegions(layoutEval->GetSegResult(), &segResObjects);
 	}
 	else //Lines, words, glyphs
 	{
-		objectIterator = GetLayoutObjectIterator(layoutEval->GetSegResult(), layoutObjectType);
-		boundingBoxMap = new CBoundingBoxMap(objectIterator);
-		delete objectIterator;
+		GetLayoutObjects(layoutEval->GetGroundTruth(), layoutObjectType, &groundTruthObjects);
+		GetLayoutObjects(layoutEval->GetSegResult(), layoutObjectType, &segResObjects);
 	}
+
+	//Build a spatial index for the segmentation result
+	CLayoutObjectIndex * segResIndex = sharedIndex;
+	if (segResIndex == NULL)
+		segResIndex = new CLayoutObjectIndex(&segResObjects);
 	IncreaseProgress(m_MaxPartialProgress * 0.05); //5%
 
-	//Now iterate over the ground truth regions and find the overlapping segmentation result regions
-	// Regions
-	if (layoutObjectType == CLayoutObject::TYPE_LAYOUT_REGION)
+	//Create the interval representations in advance (the workers below only read them)
+	for (unsigned int i=0; i<groundTruthObjects.size(); i++)
+		results->GetIntervalRepresentation(groundTruthObjects[i]->GetId(), true, true);
+	for (unsigned int i=0; i<segResObjects.size(); i++)
+		results->GetIntervalRepresentation(segResObjects[i]->GetId(), true, false);
+
+	//Find the overlap candidates (intersecting bounding boxes) and their overlap areas for all ground truth objects at once
+	vector<pair<int,int>> candidatePairs;
+	vector<int> candidateStart;
+	vector<long> candidateAreas;
+	FindOverlapCandidates(segResIndex, &groundTruthObjects, results, m_UseLabelRaster, &candidatePairs, &candidateStart, &candidateAreas);
+
+	//Now iterate over the ground truth objects and calculate the overlaps with the candidates.
+	//  The ground truth objects are split into chunks that are processed by the worker threads.
+	//  Each chunk has its own shard. The shards are merged in ground truth object order afterwards,
+	//  so the results are the same as for a single-threaded run.
+	int objectCount = (int)groundTruthObjects.size();
+	int chunkCount = (objectCount + OBJECT_CHUNK_SIZE - 1) / OBJECT_CHUNK_SIZE;
+	vector<COverlapShard> shards(chunkCount);
+
+	ParallelFor(chunkCount, [&](int chunk)
 	{
-		vector<CLayoutObject*> groundTruthObjects;
-		if (nestedRegionsMode == NESTED_REGION_MODE_PARENT_TO_PARENT || nestedRegionsMode == NESTED_REGION_MODE_PARENT_TO_NESTED)
-			GetParentRegions(layoutEval->GetGroundTruth(), &groundTruthObjects);
-		else //Nested only
-			GetNestedRegions(layoutEval->GetGroundTruth(), &groundTruthObjects);
+		int end = min((chunk + 1) * OBJECT_CHUNK_SIZE, objectCount);
+		for (int i = chunk * OBJECT_CHUNK_SIZE; i < end; i++)
+		{
+			CalculateOverlaps(groundTruthObjects[i], segResIndex, candidatePairs.data() + candidateStart[i],
+								candidateAreas.data() + candidateStart[i], candidateStart[i+1] - candidateStart[i], 
+								results, &shards[chunk]);
+		}
+	});
 
-		for (vector<CLayoutObject*>::iterator it = groundTruthObjects.begin(); it != groundTruthObjects.end(); it++)
-			CalculateOverlaps((*it), boundingBoxMap, results);
-	}
-	else //Lines, words, glyphs
-	{
-		objectIterator = GetLayoutObjectIterator(layoutEval->GetGroundTruth(), layoutObjectType);
-		while (objectIterator->HasNext())
-			CalculateOverlaps(objectIterator->Next(), boundingBoxMap, results);
-		delete objectIterator;
-	}
+	for (int i=0; i<chunkCount; i++)
+		MergeOverlapShard(&shards[i], results);
+	results->BuildOverlapMatrices(); //Before the overlaps are accessed by several threads
 
-	delete boundingBoxMap;
+	if (segResIndex != sharedIndex)
+		delete segResIndex;
 
 	IncreaseProgress(m_MaxPartialProgress * 0.3); //30%
 }
 
+/*
+ * Calculates the interval representations and pixel counts of all regions (including nested regions)
+ * of the given page layout and stores them in the given results object.
+ */
+void CLayoutEvaluator::PrepareSharedGeometry(CEvaluationResults * sharedGeometry, CPageLayout * pageLayout, bool isGroundTruth)
+{
+	CLayoutObjectIterator * objectIterator = GetLayoutObjectIterator(pageLayout, CLayoutObject::TYPE_LAYOUT_REGION, true); //Include nested
+	while (objectIterator->HasNext())
+	{
+		CLayoutObject * region = objectIterator->Next();
+		sharedGeometry->GetIntervalRepresentation(region->GetId(), true, isGroundTruth);
+		sharedGeometry->GetPixelCount(region->GetId(), isGroundTruth);
+	}
+	delete objectIterator;
+}
+
 /*
  * Convert to isothetic and remove loops
  */
@@ -489,17 +686,88 @@ void CLayoutEvaluator::ConvertToIsothetic(int layoutObjectType, CLayoutEvaluatio
 }
 
 
-void CLayoutEvaluator::CalculateOverlaps(CLayoutObject * groundTruthObject, CBoundingBoxMap * boundingBoxMap, CEvaluationResults * results)
+/*
+ * Finds the overlap candidates for the given ground truth objects using the spatial index of the segmentation result
+ * and calculates the overlap area of all candidate pairs in one sweep over the interval representations.
+ *
+ * 'candidatePairs' (out) - Pairs [ground truth object index, segmentation result index (see CLayoutObjectIndex::GetObject())]
+ * 'candidateStart' (out) - Position of the first candidate of each ground truth object within 'candidatePairs'
+ *                          (groundTruthObjects->size()+1 entries, the last one is the overall number of candidates)
+ * 'useLabelRaster' - Use the label raster engine instead of the sweep. This also stores the pixel counts of all objects.
+ * 'candidateAreas' (out) - Overlap area of each candidate pair (0 if only the bounding boxes intersect)
+ */
+void CLayoutEvaluator::FindOverlapCandidates(CLayoutObjectIndex * segResIndex, vector<CLayoutObject*> * groundTruthObjects,
+											 CEvaluationResults * results, bool useLabelRaster,
+											 vector<pair<int,int>> * candidatePairs, vector<int> * candidateStart,
+											 vector<long> * candidateAreas)
 {
-	//Get the overlap candidates by bounding box check
-	set<CLayoutObject*> * overlappingObjects = boundingBoxMap->GetOverlappingRegions(groundTruthObject);
+	segResIndex->FindCandidatePairs(groundTruthObjects, candidatePairs);
+
+	candidateStart->assign(groundTruthObjects->size() + 1, 0);
+	for (unsigned int i=0; i<candidatePairs->size(); i++)
+		candidateStart->at(candidatePairs->at(i).first + 1)++;
+	for (unsigned int i=1; i<candidateStart->size(); i++)
+		candidateStart->at(i) += candidateStart->at(i-1);
+
+	//Overlap areas
+	vector<CIntervalRepresentation*> groundTruthIntReps(groundTruthObjects->size(), NULL);
+	for (unsigned int i=0; i<groundTruthObjects->size(); i++)
+		if (useLabelRaster || candidateStart->at(i+1) > candidateStart->at(i))
+			groundTruthIntReps[i] = results->GetIntervalRepresentation(groundTruthObjects->at(i)->GetId(), true, true);
+
+	vector<CIntervalRepresentation*> segResIntReps(segResIndex->GetSize(), NULL);
+	if (useLabelRaster)
+	{
+		for (int i=0; i<segResIndex->GetSize(); i++)
+			segResIntReps[i] = results->GetIntervalRepresentation(segResIndex->GetObject(i)->GetId(), true, false);
+
+		//Label raster (all objects, for the pixel counts)
+		COpenCvBiLevelImage * image = results->GetLayoutEvaluation()->GetBilevelImage();
+		vector<long> groundTruthPixelCounts, segResPixelCounts;
+		CLabelRasterOverlap::CalculateOverlapAreas(&groundTruthIntReps, &segResIntReps, candidatePairs, candidateStart, image,
+													candidateAreas, &groundTruthPixelCounts, &segResPixelCounts);
+		if (image != NULL)
+		{
+			for (unsigned int i=0; i<groundTruthObjects->size(); i++)
+				results->AddPixelCount(groundTruthObjects->at(i)->GetId(), groundTruthPixelCounts[i], true);
+			for (int i=0; i<segResIndex->GetSize(); i++)
+				results->AddPixelCount(segResIndex->GetObject(i)->GetId(), segResPixelCounts[i], false);
+		}
+		return;
+	}
 
+	for (unsigned int i=0; i<candidatePairs->size(); i++)
+	{
+		int segIndex = candidatePairs->at(i).second;
+		if (segResIntReps[segIndex] == NULL)
+			segResIntReps[segIndex] = results->GetIntervalRepresentation(segResIndex->GetObject(segIndex)->GetId(), true, false);
+	}
+
+	CIntervalOverlapSweep::CalculateOverlapAreas(&groundTruthIntReps, &segResIntReps, candidatePairs, candidateStart, candidateAreas);
+}
+
+/*
+ * Calculates the overlaps of the given ground truth object with the segmentation result objects.
+ * The overlaps are stored in the given shard (see MergeOverlapShard()).
+ * Only reads from the results object (the interval representations have to exist already if called from several threads).
+ *
+ * 'candidates' - Overlap candidates (pairs [ground truth object index, segmentation result index], see FindOverlapCandidates())
+ * 'candidateAreas' - Overlap area for each candidate (from the overlap sweep, candidates without area are skipped)
+ */
+void CLayoutEvaluator::CalculateOverlaps(CLayoutObject * groundTruthObject, CLayoutObjectIndex * segResIndex, 
+										 pair<int,int> * candidates, long * candidateAreas, int candidateCount,
+										 CEvaluationResults * results, COverlapShard * shard)
+{
 	//Generate the interval representations
 	CIntervalRepresentation * intReprGT = NULL;
 	vector<CIntervalRepresentation *> intRepsForMultiOverlap;
-	for (set<CLayoutObject*>::iterator it = overlappingObjects->begin(); it != overlappingObjects->end(); it++)
+	for (int i=0; i<candidateCount; i++)
 	{
-		CLayoutObject * segObject = (*it);
+		//Only the bounding boxes intersect
+		if (candidateAreas[i] == 0)
+			continue;
+
+		CLayoutObject * segObject = segResIndex->GetObject(candidates[i].second);
 		CIntervalRepresentation * intReprSeg = NULL;
 
 		//Reading order group (use child regions)
@@ -534,23 +802,34 @@ void CLayoutEvaluator::CalculateOverlaps(CLayoutObject * groundTruthObject, CBou
 		//results->AddIntervalRepresentation(segRegion, intReprSeg, false); //CC 18.01.2013: is already done in GetIntervalRepresentation
 
 		//Compute the overlap
-		CLayoutObjectOverlap * overlap = new CLayoutObjectOverlap(intReprGT, intReprSeg);
+		CLayoutObjectOverlap * overlap = CEvaluationArena::New<CLayoutObjectOverlap>(intReprGT, intReprSeg);
 
 		if (overlap->IsOverlapping())
 		{
 			intRepsForMultiOverlap.push_back(intReprSeg);
-			results->AddLayoutObjectOverlap(groundTruthObject->GetId(), segObject->GetId(), overlap);
+			shard->AddLayoutObjectOverlap(groundTruthObject, segObject->GetId(), overlap);
 		}
 		else
-			delete overlap;
+			CEvaluationArena::Delete(overlap);
 	}
 	//Compute the multi overlap (ground truth region with all overlapping segmentation result regions)
 	if (intRepsForMultiOverlap.size() > 2) //(only if gt + 2 or more seg result regions)
 	{
-		CLayoutObjectOverlap * overlap = new CLayoutObjectOverlap(&intRepsForMultiOverlap);
-		results->AddMultiOverlapIntervalRep(groundTruthObject, overlap);
+		CLayoutObjectOverlap * overlap = CEvaluationArena::New<CLayoutObjectOverlap>(&intRepsForMultiOverlap);
+		shard->AddMultiOverlapIntervalRep(groundTruthObject, overlap);
 	}
-	delete overlappingObjects;
+}
+
+/*
+ * Transfers the overlaps of the given shard to the evaluation results (in the order they were added to the shard).
+ */
+void CLayoutEvaluator::MergeOverlapShard(COverlapShard * shard, CEvaluationResults * results)
+{
+	for (unsigned int i=0; i<shard->m_Overlaps.size(); i++)
+		results->AddLayoutObjectOverlap(shard->m_OverlapGroundTruthObjects[i]->GetId(), shard->m_OverlapSegResultObjects[i], shard->m_Overlaps[i]);
+	for (unsigned int i=0; i<shard->m_MultiOverlaps.size(); i++)
+		results->AddMultiOverlapIntervalRep(shard->m_MultiOverlapGroundTruthObjects[i], shard->m_MultiOverlaps[i]);
+	shard->Clear();
 }
 
 /*
@@ -566,51 +845,68 @@ void CLayoutEvaluator::FindErrors(int layoutObjectType, CLayoutEvaluation * layo
 	}
 
 	//Ground Truth (for merge, split, miss, part. miss and misclassification)
-	CEvaluationResults * results = layoutEval->GetResults(layoutObjectType);
-	CLayoutObject * groundTruthObject;
-	set<CUniString> * segResultObjects;
-	CLayoutObjectEvaluationResult * result;
+	CEvaluationResults * results = GetResults(layoutEval, layoutObjectType);
 	if (m_EvaluateRegions || m_EvaluateTextLines || m_EvaluateWords || m_EvaluateGlyphs || m_EvaluateReadingOrderGroups)
 	{
-		CLayoutObjectIterator * it = NULL;
+		//Collect the objects
+		vector<CLayoutObject*> groundTruthObjects;
+		vector<CLayoutObject*> segResObjects;
+		if (layoutObjectType == CLayoutObject::TYPE_LAYOUT_REGION)
+		{
+			if (nestedRegionsMode == NESTED_REGION_MODE_PARENT_TO_PARENT || nestedRegionsMode == NESTED_REGION_MODE_PARENT_TO_NESTED)
+				GetParentRegions(layoutEval->GetGroundTruth(), &groundTruthObjects);
+			else //Nested only
+				GetNestedRegions(layoutEval->GetGroundTruth(), &groundTruthObjects);
+
+			if (nestedRegionsMode == NESTED_REGION_MODE_PARENT_TO_PARENT || nestedRegionsMode == NESTED_REGION_MODE_NESTED_TO_PARENT)
+				GetParentRegions(layoutEval->GetSegResult(), &segResObjects);
+			else //Nested only
+				GetNestedRegions(layoutEval->GetSegResult(), &segResObjects);
+		}
+		else //Textlines, words, glyphs, reading order groups
+		{
+			GetLayoutObjects(layoutEval->GetGroundTruth(), layoutObjectType, &groundTruthObjects);
+			GetLayoutObjects(layoutEval->GetSegResult(), layoutObjectType, &segResObjects);
+		}
 
+		//Interval representations and pixel counts are calculated on demand.
+		//Do this in advance, so that the workers below only read from the results object.
+		for (unsigned int i=0; i<groundTruthObjects.size(); i++)
+			results->GetPixelCount(groundTruthObjects[i]->GetId(), true);
+		for (unsigned int i=0; i<segResObjects.size(); i++)
+			results->GetPixelCount(segResObjects[i]->GetId(), false);
+		//The same applies to the overlap rects, areas and pixel counts
+		results->PrepareOverlaps();
+
+		//The objects are processed in chunks by the worker threads. The object results of each chunk
+		//are created detached from the results object and added afterwards (in object order).
 		if (	m_EnableErrorChecks[CLayoutObjectEvaluationError::TYPE_MERGE]
 			||	m_EnableErrorChecks[CLayoutObjectEvaluationError::TYPE_SPLIT]
 			||	m_EnableErrorChecks[CLayoutObjectEvaluationError::TYPE_MISS]
 			||	m_EnableErrorChecks[CLayoutObjectEvaluationError::TYPE_PART_MISS]
 			||	m_EnableErrorChecks[CLayoutObjectEvaluationError::TYPE_MISCLASS])
 		{
-			//Regions
-			if (layoutObjectType == CLayoutObject::TYPE_LAYOUT_REGION)
-			{
-				vector<CLayoutObject*> groundTruthObjects;
-				if (nestedRegionsMode == NESTED_REGION_MODE_PARENT_TO_PARENT || nestedRegionsMode == NESTED_REGION_MODE_PARENT_TO_NESTED)
-					GetParentRegions(layoutEval->GetGroundTruth(), &groundTruthObjects);
-				else //Nested only
-					GetNestedRegions(layoutEval->GetGroundTruth(), &groundTruthObjects);
+			int objectCount = (int)groundTruthObjects.size();
+			int chunkCount = (objectCount + OBJECT_CHUNK_SIZE - 1) / OBJECT_CHUNK_SIZE;
+			vector<vector<CLayoutObjectEvaluationResult*>> shards(chunkCount);
 
-				for (vector<CLayoutObject*>::iterator it = groundTruthObjects.begin(); it != groundTruthObjects.end(); it++) 
-				{
-					groundTruthObject = (*it);
-					segResultObjects = results->GetGroundTruthOverlaps(groundTruthObject->GetId());
-					result = results->GetGroundTruthObjectResult(groundTruthObject->GetId(), true);
-
-					FindGroundTruthBasedErrorsForLayoutObject(layoutObjectType, results, result, groundTruthObject, segResultObjects);
-				}
-			}
-			else //Textlines, words, glyphs, reading order groups
+			ParallelFor(chunkCount, [&](int chunk)
 			{
-				it = GetLayoutObjectIterator(layoutEval->GetGroundTruth(), layoutObjectType);
-				while (it->HasNext())
+				int end = min((chunk + 1) * OBJECT_CHUNK_SIZE, objectCount);
+				for (int i = chunk * OBJECT_CHUNK_SIZE; i < end; i++)
 				{
-					groundTruthObject = it->Next();
-					segResultObjects = results->GetGroundTruthOverlaps(groundTruthObject->GetId());
-					result = results->GetGroundTruthObjectResult(groundTruthObject->GetId(), true);
+					CLayoutObject * groundTruthObject = groundTruthObjects[i];
+					COverlapRow * segResultObjects = results->GetGroundTruthOverlaps(groundTruthObject->GetId());
+					CLayoutObjectEvaluationResult * result = new CLayoutObjectEvaluationResult(NULL, groundTruthObject->GetId());
 
 					FindGroundTruthBasedErrorsForLayoutObject(layoutObjectType, results, result, groundTruthObject, segResultObjects);
+					shards[chunk].push_back(result);
 				}
-				delete it;
-			}
+			});
+
+			for (int i=0; i<chunkCount; i++)
+				for (unsigned int j=0; j<shards[i].size(); j++)
+					results->AddGroundTruthObjectResult(shards[i][j]);
 		}
 
 		//Extended allowable check (CC 13.06.2011)
@@ -628,47 +924,35 @@ void CLayoutEvaluator::FindErrors(int layoutObjectType, CLayoutEvaluation * layo
 		//Segmentation result (for false detection)
 		if (m_EnableErrorChecks[CLayoutObjectEvaluationError::TYPE_INVENT])
 		{
-			//Regions
-			CLayoutObject * segResultObject;
-			set<CUniString> * groundTruthObjects;
-			if (layoutObjectType == CLayoutObject::TYPE_LAYOUT_REGION)
-			{
-				vector<CLayoutObject*> segResRegions;
-				if (nestedRegionsMode == NESTED_REGION_MODE_PARENT_TO_PARENT || nestedRegionsMode == NESTED_REGION_MODE_NESTED_TO_PARENT)
-					GetParentRegions(layoutEval->GetSegResult(), &segResRegions);
-				else //Nested only
-					GetNestedRegions(layoutEval->GetSegResult(), &segResRegions);
-
-				for (vector<CLayoutObject*>::iterator it = segResRegions.begin(); it != segResRegions.end(); it++)
-				{
-					segResultObject = (*it);
-					groundTruthObjects = results->GetSegResultOverlaps(segResultObject->GetId());
-					result = results->GetSegResultObjectResult(segResultObject->GetId(), true);
+			int objectCount = (int)segResObjects.size();
+			int chunkCount = (objectCount + OBJECT_CHUNK_SIZE - 1) / OBJECT_CHUNK_SIZE;
+			vector<vector<CLayoutObjectEvaluationResult*>> shards(chunkCount);
 
-					//False detection
-					CheckInvented(layoutObjectType, results, result, segResultObject, groundTruthObjects);
-				}
-			}
-			else //Textlines, words, glyphs, reading order groups
+			ParallelFor(chunkCount, [&](int chunk)
 			{
-				it = GetLayoutObjectIterator(layoutEval->GetSegResult(), layoutObjectType);
-				while (it->HasNext())
+				int end = min((chunk + 1) * OBJECT_CHUNK_SIZE, objectCount);
+				for (int i = chunk * OBJECT_CHUNK_SIZE; i < end; i++)
 				{
-					segResultObject = it->Next();
-					groundTruthObjects = results->GetSegResultOverlaps(segResultObject->GetId());
-					result = results->GetSegResultObjectResult(segResultObject->GetId(), true);
+					CLayoutObject * segResultObject = segResObjects[i];
+					COverlapRow * groundTruthOverlaps = results->GetSegResultOverlaps(segResultObject->GetId());
+					CLayoutObjectEvaluationResult * result = new CLayoutObjectEvaluationResult(NULL, segResultObject->GetId());
 
 					//False detection
-					CheckInvented(layoutObjectType, results, result, segResultObject, groundTruthObjects);
+					CheckInvented(layoutObjectType, results, result, segResultObject, groundTruthOverlaps);
+					shards[chunk].push_back(result);
 				}
-				delete it;
-			}
+			});
+
+			for (int i=0; i<chunkCount; i++)
+				for (unsigned int j=0; j<shards[i].size(); j++)
+					results->AddSegResultObjectResult(shards[i][j]);
 		}
 	}
 	IncreaseProgress(m_MaxPartialProgress * 0.1); //10%
 
 	//Reading Order Tree
-	if (layoutObjectType == CLayoutObject::TYPE_LAYOUT_REGION && m_EvaluateReadingOrder) //only on block level
+	if (	layoutObjectType == CLayoutObject::TYPE_LAYOUT_REGION && m_EvaluateReadingOrder //only on block level
+		&&	nestedRegionsMode == NESTED_REGION_MODE_PARENT_TO_PARENT) //Only the parent-to-parent results are used for nested region evaluation
 	{
 		EvaluateReadingOrder(results, layoutEval);
 	}
@@ -676,7 +960,7 @@ void CLayoutEvaluator::FindErrors(int layoutObjectType, CLayoutEvaluation * layo
 }
 
 void CLayoutEvaluator::FindGroundTruthBasedErrorsForLayoutObject(int layoutObjectType, CEvaluationResults * results, CLayoutObjectEvaluationResult * result,
-																CLayoutObject * groundTruthObject, set<CUniString> * segResultObjects) {
+																CLayoutObject * groundTruthObject, COverlapRow * segResultObjects) {
 	if (m_EnableErrorChecks[CLayoutObjectEvaluationError::TYPE_MERGE])
 		CheckMerge(layoutObjectType, results, result, groundTruthObject, segResultObjects);
 	if (m_EnableErrorChecks[CLayoutObjectEvaluationError::TYPE_SPLIT])
@@ -691,7 +975,7 @@ void CLayoutEvaluator::FindGroundTruthBasedErrorsForLayoutObject(int layoutObjec
 
 void CLayoutEvaluator::FindBorderErrors(CLayoutEvaluation * layoutEval)
 {
-	CEvaluationResults * results = layoutEval->GetResults(CLayoutObject::TYPE_BORDER);
+	CEvaluationResults * results = GetResults(layoutEval, CLayoutObject::TYPE_BORDER);
 	CBorderEvaluationResults * borderResults = results->GetBorderResults(true);
 
 	//Borders (create maximal if not exists)
@@ -778,7 +1062,7 @@ void CLayoutEvaluator::FindBorderErrors(CLayoutEvaluation * layoutEval)
 void CLayoutEvaluator::CheckMerge(	int layoutObjectType, CEvaluationResults * results,
 								    CLayoutObjectEvaluationResult * result,
 									CLayoutObject * groundTruthObject, 
-									set<CUniString> * segResultObjects)
+									COverlapRow * segResultObjects)
 {
 	if (segResultObjects == NULL || segResultObjects->empty()) //No merge
 		return;
@@ -789,12 +1073,12 @@ void CLayoutEvaluator::CheckMerge(	int layoutObjectType, CEvaluationResults * re
 	//       overlaps another ground truth object other than the given one.
 
 	CEvaluationErrorMerge * err = new CEvaluationErrorMerge(groundTruthObject->GetId());
-	set<CUniString>::iterator it = segResultObjects->begin();
+	COverlapRow::iterator it = segResultObjects->begin();
 	CUniString segResultObjectId;
 	CLayoutObject * segResultObject;
 	CUniString groundTruthObject2Id;
 	CLayoutObject * groundTruthObject2;
-	set<CUniString> * mergedgroundTruthObjects;
+	COverlapRow * mergedgroundTruthObjects;
 	long area = 0L;
 	long pixelCount = 0L;
 	//Iterate over the given segmentation result objects
@@ -803,8 +1087,8 @@ void CLayoutEvaluator::CheckMerge(	int layoutObjectType, CEvaluationResults * re
 		segResultObjectId = (*it);
 		segResultObject = results->GetDocumentLayoutObject(segResultObjectId, false);;
 
-		CLayoutObjectOverlap * overlap1 = results->GetOverlapIntervalRep(groundTruthObject->GetId(), 
-																  segResultObjectId);
+		COverlapMatrixEntry * entry1 = it.GetEntry();
+		CLayoutObjectOverlap * overlap1 = entry1->m_Overlap;
 
 		COverlapRects * rects = new COverlapRects();
 		//Find the overlapping ground truth objects for the current segmentation result object
@@ -812,7 +1096,7 @@ void CLayoutEvaluator::CheckMerge(	int layoutObjectType, CEvaluationResults * re
 		if (mergedgroundTruthObjects != NULL && mergedgroundTruthObjects->size() > 1)
 		{
 			//Iterate over the ground truth objects, that overlap the current segmentation result object
-			set<CUniString>::iterator it2 = mergedgroundTruthObjects->begin();
+			COverlapRow::iterator it2 = mergedgroundTruthObjects->begin();
 			while (it2 != mergedgroundTruthObjects->end())
 			{
 				groundTruthObject2Id = (*it2);
@@ -820,29 +1104,29 @@ void CLayoutEvaluator::CheckMerge(	int layoutObjectType, CEvaluationResults * re
 				if (groundTruthObject != groundTruthObject2) //exclude the given ground truth object
 				{
 					//Get the interval representation of the overlap
-					CLayoutObjectOverlap * overlap2 = results->GetOverlapIntervalRep(groundTruthObject2Id, 
-																			  segResultObjectId);
+					COverlapMatrixEntry * entry2 = it2.GetEntry();
+					CLayoutObjectOverlap * overlap2 = entry2->m_Overlap;
 					if (overlap2 != NULL)
 					{
 						//Use the smaller of the two overlap areas
 						CLayoutObjectOverlap * overlap = NULL;
 						if (m_UsePixelArea)
 						{
-							//Pixel count
-							long count1 = results->GetLayoutEvaluation()->GetBilevelImage()->CountPixels(overlap1->GetOverlapRects());
-							long count2 = results->GetLayoutEvaluation()->GetBilevelImage()->CountPixels(overlap2->GetOverlapRects());
+							//Pixel count (counted when the overlap matrices were built)
+							long count1 = entry1->m_PixelCount >= 0L ? entry1->m_PixelCount : results->GetLayoutEvaluation()->CountPixels(overlap1->GetOverlapRects());
+							long count2 = entry2->m_PixelCount >= 0L ? entry2->m_PixelCount : results->GetLayoutEvaluation()->CountPixels(overlap2->GetOverlapRects());
 							if (count1 < count2)
 								overlap = overlap1;
 							else
 								overlap = overlap2;
 						}
-						else if (overlap1->GetOverlapArea() < overlap2->GetOverlapArea())
+						else if (entry1->m_Area < entry2->m_Area)
 							overlap = overlap1;
 						else
 							overlap = overlap2;
 
 						rects->AddOverlapRects(	groundTruthObject2->GetId(), overlap, m_UsePixelArea,
-												results->GetLayoutEvaluation()->GetBilevelImage());
+												results->GetLayoutEvaluation());
 						err->AddRects(overlap->GetOverlapRects());
 
 						err->SetAllowable(groundTruthObject2->GetId(), CheckIfMergeAllowable(results->GetLayoutEvaluation()->GetGroundTruth()->GetReadingOrder(), 
@@ -886,48 +1170,19 @@ void CLayoutEvaluator::CheckMerge(	int layoutObjectType, CEvaluationResults * re
  */
 bool CLayoutEvaluator::CheckFalseAlarm(CLayoutObjectEvaluationError * err)
 {
-	bool isError = false;
-	list<CRect*> * falseAlarm = err->GetFalseAlarmRects();
-	if (!falseAlarm->empty())
-	{
-		for (list<CRect*>::iterator it = falseAlarm->begin(); it != falseAlarm->end(); it++)
-			delete (*it);
-		falseAlarm->clear();
-	}
+	CCompactRectArray * falseAlarm = err->GetFalseAlarmRects();
+	falseAlarm->clear();
 
-	map<CRect*, long> realErrors;
-	list<CRect*> * origRects = err->GetRects();
+	CCompactRectArray realErrors;
+	CCompactRectArray * origRects = err->GetRects();
 	long pixels = SplitByPixelArea(origRects, falseAlarm, &realErrors);
+	bool isError = !realErrors.empty();
 	if (!falseAlarm->empty())
 	{
-		if (realErrors.size() == 0) //No error at all
-			isError = false;
-		else //There were real errors
-			isError = true;
-
-		//Clear the old rect list and insert the realError rects.
-		for (list<CRect*>::iterator it = origRects->begin(); it != origRects->end(); it++)
-			delete (*it);
-		origRects->clear();
-		
-		map<CRect*, long>::iterator it = realErrors.begin();
-		while (it != realErrors.end())
-		{
-			origRects->push_back((*it).first);
-			it++;
-		}
-	}
-	else //There was no false alarm -> leave everything as it is
-	{
-		isError = !realErrors.empty();
-		//Delete
-		map<CRect*, long>::iterator it = realErrors.begin();
-		while (it != realErrors.end())
-		{
-			delete (*it).first;
-			it++;
-		}
+		//Replace the old rect list by the realError rects.
+		*origRects = std::move(realErrors);
 	}
+	//else: There was no false alarm -> leave everything as it is
 	err->SetPixelCount(pixels);
 	err->SetFalseAlarm(!isError);
 	return isError;
@@ -939,7 +1194,7 @@ bool CLayoutEvaluator::CheckFalseAlarm(CLayoutObjectEvaluationError * err)
 void CLayoutEvaluator::CheckSplit(	int layoutObjectType, CEvaluationResults * results,
 								    CLayoutObjectEvaluationResult * result,
 									CLayoutObject * groundTruthObject, 
-									set<CUniString> * segResultObjects)
+									COverlapRow * segResultObjects)
 {
 	if (segResultObjects == NULL || segResultObjects->size() <= 1) //No split
 		return;
@@ -950,19 +1205,19 @@ void CLayoutEvaluator::CheckSplit(	int layoutObjectType, CEvaluationResults * re
 	err->SetCount((int)segResultObjects->size());
 
 	//Error area
-	set<CUniString>::iterator it = segResultObjects->begin();
+	COverlapRow::iterator it = segResultObjects->begin();
 	CLayoutObject * segResultObject, * segResultObject2;
 	CLayoutObjectOverlap * overlap;
 	bool allowable = true;
 	while (it != segResultObjects->end())
 	{
 		segResultObject = results->GetDocumentLayoutObject((*it), false);
-		overlap = results->GetOverlapIntervalRep(groundTruthObject->GetId(), segResultObject->GetId());
+		overlap = it.GetEntry()->m_Overlap;
 
 		if (overlap != NULL)
 		{
 			err->AddErrorRects(	segResultObject->GetId(), overlap, m_UsePixelArea, 
-								results->GetLayoutEvaluation()->GetBilevelImage());
+								results->GetLayoutEvaluation());
 
 			//Allowable?
 			if (allowable) //still allowable
@@ -975,7 +1230,7 @@ void CLayoutEvaluator::CheckSplit(	int layoutObjectType, CEvaluationResults * re
 						CTextRegionInfo * info = (CTextRegionInfo*)layoutReg->GetRegionInfo();
 						CUniString direction = GetReadingDirection(info);
 						double orientation = GetReadingOrientation(info);
-						set<CUniString>::iterator it2 = segResultObjects->begin();
+						COverlapRow::iterator it2 = segResultObjects->begin();
 						while (it2 != segResultObjects->end())
 						{
 							segResultObject2 = results->GetDocumentLayoutObject((*it2), false);
@@ -1020,7 +1275,7 @@ void CLayoutEvaluator::CheckSplit(	int layoutObjectType, CEvaluationResults * re
 void CLayoutEvaluator::CheckMiss(	int layoutObjectType, CEvaluationResults * results,
 								    CLayoutObjectEvaluationResult * result,
 									CLayoutObject * groundTruthObject, 
-									set<CUniString> * segResultObjects)
+									COverlapRow * segResultObjects)
 {
 	if (segResultObjects == NULL || segResultObjects->empty())
 	{
@@ -1045,7 +1300,7 @@ void CLayoutEvaluator::CheckMiss(	int layoutObjectType, CEvaluationResults * res
 void CLayoutEvaluator::CheckPartMiss(	int layoutObjectType, CEvaluationResults * results,
 										CLayoutObjectEvaluationResult * result,
 										CLayoutObject * groundTruthObject, 
-										set<CUniString> * segResultObjects)
+										COverlapRow * segResultObjects)
 {
 	if (segResultObjects == NULL || segResultObjects->empty()) //No partly miss
 		return;
@@ -1054,8 +1309,7 @@ void CLayoutEvaluator::CheckPartMiss(	int layoutObjectType, CEvaluationResults *
 
 	if (segResultObjects->size() == 1) //only one region overlaps -> look in the single overlap map
 	{
-		CLayoutObject * segResultObject = results->GetDocumentLayoutObject((*segResultObjects->begin()), false);
-		overlap = results->GetOverlapIntervalRep(groundTruthObject->GetId(), segResultObject->GetId());
+		overlap = segResultObjects->GetEntry(0)->m_Overlap;
 	}
 	else //more than one region overlap -> look in the multi overlap map
 	{
@@ -1107,7 +1361,7 @@ void CLayoutEvaluator::CheckPartMiss(	int layoutObjectType, CEvaluationResults *
 void CLayoutEvaluator::CheckMisclass(int layoutObjectType, CEvaluationResults * results,
 	CLayoutObjectEvaluationResult * result,
 	CLayoutObject * groundTruthObject,
-	set<CUniString> * segResultObjects)
+	COverlapRow * segResultObjects)
 {
 	if (segResultObjects == NULL || segResultObjects->empty()) //No misclassification
 		return;
@@ -1124,11 +1378,11 @@ void CLayoutEvaluator::CheckMisclass(int layoutObjectType, CEvaluationResults *
 void CLayoutEvaluator::CheckMisclassForRegion(CEvaluationResults * results,
 										CLayoutObjectEvaluationResult * result,
 										CLayoutObject * groundTruthObject, 
-										set<CUniString> * segResultObjects)
+										COverlapRow * segResultObjects)
 {
 	CEvaluationErrorMisclass * err = new CEvaluationErrorMisclass(groundTruthObject->GetId());
 
-	set<CUniString>::iterator it = segResultObjects->begin();
+	COverlapRow::iterator it = segResultObjects->begin();
 	CLayoutRegion * segResultLayoutRegion;
 	CLayoutRegion * groundTruthLayoutRegion = (CLayoutRegion*)groundTruthObject;
 	CLayoutObjectOverlap * overlap;
@@ -1139,23 +1393,34 @@ void CLayoutEvaluator::CheckMisclassForRegion(CEvaluationResults * results,
 		//Compare region type
 		bool misclass = segResultLayoutRegion->GetType() != groundTruthLayoutRegion->GetType();
 
-		//Subtype?
+		//Subtype? (interned subtypes can be compared directly)
 		if (!misclass)
 		{
-			CUniString gtSubType = CLayoutEvaluation::GetLayoutRegionSubtype(groundTruthLayoutRegion, m_Profile);
-			CUniString segResultSubType = CLayoutEvaluation::GetLayoutRegionSubtype(segResultLayoutRegion, m_Profile);
-			if (!gtSubType.IsEmpty())
-				misclass = gtSubType != segResultSubType;
+			int gtSubType = results->GetSubtypeIndex(groundTruthLayoutRegion, true);
+			int segResultSubType = results->GetSubtypeIndex(segResultLayoutRegion, false);
+			if (	gtSubType != CLayoutObjectIdTable::SUBTYPE_UNRESOLVED 
+				&&	segResultSubType != CLayoutObjectIdTable::SUBTYPE_UNRESOLVED)
+			{
+				if (gtSubType != CLayoutObjectIdTable::SUBTYPE_NONE)
+					misclass = gtSubType != segResultSubType;
+			}
+			else //Not in the index tables
+			{
+				CUniString gtSubTypeName = CLayoutEvaluation::GetLayoutRegionSubtype(groundTruthLayoutRegion, m_Profile);
+				CUniString segResultSubTypeName = CLayoutEvaluation::GetLayoutRegionSubtype(segResultLayoutRegion, m_Profile);
+				if (!gtSubTypeName.IsEmpty())
+					misclass = gtSubTypeName != segResultSubTypeName;
+			}
 		}
 
 		if (misclass && !CheckIfMisclassCanBeIgnored(groundTruthLayoutRegion, segResultLayoutRegion->GetType()))
 		{
-			overlap = results->GetOverlapIntervalRep(groundTruthObject->GetId(), segResultLayoutRegion->GetId());
+			overlap = it.GetEntry()->m_Overlap;
 			if (overlap != NULL)
 			{
 				err->AddErrorRects(	segResultLayoutRegion->GetId(), overlap,
 									m_UsePixelArea, 
-									results->GetLayoutEvaluation()->GetBilevelImage());
+									results->GetLayoutEvaluation());
 				overallArea += overlap->GetOverlapArea();
 			}
 			else
@@ -1186,11 +1451,11 @@ void CLayoutEvaluator::CheckMisclassForRegion(CEvaluationResults * results,
 void CLayoutEvaluator::CheckMisclassForReadingOrderGroup(CEvaluationResults * results,
 										CLayoutObjectEvaluationResult * result,
 										CLayoutObject * groundTruthObject, 
-										set<CUniString> * segResultObjects)
+										COverlapRow * segResultObjects)
 {
 	CEvaluationErrorMisclass * err = new CEvaluationErrorMisclass(groundTruthObject->GetId());
 
-	set<CUniString>::iterator it = segResultObjects->begin();
+	COverlapRow::iterator it = segResultObjects->begin();
 	CReadingOrderGroup * segResultGroup;
 	CReadingOrderGroup * groundTruthGroup = (CReadingOrderGroup*)groundTruthObject;
 	CLayoutObjectOverlap * overlap;
@@ -1203,12 +1468,12 @@ void CLayoutEvaluator::CheckMisclassForReadingOrderGroup(CEvaluationResults * re
 
 		if (misclass)
 		{
-			overlap = results->GetOverlapIntervalRep(groundTruthObject->GetId(), segResultGroup->GetId());
+			overlap = it.GetEntry()->m_Overlap;
 			if (overlap != NULL)
 			{
 				err->AddErrorRects(segResultGroup->GetId(), overlap,
 									m_UsePixelArea, 
-									results->GetLayoutEvaluation()->GetBilevelImage());
+									results->GetLayoutEvaluation());
 				overallArea += overlap->GetOverlapArea();
 			}
 			else
@@ -1278,7 +1543,7 @@ bool CLayoutEvaluator::CheckIfMisclassCanBeIgnored(CLayoutRegion * groundTruthOb
 void CLayoutEvaluator::CheckInvented(	int layoutObjectType, CEvaluationResults * results,
 										CLayoutObjectEvaluationResult * result,
 										CLayoutObject * segResultObject, 
-										set<CUniString> * groundTruthObjects)
+										COverlapRow * groundTruthObjects)
 {
 	if (groundTruthObjects == NULL || groundTruthObjects->empty())
 	{
@@ -1302,28 +1567,24 @@ void CLayoutEvaluator::CheckInvented(	int layoutObjectType, CEvaluationResults *
  * in the bi-level image.
  * 'input' - the original list
  * 'falseAlarm' - rectangles without black pixels
- * 'realErrors' - map of rectangles with black pixels and the number of the pixels
- *   NOTE: Creates new rects for falseAlarm and realErrors, so they have to be deleted later!
+ * 'realErrors' - rectangles with black pixels (in input order)
  * Returns the overall number of black pixels
  */
-long CLayoutEvaluator::SplitByPixelArea(list<CRect*> * input, 
-										list<CRect*> * falseAlarm, 
-										map<CRect*, long> * realErrors)
+long CLayoutEvaluator::SplitByPixelArea(CCompactRectArray * input, 
+										CCompactRectArray * falseAlarm, 
+										CCompactRectArray * realErrors)
 {
-	CRect * rect;
-	COpenCvBiLevelImage * image = m_Image;
 	long count, overall = 0;
-	for (list<CRect*>::iterator it = input->begin(); it != input->end(); it++)
+	for (CCompactRect * rect = input->begin(); rect != input->end(); rect++)
 	{
-		rect = (*it);
-		count = image->CountPixels(rect);
+		count = m_LayoutEvaluation->CountPixels(rect->left, rect->top, rect->right, rect->bottom);
 		if (count > 0)
 		{
 			overall += count;
-			realErrors->insert(pair<CRect*, long>(new CRect(rect), count));
+			realErrors->push_back(*rect);
 		}
 		else
-			falseAlarm->push_back(new CRect(rect));
+			falseAlarm->push_back(*rect);
 	}
 	return overall;
 }
@@ -1348,6 +1609,17 @@ CLayoutObjectIterator *	CLayoutEvaluator::GetLayoutObjectIterator(CPageLayout *
 	return CLayoutObjectIterator::GetLayoutObjectIterator(pageLayout, layoutObjectType, includeNested);
 }
 
+/*
+ * Adds all layout objects of the given type to the target list (same objects as returned by GetLayoutObjectIterator(pageLayout, layoutObjectType)).
+ */
+void CLayoutEvaluator::GetLayoutObjects(CPageLayout * pageLayout, int layoutObjectType, vector<CLayoutObject*> * targetList)
+{
+	CLayoutObjectIterator * objectIterator = GetLayoutObjectIterator(pageLayout, layoutObjectType);
+	while (objectIterator->HasNext())
+		targetList->push_back(objectIterator->Next());
+	delete objectIterator;
+}
+
 /*
  * Adds all top-level regions to the specified list (and ignores nested regions)
  */
@@ -1382,12 +1654,18 @@ void CLayoutEvaluator::GetNestedRegions(CPageLayout * pageLayout, vector<CLayout
 }
 
 
-//TODO make thread safe if using threads
+/*
+ * Adds the given amount to the overall progress (all levels).
+ * Can be called from several worker threads.
+ */
 void CLayoutEvaluator::IncreaseProgress(double amount)
 {
+	CSingleLock lock(&m_CriticalSect);
+	lock.Lock();
 	m_Progress += amount;
 	if (m_ProgressMonitor != NULL)
 		m_ProgressMonitor->SetProgress((int)m_Progress);
+	lock.Unlock();
 }
 
 /*
@@ -1405,145 +1683,166 @@ void CLayoutEvaluator::EvaluateReadingOrder(CEvaluationResults * results, CLayou
 	CReadingOrder * groundTruthReadingOrder = groundTruth->GetReadingOrder();
 	CReadingOrderEvaluationResult * result = results->GetReadingOrderResults();
 
-	CLayoutObjectIterator * regionIterator1 = GetLayoutObjectIterator(segResult, CLayoutObject::TYPE_LAYOUT_REGION);
-
-	//Check all region pairs of the segmentation result
-	set<int> relation;
-	while (regionIterator1->HasNext())
+	//Collect the text regions of the segmentation result
+	vector<CLayoutRegion*> segResultTextRegions;
+	CLayoutObjectIterator * regionIterator = GetLayoutObjectIterator(segResult, CLayoutObject::TYPE_LAYOUT_REGION);
+	while (regionIterator->HasNext())
 	{
-		CLayoutRegion * reg1 = (CLayoutRegion*)regionIterator1->Next();
-
-		//Text region only!
-		if (reg1->GetType() != CLayoutRegion::TYPE_TEXT)
-			continue;
+		CLayoutRegion * reg = (CLayoutRegion*)regionIterator->Next();
+		if (reg->GetType() == CLayoutRegion::TYPE_TEXT) //Text region only!
+			segResultTextRegions.push_back(reg);
+	}
+	delete regionIterator;
 
-		CLayoutObjectIterator * regionIterator2 = GetLayoutObjectIterator(segResult, CLayoutObject::TYPE_LAYOUT_REGION);
-		while (regionIterator2->HasNext())
+	//Overlap weights (once per overlapping pair of segmentation result text region and ground truth region)
+	vector<vector<CReadingOrderOverlapWeight>> overlapWeights(segResultTextRegions.size());
+	for (unsigned int i=0; i<segResultTextRegions.size(); i++)
+		CalculateReadingOrderOverlapWeights(results, layoutEval, segResultTextRegions[i], &overlapWeights[i]);
+
+	//Split the region pairs
+	//  The penalty of a pair is the weighted sum over the relations of the overlapping ground truth region pairs.
+	//  If one of the two regions does not overlap any ground truth region, there are no fuzzy relations and
+	//  the penalty is 0 regardless of the segmentation result relation (RELATION_NOT_DEFINED or other).
+	//  Such pairs never produce an error, so only pairs of regions with overlaps are evaluated.
+	vector<int> overlappingRegions;
+	for (unsigned int i=0; i<segResultTextRegions.size(); i++)
+		if (!overlapWeights[i].empty())
+			overlappingRegions.push_back(i);
+
+	//Check the remaining region pairs of the segmentation result
+	//  The pairs are independent. Blocks of rows (first region) are processed by the worker threads.
+	//  Each block collects its errors separately. The blocks are added to the results in order afterwards,
+	//  so the errors are in the same order as for a single-threaded run.
+	int rowCount = (int)overlappingRegions.size();
+	int blockCount = (rowCount + READING_ORDER_BLOCK_SIZE - 1) / READING_ORDER_BLOCK_SIZE;
+	vector<vector<CReadingOrderError*>> blockErrors(blockCount);
+
+	ParallelFor(blockCount, [&](int block)
+	{
+		unsigned int relation;	//Relation set as bitmask (see CReadingOrderRelationMatrix)
+		int end = min((block + 1) * READING_ORDER_BLOCK_SIZE, rowCount);
+		for (int k = block * READING_ORDER_BLOCK_SIZE; k < end; k++)
 		{
-			CLayoutRegion * reg2 = (CLayoutRegion*)regionIterator2->Next();
-			//Text region only and not the same region as above!
-			if (reg2->GetType() != CLayoutRegion::TYPE_TEXT
-				|| reg1 == reg2 
-				|| reg1 < reg2)	//To avoid double results (r1->r2  r2<-r1)
-				continue;
-				
-			//Calculate the relation between reg1 and reg2 using the reading order of the seg result
-			if (segResultReadingOrder != NULL)
-				relation = segResultReadingOrder->CalculateRelation(reg1->GetId(), reg2->GetId());
-			else //Not defined
-			{
-				relation = set<int>();
-				relation.insert(CReadingOrder::RELATION_NOT_DEFINED);
-			}
+			int i = overlappingRegions[k];
+			CLayoutRegion * reg1 = segResultTextRegions[i];
 
-			//Find the overlapping ground-truth regions and calculate the relations
-			vector<CFuzzyReadingOrderRelation> fuzzyRelations;
-			set<CUniString> * overlaps1 = results->GetSegResultOverlaps(reg1->GetId());
-			set<CUniString> * overlaps2 = results->GetSegResultOverlaps(reg2->GetId());
-
-			if (overlaps1 != NULL && overlaps2 != NULL && !overlaps1->empty() && !overlaps2->empty())
+			for (unsigned int l=0; l<overlappingRegions.size(); l++)
 			{
-				set<CUniString>::iterator it1 = overlaps1->begin();
-				while (it1 != overlaps1->end())
+				int j = overlappingRegions[l];
+				CLayoutRegion * reg2 = segResultTextRegions[j];
+				//Not the same region as above!
+				if (	reg1 == reg2 
+					||	reg1 < reg2)	//To avoid double results (r1->r2  r2<-r1)
+					continue;
+				
+				//Calculate the relation between reg1 and reg2 using the reading order of the seg result
+				if (m_SegResultRelations != NULL)
+					relation = m_SegResultRelations->GetRelation(reg1->GetId(), reg2->GetId());
+				else if (segResultReadingOrder != NULL)
+					relation = CReadingOrderRelationMatrix::ToMask(segResultReadingOrder->CalculateRelation(reg1->GetId(), reg2->GetId()));
+				else //Not defined
+					relation = CReadingOrderRelationMatrix::ToMask(CReadingOrder::RELATION_NOT_DEFINED);
+
+				//Calculate the relations of the overlapping ground-truth regions
+				vector<CFuzzyReadingOrderRelation> fuzzyRelations;
+				vector<CReadingOrderOverlapWeight> & weights1 = overlapWeights[i];
+				vector<CReadingOrderOverlapWeight> & weights2 = overlapWeights[j];
+				for (unsigned int k1=0; k1<weights1.size(); k1++)
 				{
-					CLayoutObject * groundTruthReg1 = results->GetDocumentLayoutObject((*it1), true);
-					set<CUniString>::iterator it2 = overlaps2->begin();
-					while (it2 != overlaps2->end())
+					CReadingOrderOverlapWeight & w1 = weights1[k1];
+					for (unsigned int k2=0; k2<weights2.size(); k2++)
 					{
-						CLayoutObject * groundTruthReg2 = results->GetDocumentLayoutObject((*it2), true);
+						CReadingOrderOverlapWeight & w2 = weights2[k2];
 
 						//Calculate the relation using the reading order of the ground-truth
-						set<int> rel;
-						if (groundTruthReadingOrder != NULL)
-						{
-							rel = groundTruthReadingOrder->CalculateRelation(groundTruthReg1->GetId(), groundTruthReg2->GetId());
-						}
-						else //Not defined
+						unsigned int rel;
+						if (m_GroundTruthRelations != NULL)
 						{
-							rel.insert(CReadingOrder::RELATION_NOT_DEFINED);
+							if (w1.m_GroundTruthIndex >= 0 && w2.m_GroundTruthIndex >= 0)
+								rel = m_GroundTruthRelations->GetRelation(w1.m_GroundTruthIndex, w2.m_GroundTruthIndex);
+							else
+								rel = m_GroundTruthRelations->GetRelation(w1.m_GroundTruthRegion->GetId(), w2.m_GroundTruthRegion->GetId());
 						}
-
-						//Calculate the weight for the relation (based on overlap)
-						double weight = 0.0, weightSeg1, weightSeg2, weightGt1, weightGt2;
-						if (m_UsePixelArea) //We are counting pixels
+						else if (groundTruthReadingOrder != NULL)
 						{
-							//Seg Reg1
-							double pixelCountReg1 = (double)results->GetPixelCount(reg1->GetId(), false);
-							CLayoutObjectOverlap * overlap = results->GetOverlapIntervalRep(groundTruthReg1->GetId(), reg1->GetId());
-
-							COverlapRects rects1;
-							rects1.AddOverlapRects(groundTruthReg1->GetId(), overlap, true, layoutEval->GetBilevelImage());
-							
-							double overlapPixels1 = overlap != NULL ? (double)rects1.GetPixelCount() : 0.0;
-							weightSeg1 = overlapPixels1 / pixelCountReg1;
-
-							//Seg Reg2
-							double pixelCountReg2 = (double)results->GetPixelCount(reg2->GetId(), false);
-							overlap = results->GetOverlapIntervalRep(groundTruthReg2->GetId(), reg2->GetId());
-
-							COverlapRects rects2;
-							rects2.AddOverlapRects(groundTruthReg2->GetId(), overlap, true, layoutEval->GetBilevelImage());
-							
-							double overlapPixels2 = overlap != NULL ? (double)rects2.GetPixelCount() : 0.0;
-							weightSeg2 = overlapPixels2 / pixelCountReg2;
-
-							//Gt Reg1
-							double pixelCountGtReg1 = (double)results->GetPixelCount(groundTruthReg1->GetId(), true);
-							weightGt1 = overlapPixels1 / pixelCountGtReg1;
-
-							//Gt Reg2
-							double pixelCountGtReg2 = (double)results->GetPixelCount(groundTruthReg2->GetId(), true);
-							weightGt2 = overlapPixels2 / pixelCountGtReg2;
+							rel = CReadingOrderRelationMatrix::ToMask(groundTruthReadingOrder->CalculateRelation(w1.m_GroundTruthRegion->GetId(), w2.m_GroundTruthRegion->GetId()));
 						}
-						else //Not using pixel area (using region area)
+						else //Not defined
 						{
-							//Reg1
-							double areaReg1 = results->GetRegionArea(reg1->GetId(), false);
-							CLayoutObjectOverlap * overlap = results->GetOverlapIntervalRep(groundTruthReg1->GetId(), reg1->GetId());
-
-							COverlapRects rects1;
-							rects1.AddOverlapRects(groundTruthReg1->GetId(), overlap, false, layoutEval->GetBilevelImage());
-							
-							double overlapArea1 = overlap != NULL ? (double)rects1.GetArea() : 0.0;
-							weightSeg1 = overlapArea1 / areaReg1;
-
-							//Reg2
-							double areaReg2 = (double)results->GetRegionArea(reg2->GetId(), false);
-							overlap = results->GetOverlapIntervalRep(groundTruthReg2->GetId(), reg2->GetId());
-
-							COverlapRects rects2;
-							rects2.AddOverlapRects(groundTruthReg2->GetId(), overlap, false, layoutEval->GetBilevelImage());
-							
-							double overlapArea2 = overlap != NULL ? (double)rects2.GetArea() : 0.0;
-							weightSeg2 = overlapArea2 / areaReg2;
-
-							//Gt Reg1
-							double areaGtReg1 = (double)results->GetRegionArea(groundTruthReg1->GetId(), true);
-							weightGt1 = overlapArea1 / areaGtReg1;
-
-							//Gt Reg2
-							double areaGtReg2 = (double)results->GetRegionArea(groundTruthReg2->GetId(), true);
-							weightGt2 = overlapArea2 / areaGtReg2;
+							rel = CReadingOrderRelationMatrix::ToMask(CReadingOrder::RELATION_NOT_DEFINED);
 						}
-						weight = (weightSeg1 + weightSeg2) / 2 * ((weightGt1 + weightGt2) / 2.0);
+
+						//Weight for the relation (based on overlap)
+						double weight = (w1.m_WeightSeg + w2.m_WeightSeg) / 2 * ((w1.m_WeightGt + w2.m_WeightGt) / 2.0);
 						//weight = (weightSeg1 + weightSeg2 + weightGt1 + weightGt2) / 4.0;
 						//weight = weightSeg1 * weightSeg2 * weightGt1 * weightGt2;					//CC didn't work well
 
 						//Save
-						fuzzyRelations.push_back(CFuzzyReadingOrderRelation(weight, groundTruthReg1->GetId(), groundTruthReg2->GetId(), rel));
-
-						it2++;
+						fuzzyRelations.push_back(CFuzzyReadingOrderRelation(weight, w1.m_GroundTruthRegion->GetId(), w2.m_GroundTruthRegion->GetId(), rel));
 					}
-					it1++;
 				}
+
+				CReadingOrderError * error = new CReadingOrderError(reg1->GetId(), reg2->GetId(), relation, fuzzyRelations, m_Profile);
+				if (error->HasPenalty())
+					blockErrors[block].push_back(error);
+				else
+					delete error;
 			}
+		}
+	});
 
-			CReadingOrderError * error = new CReadingOrderError(reg1->GetId(), reg2->GetId(), relation, fuzzyRelations, m_Profile);
-			if (error->HasPenalty())
-				result->AddError(error);
-			else
-				delete error;
+	for (int block=0; block<blockCount; block++)
+		for (unsigned int i=0; i<blockErrors[block].size(); i++)
+			result->AddError(blockErrors[block][i]);
+}
+
+/*
+ * Calculates the overlap weights of the given segmentation result region with all overlapping ground truth regions
+ * (in the order of CEvaluationResults::GetSegResultOverlaps()).
+ * The weights are the overlap area (or overlap pixel count) relative to the area (or pixel count) of each of the two regions.
+ */
+void CLayoutEvaluator::CalculateReadingOrderOverlapWeights(CEvaluationResults * results, CLayoutEvaluation * layoutEval,
+														   CLayoutObject * segResultRegion, vector<CReadingOrderOverlapWeight> * weights)
+{
+	COverlapRow * overlaps = results->GetSegResultOverlaps(segResultRegion->GetId());
+	if (overlaps == NULL || overlaps->empty())
+		return;
+
+	//Segmentation result region
+	double segResultAmount;
+	if (m_UsePixelArea) //We are counting pixels
+		segResultAmount = (double)results->GetPixelCount(segResultRegion->GetId(), false);
+	else //Not using pixel area (using region area)
+		segResultAmount = (double)results->GetRegionArea(segResultRegion->GetId(), false);
+
+	for (COverlapRow::iterator it = overlaps->begin(); it != overlaps->end(); it++)
+	{
+		CLayoutObject * groundTruthRegion = results->GetDocumentLayoutObject((*it), true);
+		COverlapMatrixEntry * entry = it.GetEntry();
+		CLayoutObjectOverlap * overlap = entry->m_Overlap;
+
+		double overlapAmount = 0.0, groundTruthAmount;
+		if (m_UsePixelArea) //We are counting pixels
+		{
+			if (entry->m_PixelCount >= 0L)
+				overlapAmount = (double)entry->m_PixelCount;
+			else if (overlap != NULL && layoutEval->GetBilevelImage() != NULL)
+				overlapAmount = (double)layoutEval->CountPixels(overlap->GetOverlapRects());
+			groundTruthAmount = (double)results->GetPixelCount(groundTruthRegion->GetId(), true);
 		}
+		else //Not using pixel area (using region area)
+		{
+			if (overlap != NULL)
+				overlapAmount = (double)overlap->GetOverlapArea();
+			groundTruthAmount = (double)results->GetRegionArea(groundTruthRegion->GetId(), true);
+		}
+
+		CReadingOrderOverlapWeight weight;
+		weight.m_GroundTruthRegion = groundTruthRegion;
+		weight.m_GroundTruthIndex = m_GroundTruthRelations != NULL ? m_GroundTruthRelations->GetIndex(groundTruthRegion->GetId()) : -1;
+		weight.m_WeightSeg = overlapAmount / segResultAmount;
+		weight.m_WeightGt = overlapAmount / groundTruthAmount;
+		weights->push_back(weight);
 	}
 }
 
@@ -1601,8 +1900,24 @@ bool CLayoutEvaluator::CheckIfMergeAllowable(CReadingOrder * readingOrder,
 		//Check reading order (if defined)
 		if (readingOrder != NULL && readingOrder->GetRoot() != NULL && readingOrder->GetRoot()->GetSize() > 0)
 		{
-			if (readingOrder->ContainsRegionRef(object1->GetId())
-				&& readingOrder->ContainsRegionRef(object2->GetId())) //Both regions in reading order
+			//Precalculated relations available?
+			CReadingOrderRelationMatrix * relations = NULL;
+			if (m_GroundTruthRelations != NULL && m_GroundTruthRelations->GetReadingOrder() == readingOrder)
+				relations = m_GroundTruthRelations;
+			else if (m_SegResultRelations != NULL && m_SegResultRelations->GetReadingOrder() == readingOrder)
+				relations = m_SegResultRelations;
+
+			if (relations != NULL && relations->Contains(object1->GetId()) && relations->Contains(object2->GetId()))
+			{
+				unsigned int rel = relations->GetRelation(object1->GetId(), object2->GetId());
+				hasRelationPredecessor = CReadingOrderRelationMatrix::HasRelation(rel, CReadingOrder::RELATION_PREDECESSOR);	//'->'
+				hasRelationSuccessor = CReadingOrderRelationMatrix::HasRelation(rel, CReadingOrder::RELATION_SUCCESSOR);		//'<-'
+				if (!hasRelationPredecessor && !hasRelationSuccessor) //No '->' or '<-' relation
+					allowable = false;
+			}
+			else if (relations == NULL 
+				&& ContainsRegionRef(readingOrder, object1->GetId())
+				&& ContainsRegionRef(readingOrder, object2->GetId())) //Both regions in reading order
 			{
 				//Calculate the relation of the two regions
 				set<int> rel = readingOrder->CalculateRelation(object1->GetId(), object2->GetId());
@@ -1662,37 +1977,16 @@ bool CLayoutEvaluator::CheckIfMergeAllowable(CReadingOrder * readingOrder,
 			{
 				//The reading orienation is an angle -180 to 180 rotating clockwise.
 				//So we have to ratate anti clockwise to rerotate it.
-				CPointList * clone1 = object1->GetCoords()->Clone();
-				CPointList * clone2 = object2->GetCoords()->Clone();
-				CPointList * points;
-				int x, y, xRot, yRot;
-				double rad = orientation * M_PI / 180.0;
-				for (int i=0; i<2; i++)
-				{
-					points = i==0 ? clone1 : clone2;
-					CPolygonPoint * p = points->GetHeadPoint();
-					while (p!=NULL)
-					{
-						x = p->GetX();
-						y = -p->GetY();		//The coordinate system is flipped
-						//Rotate
-						xRot =  (int)(x*cos(rad) - y*sin(rad));
-						yRot = -(int)(x*sin(rad) + y*cos(rad));
-						p->SetXY(xRot, yRot);
-						p = p->GetNextPoint();
-					}
-				}
-				left1	= clone1->GetBBX1();
-				right1	= clone1->GetBBX2();
-				top1	= clone1->GetBBY1();
-				bottom1 = clone1->GetBBY2();
-				left2	= clone2->GetBBX1();
-				right2	= clone2->GetBBX2();
-				top2	= clone2->GetBBY1();
-				bottom2 = clone2->GetBBY2();
-
-				delete clone1;
-				delete clone2;
+				CRect box1 = GetRotatedBoundingBox(object1, orientation);
+				CRect box2 = GetRotatedBoundingBox(object2, orientation);
+				left1	= box1.left;
+				right1	= box1.right;
+				top1	= box1.top;
+				bottom1 = box1.bottom;
+				left2	= box2.left;
+				right2	= box2.right;
+				top2	= box2.top;
+				bottom2 = box2.bottom;
 			}
 
 			CUniString direction = useReadingdirectionAndOrientation
@@ -1748,6 +2042,70 @@ bool CLayoutEvaluator::CheckIfMergeAllowable(CReadingOrder * readingOrder,
 	return allowable;
 }
 
+/*
+ * Returns the bounding box of the given object after rerotating it by the reading orientation
+ * (uses the precalculated boxes if available).
+ */
+CRect CLayoutEvaluator::GetRotatedBoundingBox(CLayoutObject * object, double orientation)
+{
+	if (m_RotatedBoundingBoxes != NULL)
+	{
+		CRect * box = m_RotatedBoundingBoxes->Get(object, orientation);
+		if (box != NULL)
+			return *box;
+	}
+	return CRotatedBoundingBoxCache::CalculateBoundingBox(object->GetCoords(), orientation);
+}
+
+/*
+ * Precalculates the rotated bounding boxes of all text regions for the reading orientations
+ * of the ground truth text regions (used by CheckIfMergeAllowable).
+ * Has to be called after the region outlines have been made isothetic and restricted to the document dimensions.
+ */
+void CLayoutEvaluator::PrepareRotatedBoundingBoxes()
+{
+	delete m_RotatedBoundingBoxes;
+	m_RotatedBoundingBoxes = NULL;
+
+	CPageLayout * groundTruth = m_LayoutEvaluation->GetGroundTruth();
+	CPageLayout * segResult = m_LayoutEvaluation->GetSegResult();
+	if (groundTruth == NULL || segResult == NULL)
+		return;
+
+	//Collect the orientations
+	set<double> orientations;
+	vector<CLayoutObject*> textRegions;
+	CLayoutObjectIterator * it = CLayoutObjectIterator::GetLayoutObjectIterator(groundTruth, CLayoutObject::TYPE_LAYOUT_REGION, CLayoutRegion::TYPE_TEXT);
+	if (it != NULL)
+	{
+		while (it->HasNext())
+		{
+			CLayoutObject * region = it->Next();
+			double orientation = GetReadingOrientation((CTextRegionInfo*)((CLayoutRegion*)region)->GetRegionInfo());
+			if (orientation != 0.0)
+				orientations.insert(orientation);
+			textRegions.push_back(region);
+		}
+		delete it;
+	}
+	if (orientations.empty())
+		return;
+
+	it = CLayoutObjectIterator::GetLayoutObjectIterator(segResult, CLayoutObject::TYPE_LAYOUT_REGION, CLayoutRegion::TYPE_TEXT);
+	if (it != NULL)
+	{
+		while (it->HasNext())
+			textRegions.push_back(it->Next());
+		delete it;
+	}
+
+	//Calculate the boxes
+	m_RotatedBoundingBoxes = new CRotatedBoundingBoxCache();
+	for (set<double>::iterator itOrientation = orientations.begin(); itOrientation != orientations.end(); itOrientation++)
+		for (unsigned int i=0; i<textRegions.size(); i++)
+			m_RotatedBoundingBoxes->Add(textRegions[i], *itOrientation);
+}
+
 /*
  * Extended allowable check (CC 13.06.2011)
  *  The basic allowable check (used above) only takes into account region pairs.
@@ -1783,23 +2141,37 @@ void CLayoutEvaluator::AllowableSequenceDetection(CEvaluationResults * results,
 		gtRegionId = (*itGtRegion).first;
 		merge = (*itGtRegion).second;
 
-		//Region in reading order?
-		if (!readingOrder->ContainsRegionRef(gtRegionId))
-			continue;
+		CReadingOrderGroup * group = NULL;
+		int index = -1;
+		if (m_GroundTruthPositions != NULL && m_GroundTruthPositions->GetReadingOrder() == readingOrder)
+		{
+			//Region in reading order and group of the region ordered?
+			CReadingOrderPosition * position = m_GroundTruthPositions->GetPosition(gtRegionId);
+			if (position == NULL || !position->m_Sorted)
+				continue;
+			group = position->m_Group;
+			index = position->m_Index;
+		}
+		else
+		{
+			//Region in reading order?
+			if (!readingOrder->ContainsRegionRef(gtRegionId))
+				continue;
 
-		//Is the group of the region ordered?
-		CReadingOrderGroup * group = FindReadingOrderGroup(gtRegionId, readingOrder->GetRoot());
-		if (group == NULL || !group->IsSorted())
-			continue;
+			//Is the group of the region ordered?
+			group = FindReadingOrderGroup(gtRegionId, readingOrder->GetRoot());
+			if (group == NULL || !group->IsSorted())
+				continue;
 
-		//Get the position of the region in the group
-		CReadingOrderRegionRef * gtRegionRef = group->FindRegionRef(gtRegionId);
-		if (gtRegionRef == NULL)
-			continue;
+			//Get the position of the region in the group
+			CReadingOrderRegionRef * gtRegionRef = group->FindRegionRef(gtRegionId);
+			if (gtRegionRef == NULL)
+				continue;
 
-		int index = group->GetIndexOfElement(gtRegionRef);
-		if (index < 0)
-			continue;
+			index = group->GetIndexOfElement(gtRegionRef);
+			if (index < 0)
+				continue;
+		}
 
 		//Follow the reading order forwards and look for allowable
 		CUniString region1 = gtRegionId;
@@ -1870,6 +2242,16 @@ void CLayoutEvaluator::AllowableSequenceDetection(CEvaluationResults * results,
 	}
 }
 
+/*
+ * Checks if the given reading order contains a ref to the specified region (uses the position index if available).
+ */
+bool CLayoutEvaluator::ContainsRegionRef(CReadingOrder * readingOrder, CUniString regionId)
+{
+	if (m_GroundTruthPositions != NULL && m_GroundTruthPositions->GetReadingOrder() == readingOrder)
+		return m_GroundTruthPositions->Contains(regionId);
+	return readingOrder->ContainsRegionRef(regionId);
+}
+
 CReadingOrderGroup * CLayoutEvaluator::FindReadingOrderGroup(CUniString regionRef, 
 															 CReadingOrderGroup * startGroup)
 {
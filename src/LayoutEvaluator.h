@@ -16,14 +16,80 @@
 #include "LayoutEvaluation.h"
 #include "Algorithm.h"
 #include "RegionIterator.h"
-#include "BoundingBoxMap.h"
+#include "LayoutObjectIndex.h"
+#include "IntervalOverlapSweep.h"
+#include "LabelRasterOverlap.h"
+#include "ReadingOrderRelationMatrix.h"
+#include "ReadingOrderPositionIndex.h"
+#include "RotatedBoundingBoxCache.h"
 #include "IntervalRepresentation.h"
 #include "RegionOverlap.h"
 #include "DocumentLayout.h"
+#include "WorkerPool.h"
+#include <functional>
 
 namespace PRImA
 {
 
+/*
+ * Class COverlapShard
+ *
+ * Layout object overlaps calculated by one worker thread (for a chunk of ground truth objects).
+ * The shard is merged into the evaluation results afterwards (see CLayoutEvaluator::MergeOverlapShard).
+ */
+
+class COverlapShard
+{
+public:
+	inline void AddLayoutObjectOverlap(CLayoutObject * groundTruth, CUniString segResult, CLayoutObjectOverlap * overlap) 
+	{
+		m_OverlapGroundTruthObjects.push_back(groundTruth);
+		m_OverlapSegResultObjects.push_back(segResult);
+		m_Overlaps.push_back(overlap);
+	};
+	inline void AddMultiOverlapIntervalRep(CLayoutObject * groundTruth, CLayoutObjectOverlap * overlap)
+	{
+		m_MultiOverlapGroundTruthObjects.push_back(groundTruth);
+		m_MultiOverlaps.push_back(overlap);
+	};
+	inline void Clear()
+	{
+		m_OverlapGroundTruthObjects.clear();
+		m_OverlapSegResultObjects.clear();
+		m_Overlaps.clear();
+		m_MultiOverlapGroundTruthObjects.clear();
+		m_MultiOverlaps.clear();
+	};
+
+public:
+	//Pairwise overlaps (parallel lists)
+	std::vector<CLayoutObject*>				m_OverlapGroundTruthObjects;
+	std::vector<CUniString>					m_OverlapSegResultObjects;
+	std::vector<CLayoutObjectOverlap*>		m_Overlaps;
+
+	//Multi overlaps (parallel lists)
+	std::vector<CLayoutObject*>				m_MultiOverlapGroundTruthObjects;
+	std::vector<CLayoutObjectOverlap*>		m_MultiOverlaps;
+};
+
+
+/*
+ * Class CReadingOrderOverlapWeight
+ *
+ * Overlap of a segmentation result text region with one ground truth region, relative to the size of
+ * each of the two regions. Calculated once per overlapping pair (see CLayoutEvaluator::EvaluateReadingOrder).
+ */
+
+class CReadingOrderOverlapWeight
+{
+public:
+	CLayoutObject *	m_GroundTruthRegion;
+	int				m_GroundTruthIndex;		//Index in the ground truth relation matrix (-1 if not available)
+	double			m_WeightSeg;			//Overlap relative to the segmentation result region
+	double			m_WeightGt;				//Overlap relative to the ground truth region
+};
+
+
 /*
  * Class CLayoutEvaluator
  *
@@ -43,6 +109,9 @@ private:
 	static const int NESTED_REGION_MODE_NESTED_TO_PARENT	= 3;
 	static const int NESTED_REGION_MODE_NESTED_TO_NESTED	= 4;
 
+	static const int OBJECT_CHUNK_SIZE = 256; //Number of layout objects per worker task (overlap calculation and error detection)
+	static const int READING_ORDER_BLOCK_SIZE = 16; //Number of regions (rows of the region pair matrix) per worker task (reading order evaluation)
+
 	// CONSTRUCTION
 public:
 	CLayoutEvaluator(CLayoutEvaluation * layoutEval, CEvaluationProfile * profile,
@@ -59,71 +128,96 @@ public:
 
 	inline void SetConvertToIsothetic(bool convertToIsothetic) { m_ConvertToIsothetic = convertToIsothetic; };
 
+	//Number of worker threads for evaluating the different levels (regions, lines, ...) in parallel (1 = no threads, 0 = number of cores)
+	inline void SetMaxThreads(int maxThreads) { m_MaxThreads = maxThreads; };
+
+	//Use the label raster engine for overlap areas and pixel counts of regions, lines, words and glyphs (see CLabelRasterOverlap)
+	inline void SetUseLabelRaster(bool useLabelRaster) { m_UseLabelRaster = useLabelRaster; };
+
+	//Layout region types (see CLayoutRegion::TYPE_...) for which the type specific metrics are calculated during the evaluation
+	//(in one pass with the overall metrics). Metrics of other types are calculated on first access (default: none).
+	inline void SetEagerMetricsRegionTypes(const std::vector<int> & regionTypes) { m_EagerMetricsRegionTypes = regionTypes; };
+
 	inline CLayoutEvaluation * GetLayoutEvaluationData() { return m_LayoutEvaluation; };
 
 private:
+	void				ParallelFor(int taskCount, std::function<void(int)> task);
+	CEvaluationResults * GetResults(CLayoutEvaluation * layoutEval, int layoutObjectType, bool createIfNotExists = false);
+
 	void				Evaluate(int layoutObjectType);
 	void				EvaluateRegionsAndNestedRegions();
 
 	void				ProcessGroundTruthObjects(int layoutObjectType, CLayoutEvaluation * layoutEval, int nestedRegionsMode = NESTED_REGION_MODE_IGNORE);
 	void				PrepareGroundTruthBorder(CLayoutEvaluation * layoutEval);
 	void				PrepareGroundTruthReadingOrderGroups(CLayoutEvaluation * layoutEval);
-	void				PrepareGroundTruthRegionsLinesWordsGlyphs(int layoutObjectType, CLayoutEvaluation * layoutEval, int nestedRegionsMode = NESTED_REGION_MODE_IGNORE);
+	void				PrepareGroundTruthRegionsLinesWordsGlyphs(int layoutObjectType, CLayoutEvaluation * layoutEval, int nestedRegionsMode = NESTED_REGION_MODE_IGNORE,
+																	CLayoutObjectIndex * sharedIndex = NULL);
+	void				PrepareSharedGeometry(CEvaluationResults * sharedGeometry, CPageLayout * pageLayout, bool isGroundTruth);
 
 	void				ConvertToIsothetic(int layoutObjectType, CLayoutEvaluation * layoutEval);
 
-	void				CalculateOverlaps(CLayoutObject * groundTruthObject, CBoundingBoxMap * boundingBoxMap, CEvaluationResults * results);
+	void				FindOverlapCandidates(CLayoutObjectIndex * segResIndex, std::vector<CLayoutObject*> * groundTruthObjects,
+												CEvaluationResults * results, bool useLabelRaster,
+												std::vector<std::pair<int,int>> * candidatePairs, std::vector<int> * candidateStart,
+												std::vector<long> * candidateAreas);
+	void				CalculateOverlaps(CLayoutObject * groundTruthObject, CLayoutObjectIndex * segResIndex, 
+											std::pair<int,int> * candidates, long * candidateAreas, int candidateCount,
+											CEvaluationResults * results, COverlapShard * shard);
+	void				MergeOverlapShard(COverlapShard * shard, CEvaluationResults * results);
 
 	void				IncreaseProgress(double amount);
 	CLayoutObjectIterator *	GetLayoutObjectIterator(CPageLayout * pageLayout, int layoutObjectType);
 	CLayoutObjectIterator *	GetLayoutObjectIterator(CPageLayout * pageLayout, int layoutObjectType, bool includeNested);
+	void				GetLayoutObjects(CPageLayout * pageLayout, int layoutObjectType, std::vector<CLayoutObject*> * targetList);
 
 	void				FindErrors(int layoutObjectType, CLayoutEvaluation * layoutEval, int nestedRegionsMode = NESTED_REGION_MODE_IGNORE);
 	void				FindGroundTruthBasedErrorsForLayoutObject(int regionType, CEvaluationResults * results, CLayoutObjectEvaluationResult * result,
-																CLayoutObject * groundTruthObject, std::set<CUniString> * segResultObjects);
+																CLayoutObject * groundTruthObject, COverlapRow * segResultObjects);
 
 
 	void				FindBorderErrors(CLayoutEvaluation * layoutEval);
 	void				CheckMerge(	int layoutObjectType, CEvaluationResults * results,
 									CLayoutObjectEvaluationResult * result,
 									CLayoutObject * groundTruthObject, 
-									std::set<CUniString> * segResultObjects);
+									COverlapRow * segResultObjects);
 	void				CheckSplit(	int layoutObjectType, CEvaluationResults * results,
 									CLayoutObjectEvaluationResult * result,
 									CLayoutObject * groundTruthObject, 
-									std::set<CUniString> * segResultObjects);
+									COverlapRow * segResultObjects);
 	void				CheckMiss(	int layoutObjectType, CEvaluationResults * results,
 									CLayoutObjectEvaluationResult * result,
 									CLayoutObject * groundTruthObject, 
-									std::set<CUniString> * segResultObjects);
+									COverlapRow * segResultObjects);
 	void				CheckPartMiss(	int layoutObjectType, CEvaluationResults * results,
 										CLayoutObjectEvaluationResult * result,
 										CLayoutObject * groundTruthObject, 
-										std::set<CUniString> * segResultObjects);
+										COverlapRow * segResultObjects);
 	void				CheckMisclass(	int layoutObjectType, CEvaluationResults * results,
 										CLayoutObjectEvaluationResult * result,
 										CLayoutObject * groundTruthObject, 
-										std::set<CUniString> * segResultObjects);
+										COverlapRow * segResultObjects);
 	void				CheckMisclassForRegion(CEvaluationResults * results,
 										CLayoutObjectEvaluationResult * result,
 										CLayoutObject * groundTruthObject,
-										std::set<CUniString> * segResultObjects);
+										COverlapRow * segResultObjects);
 	void				CheckMisclassForReadingOrderGroup(CEvaluationResults * results,
 										CLayoutObjectEvaluationResult * result,
 										CLayoutObject * groundTruthObject,
-										std::set<CUniString> * segResultObjects);
+										COverlapRow * segResultObjects);
 	void				CheckInvented(	int layoutObjectType, CEvaluationResults * results,
 										CLayoutObjectEvaluationResult * result,
 										CLayoutObject * segResultObject, 
-										std::set<CUniString> * groundTruthObjects);
+										COverlapRow * groundTruthObjects);
 
 	void				EvaluateReadingOrder(CEvaluationResults * results, CLayoutEvaluation * layoutEval);
+	void				CalculateReadingOrderOverlapWeights(CEvaluationResults * results, CLayoutEvaluation * layoutEval,
+															CLayoutObject * segResultRegion, std::vector<CReadingOrderOverlapWeight> * weights);
 
 	bool				CheckFalseAlarm(CLayoutObjectEvaluationError * err);
 
-	long				SplitByPixelArea(std::list<CRect*> * input,
-		std::list<CRect*> * falseAlarm,
-		std::map<CRect*, long> * realErrors);
+	long				SplitByPixelArea(CCompactRectArray * input,
+		CCompactRectArray * falseAlarm,
+		CCompactRectArray * realErrors);
 
 	//long				CountForegroundPixels(COpenCvBiLevelImage * image, CRect * rect);
 
@@ -138,6 +232,9 @@ private:
 											  bool useReadingdirectionAndOrientation);
 	void				AllowableSequenceDetection(CEvaluationResults * results, CLayoutEvaluation * layoutEval);
 	CReadingOrderGroup * FindReadingOrderGroup(CUniString regionRef, CReadingOrderGroup * startGroup);
+	bool				ContainsRegionRef(CReadingOrder * readingOrder, CUniString regionId);
+	CRect				GetRotatedBoundingBox(CLayoutObject * object, double orientation);
+	void				PrepareRotatedBoundingBoxes();
 	
 	CUniString			GetReadingDirection(CTextRegionInfo * info);
 	double				GetReadingOrientation(CTextRegionInfo * info);
@@ -159,7 +256,8 @@ private:
 											long splitMultiplier, long missMultiplier, long partialMissMultiplier,
 											long misclassMultiplier);
 
-	void				CopyLayoutObjectEvalResults(CEvaluationResults * targetResults, std::map<CUniString, CLayoutObjectEvaluationResult*> * target, CLayoutObjectEvaluationResult * evalRes);
+	void				MoveLayoutObjectEvalResults(CEvaluationResults * targetResults, std::map<CUniString, CLayoutObjectEvaluationResult*> * target, 
+													std::map<CUniString, CLayoutObjectEvaluationResult*>::iterator source);
 
 	// DATA ITEMS
 private:
@@ -185,6 +283,17 @@ private:
 
 	//Option to convert all polygons to isothetic format before running the evaluation (also removes possible loops) (default: true)
 	bool m_ConvertToIsothetic;
+
+	int					m_MaxThreads;		//Size of the worker pool (1 = run in calling thread, 0 = number of cores, default: 0)
+	CWorkerPool		*	m_WorkerPool;		//Threads for ParallelFor (created in RunEvaluation, NULL if m_MaxThreads is 1)
+	bool				m_UseLabelRaster;	//Overlap areas and pixel counts via label raster (from the profile, see CEvaluationProfile::IsUseLabelRaster)
+	std::vector<int>	m_EagerMetricsRegionTypes;	//Region types with metrics calculated during the evaluation
+
+	CReadingOrderRelationMatrix	*	m_GroundTruthRelations;	//Precalculated reading order relations (during RunEvaluation, can be NULL)
+	CReadingOrderRelationMatrix	*	m_SegResultRelations;
+	CRotatedBoundingBoxCache	*	m_RotatedBoundingBoxes;	//Text region bounding boxes per reading orientation (during RunEvaluation, can be NULL)
+	CReadingOrderPositionIndex	*	m_GroundTruthPositions;	//Region ref positions in the ground truth reading order (during RunEvaluation, can be NULL)
+	CCriticalSection	m_CriticalSect;		//For synchronization (progress)
 };
 
 
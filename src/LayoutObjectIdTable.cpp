@@ -0,0 +1,85 @@
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include "stdafx.h"
+#include "LayoutObjectIdTable.h"
+#include "RegionIterator.h"
+
+using namespace std;
+
+namespace PRImA
+{
+
+/*
+ * Class CLayoutObjectIdTable
+ *
+ * Maps the IDs of layout objects to dense indices (0..size-1), so that data per layout object
+ * can be stored in vectors. Initially contains all objects of one type of a page layout,
+ * further IDs (e.g. of objects that are not part of the layout) can be added.
+ */
+
+/*
+ * Constructor
+ *
+ * 'pageLayout' - Objects to add (can be NULL)
+ * 'layoutObjectType' - Type of the objects to add (see CLayoutObject::TYPE_..., layout regions include nested regions)
+ */
+CLayoutObjectIdTable::CLayoutObjectIdTable(CPageLayout * pageLayout, int layoutObjectType)
+{
+	if (pageLayout == NULL || layoutObjectType == CLayoutObject::TYPE_BORDER)
+		return;
+
+	CLayoutObjectIterator * it = NULL;
+	if (layoutObjectType == CLayoutObject::TYPE_READING_ORDER_GROUP)
+		it = new CReadingOrderGroupIterator(pageLayout, 2, false);
+	else
+		it = CLayoutObjectIterator::GetLayoutObjectIterator(pageLayout, layoutObjectType, true);
+	if (it == NULL)
+		return;
+
+	while (it->HasNext())
+	{
+		CLayoutObject * object = it->Next();
+		Add(object->GetId(), object);
+	}
+	delete it;
+}
+
+/*
+ * Destructor
+ */
+CLayoutObjectIdTable::~CLayoutObjectIdTable()
+{
+}
+
+/*
+ * Returns the index of the given ID or -1 if not in the table.
+ */
+int CLayoutObjectIdTable::GetIndex(const CUniString & id)
+{
+	CIndexMap::iterator it = m_Indices.find(id);
+	if (it == m_Indices.end())
+		return -1;
+	return (*it).second;
+}
+
+/*
+ * Adds the given ID (if not in the table already) and returns its index.
+ * 'object' - Corresponding layout object (can be NULL)
+ */
+int CLayoutObjectIdTable::Add(const CUniString & id, CLayoutObject * object)
+{
+	int index = (int)m_Ids.size();
+	pair<CIndexMap::iterator, bool> res = m_Indices.insert(pair<CUniString, int>(id, index));
+	if (!res.second) //Exists already
+		return (*res.first).second;
+	m_Ids.push_back(id);
+	m_Objects.push_back(object);
+	m_Subtypes.push_back(SUBTYPE_UNRESOLVED);
+	return index;
+}
+
+} //end namespace
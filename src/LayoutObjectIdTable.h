@@ -0,0 +1,73 @@
+#pragma once
+
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include "DocumentLayout.h"
+#include <unordered_map>
+#include <vector>
+
+namespace PRImA
+{
+
+/*
+ * Hash and equality for CUniString keys of unordered maps (FNV-1a over the characters)
+ */
+struct CUniStringHash
+{
+	size_t operator()(const CUniString & str) const
+	{
+		CUniString & s = const_cast<CUniString &>(str); //(GetLength and [] are not const)
+		size_t hash = 2166136261u;
+		for (int i=0; i<s.GetLength(); i++)
+			hash = (hash ^ (size_t)s[i]) * 16777619u;
+		return hash;
+	}
+};
+
+struct CUniStringEqual
+{
+	bool operator()(const CUniString & a, const CUniString & b) const { return !(a < b) && !(b < a); }
+};
+
+
+/*
+ * Class CLayoutObjectIdTable
+ *
+ * Maps the IDs of layout objects to dense indices (0..size-1), so that data per layout object
+ * can be stored in vectors. Initially contains all objects of one type of a page layout,
+ * further IDs (e.g. of objects that are not part of the layout) can be added.
+ */
+class CLayoutObjectIdTable
+{
+public:
+	static const int SUBTYPE_NONE		= -1;	//The object has no subtype
+	static const int SUBTYPE_UNRESOLVED	= -2;	//The subtype hasn't been resolved (e.g. object unknown)
+
+public:
+	CLayoutObjectIdTable(CPageLayout * pageLayout, int layoutObjectType);
+	~CLayoutObjectIdTable();
+
+	int						GetIndex(const CUniString & id);
+	int						Add(const CUniString & id, CLayoutObject * object);
+	inline CUniString		GetId(int index) { return m_Ids[index]; };
+	inline CLayoutObject *	GetObject(int index) { return m_Objects[index]; };		//Can be NULL
+	inline int				GetSize() { return (int)m_Ids.size(); };
+
+	//Interned subtype of the object (index into the subtypes of the owning results, see CEvaluationResults::GetSubtypeIndex)
+	inline int				GetSubtype(int index) { return m_Subtypes[index]; };
+	inline void				SetSubtype(int index, int subtype) { m_Subtypes[index] = subtype; };
+
+private:
+	typedef std::unordered_map<CUniString, int, CUniStringHash, CUniStringEqual> CIndexMap;
+
+	CIndexMap						m_Indices;	//Map [ID, index] (hashed, looked up for every object access)
+	std::vector<CUniString>			m_Ids;
+	std::vector<CLayoutObject*>		m_Objects;
+	std::vector<int>				m_Subtypes;	//Interned subtype per object (SUBTYPE_NONE, SUBTYPE_UNRESOLVED or index >= 0)
+};
+
+} //end namespace
@@ -0,0 +1,182 @@
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include "stdafx.h"
+#include "LayoutObjectIndex.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace PRImA
+{
+
+/*
+ * Class CLayoutObjectIndex
+ *
+ * Static spatial index (packed R-tree) for the bounding boxes of a set of layout objects.
+ * The leaves are ordered using sort-tile-recursive (STR) packing. The index is built once
+ * and is read-only afterwards (queries can be run from several threads).
+ */
+
+/*
+ * Constructor
+ *
+ * 'objects' - The layout objects to index (the list is copied, the objects are not)
+ */
+CLayoutObjectIndex::CLayoutObjectIndex(vector<CLayoutObject*> * objects)
+{
+	m_Objects = *objects;
+	Build();
+}
+
+/*
+ * Destructor
+ */
+CLayoutObjectIndex::~CLayoutObjectIndex()
+{
+}
+
+/*
+ * Builds the tree levels bottom-up.
+ */
+void CLayoutObjectIndex::Build()
+{
+	//Leaf level (objects without coordinates cannot overlap anything and are left out)
+	vector<CLayoutObjectIndexBox> leaves;
+	for (int i=0; i<(int)m_Objects.size(); i++)
+	{
+		CLayoutObjectIndexBox box;
+		if (GetBox(m_Objects[i], box))
+		{
+			box.m_Index = i;
+			box.m_Count = 0;
+			leaves.push_back(box);
+		}
+	}
+	if (leaves.empty())
+		return;
+
+	//Sort-tile-recursive packing: Sort by x centre, cut into vertical slices and sort each slice by y centre
+	int leafCount = (int)leaves.size();
+	int leafNodeCount = (leafCount + NODE_CAPACITY - 1) / NODE_CAPACITY;
+	int sliceCount = (int)ceil(sqrt((double)leafNodeCount));
+	int sliceSize = sliceCount * NODE_CAPACITY;
+
+	sort(leaves.begin(), leaves.end(), [](const CLayoutObjectIndexBox & a, const CLayoutObjectIndexBox & b)
+	{
+		return a.m_X1 + a.m_X2 < b.m_X1 + b.m_X2;
+	});
+	for (int start=0; start<leafCount; start+=sliceSize)
+	{
+		int end = min(start + sliceSize, leafCount);
+		sort(leaves.begin() + start, leaves.begin() + end, [](const CLayoutObjectIndexBox & a, const CLayoutObjectIndexBox & b)
+		{
+			return a.m_Y1 + a.m_Y2 < b.m_Y1 + b.m_Y2;
+		});
+	}
+	m_Levels.push_back(leaves);
+
+	//Node levels (each node covers NODE_CAPACITY consecutive entries of the level below)
+	while (m_Levels.back().size() > 1)
+	{
+		vector<CLayoutObjectIndexBox> nodes;
+		vector<CLayoutObjectIndexBox> & children = m_Levels.back();
+		int childCount = (int)children.size();
+		for (int first=0; first<childCount; first+=NODE_CAPACITY)
+		{
+			int end = min(first + NODE_CAPACITY, childCount);
+			CLayoutObjectIndexBox node = children[first];
+			for (int i=first+1; i<end; i++)
+			{
+				node.m_X1 = min(node.m_X1, children[i].m_X1);
+				node.m_Y1 = min(node.m_Y1, children[i].m_Y1);
+				node.m_X2 = max(node.m_X2, children[i].m_X2);
+				node.m_Y2 = max(node.m_Y2, children[i].m_Y2);
+			}
+			node.m_Index = first;
+			node.m_Count = end - first;
+			nodes.push_back(node);
+		}
+		m_Levels.push_back(nodes);
+	}
+}
+
+/*
+ * Finds all indexed objects with a bounding box intersecting the bounding box of a query object.
+ *
+ * 'queryObjects' - Objects to look for
+ * 'candidatePairs' (out) - Flat list of pairs [query object index, indexed object index].
+ *                          Sorted by query object index and, per query object, by indexed object index.
+ */
+void CLayoutObjectIndex::FindCandidatePairs(vector<CLayoutObject*> * queryObjects, vector<pair<int,int>> * candidatePairs)
+{
+	if (m_Levels.empty())
+		return;
+
+	vector<pair<int,int>> stack; //Reused for all queries
+	CLayoutObjectIndexBox queryBox;
+	for (int i=0; i<(int)queryObjects->size(); i++)
+	{
+		if (!GetBox(queryObjects->at(i), queryBox))
+			continue;
+
+		size_t start = candidatePairs->size();
+		Query(queryBox, i, candidatePairs, &stack);
+		sort(candidatePairs->begin() + start, candidatePairs->end());
+	}
+}
+
+/*
+ * Collects the candidates for one query box.
+ */
+void CLayoutObjectIndex::Query(CLayoutObjectIndexBox & queryBox, int queryIndex, vector<pair<int,int>> * candidatePairs,
+								vector<pair<int,int>> * stack)
+{
+	//Stack with [level, position in level]
+	stack->clear();
+	int topLevel = (int)m_Levels.size() - 1;
+	for (int i=0; i<(int)m_Levels[topLevel].size(); i++)
+		stack->push_back(pair<int,int>(topLevel, i));
+
+	while (!stack->empty())
+	{
+		pair<int,int> entry = stack->back();
+		stack->pop_back();
+
+		CLayoutObjectIndexBox & box = m_Levels[entry.first][entry.second];
+		if (!Intersects(queryBox, box))
+			continue;
+
+		if (entry.first == 0) //Leaf
+			candidatePairs->push_back(pair<int,int>(queryIndex, box.m_Index));
+		else //Node
+		{
+			for (int i=box.m_Index; i<box.m_Index+box.m_Count; i++)
+				stack->push_back(pair<int,int>(entry.first-1, i));
+		}
+	}
+}
+
+/*
+ * Retrieves the bounding box of the given object.
+ * Returns false if the object has no coordinates.
+ */
+bool CLayoutObjectIndex::GetBox(CLayoutObject * object, CLayoutObjectIndexBox & box)
+{
+	CLayoutPolygon * coords = object->GetCoords();
+	if (coords == NULL || coords->GetNoPoints() == 0)
+		return false;
+	box.m_X1 = coords->GetBBX1();
+	box.m_Y1 = coords->GetBBY1();
+	box.m_X2 = coords->GetBBX2();
+	box.m_Y2 = coords->GetBBY2();
+	box.m_Index = -1;
+	box.m_Count = 0;
+	return true;
+}
+
+} //end namespace
@@ -0,0 +1,69 @@
+#pragma once
+
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include "DocumentLayout.h"
+#include <vector>
+
+namespace PRImA
+{
+
+/*
+ * Class CLayoutObjectIndexBox
+ *
+ * Bounding box of a layout object or of an index node.
+ */
+class CLayoutObjectIndexBox
+{
+public:
+	int m_X1;
+	int m_Y1;
+	int m_X2;
+	int m_Y2;
+	int m_Index;	//Object index (leaf level) or first child (node levels)
+	int m_Count;	//Number of children (node levels)
+};
+
+
+/*
+ * Class CLayoutObjectIndex
+ *
+ * Static spatial index (packed R-tree) for the bounding boxes of a set of layout objects.
+ * The leaves are ordered using sort-tile-recursive (STR) packing. The index is built once
+ * and is read-only afterwards (queries can be run from several threads).
+ */
+class CLayoutObjectIndex
+{
+public:
+	static const int NODE_CAPACITY = 16;
+
+public:
+	CLayoutObjectIndex(std::vector<CLayoutObject*> * objects);
+	~CLayoutObjectIndex();
+
+	void	FindCandidatePairs(std::vector<CLayoutObject*> * queryObjects, std::vector<std::pair<int,int>> * candidatePairs);
+
+	inline CLayoutObject *	GetObject(int index) { return m_Objects[index]; };
+	inline int				GetSize() { return (int)m_Objects.size(); };
+
+private:
+	void	Build();
+	void	Query(CLayoutObjectIndexBox & queryBox, int queryIndex, std::vector<std::pair<int,int>> * candidatePairs,
+					std::vector<std::pair<int,int>> * stack);
+	bool	GetBox(CLayoutObject * object, CLayoutObjectIndexBox & box);
+
+	inline bool Intersects(CLayoutObjectIndexBox & a, CLayoutObjectIndexBox & b)
+	{
+		return a.m_X1 <= b.m_X2 && b.m_X1 <= a.m_X2 && a.m_Y1 <= b.m_Y2 && b.m_Y1 <= a.m_Y2;
+	};
+
+private:
+	std::vector<CLayoutObject*>		m_Objects;
+	std::vector<std::vector<CLayoutObjectIndexBox>>	m_Levels;	//Level 0: object boxes (STR order), last level: root node(s)
+};
+
+} //end namespace
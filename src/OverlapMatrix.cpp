@@ -0,0 +1,122 @@
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include "stdafx.h"
+#include "OverlapMatrix.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace PRImA
+{
+
+/*
+ * Class COverlapRow
+ *
+ * All objects overlapping one object (one row of a COverlapMatrix).
+ * Iterating over a row yields the IDs of the overlapping objects (in ID order, like std::set<CUniString>).
+ */
+
+/*
+ * Returns the entry for the given overlapping object index or NULL if the objects don't overlap.
+ */
+COverlapMatrixEntry * COverlapRow::Find(int index)
+{
+	for (int i=0; i<m_Size; i++)
+		if (m_Entries[i].m_Index == index)
+			return m_Entries + i;
+	return NULL;
+}
+
+
+/*
+ * Class COverlapMatrix
+ *
+ * Sparse matrix of overlapping object pairs in compressed sparse row format
+ * (row = object index of one layout, column = object index of the other layout).
+ * Read-only after Build() (can be used from several threads).
+ */
+
+/*
+ * Constructor
+ */
+COverlapMatrix::COverlapMatrix()
+{
+}
+
+/*
+ * Destructor
+ */
+COverlapMatrix::~COverlapMatrix()
+{
+}
+
+/*
+ * Replaces the content of the matrix.
+ * 'rowCount' - Number of rows (all row indices of 'entries' must be smaller)
+ * 'entries' - Pairs [row, entry] (sorted in place)
+ * 'columnOrder' - Position of each column index in the desired order of the entries within a row
+ * 'columnIds' - IDs of the column objects (see COverlapRow::iterator)
+ */
+void COverlapMatrix::Build(int rowCount, vector<pair<int, COverlapMatrixEntry> > * entries, 
+						   vector<int> * columnOrder, CLayoutObjectIdTable * columnIds)
+{
+	sort(entries->begin(), entries->end(), 
+		[columnOrder](const pair<int, COverlapMatrixEntry> & a, const pair<int, COverlapMatrixEntry> & b)
+		{
+			if (a.first != b.first)
+				return a.first < b.first;
+			return columnOrder->at(a.second.m_Index) < columnOrder->at(b.second.m_Index);
+		});
+
+	//Entries
+	m_Entries.resize(entries->size());
+	vector<int> rowStart(rowCount + 1, 0);
+	for (unsigned int i=0; i<entries->size(); i++)
+	{
+		m_Entries[i] = entries->at(i).second;
+		rowStart[entries->at(i).first + 1]++;
+	}
+	for (int i=1; i<=rowCount; i++)
+		rowStart[i] += rowStart[i-1];
+
+	//Row views
+	m_Rows.clear();
+	m_Rows.reserve(rowCount);
+	COverlapMatrixEntry * data = m_Entries.empty() ? NULL : &m_Entries[0];
+	for (int i=0; i<rowCount; i++)
+		m_Rows.push_back(COverlapRow(data + rowStart[i], rowStart[i+1] - rowStart[i], columnIds));
+}
+
+/*
+ * Adds the entries of the transposed matrix (pairs [row, entry]) to the given vector.
+ */
+void COverlapMatrix::GetTransposedEntries(vector<pair<int, COverlapMatrixEntry> > * entries)
+{
+	for (unsigned int row=0; row<m_Rows.size(); row++)
+	{
+		COverlapRow & r = m_Rows[row];
+		for (unsigned int i=0; i<r.size(); i++)
+		{
+			COverlapMatrixEntry entry = *r.GetEntry(i);
+			int column = entry.m_Index;
+			entry.m_Index = (int)row;
+			entries->push_back(pair<int, COverlapMatrixEntry>(column, entry));
+		}
+	}
+}
+
+/*
+ * Returns the given row or NULL if the row is empty or doesn't exist.
+ */
+COverlapRow * COverlapMatrix::GetRow(int row)
+{
+	if (row < 0 || row >= (int)m_Rows.size() || m_Rows[row].empty())
+		return NULL;
+	return &m_Rows[row];
+}
+
+} //end namespace
@@ -0,0 +1,96 @@
+#pragma once
+
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include "RegionOverlap.h"
+#include "LayoutObjectIdTable.h"
+#include <vector>
+
+namespace PRImA
+{
+
+/*
+ * Class COverlapMatrixEntry
+ *
+ * One overlapping object pair within a COverlapMatrix.
+ */
+class COverlapMatrixEntry
+{
+public:
+	int						m_Index;		//Index of the overlapping object (column)
+	CLayoutObjectOverlap *	m_Overlap;		//Overlap of the two objects (can be NULL, e.g. for results loaded from XML)
+	long					m_Area;			//Overlap area (-1 if not available)
+	long					m_PixelCount;	//Number of black pixels within the overlap (-1 if not counted)
+};
+
+
+/*
+ * Class COverlapRow
+ *
+ * All objects overlapping one object (one row of a COverlapMatrix).
+ * Iterating over a row yields the IDs of the overlapping objects (in ID order, like std::set<CUniString>).
+ */
+class COverlapRow
+{
+public:
+	class iterator
+	{
+	public:
+		iterator(COverlapMatrixEntry * entry, CLayoutObjectIdTable * ids) { m_Entry = entry; m_Ids = ids; };
+		inline CUniString				operator*() { return m_Ids->GetId(m_Entry->m_Index); };
+		inline iterator &				operator++() { m_Entry++; return *this; };
+		inline iterator					operator++(int) { iterator ret = *this; m_Entry++; return ret; };
+		inline bool						operator==(const iterator & other) const { return m_Entry == other.m_Entry; };
+		inline bool						operator!=(const iterator & other) const { return m_Entry != other.m_Entry; };
+		inline COverlapMatrixEntry *	GetEntry() { return m_Entry; };
+	private:
+		COverlapMatrixEntry *	m_Entry;
+		CLayoutObjectIdTable *	m_Ids;
+	};
+
+	COverlapRow(COverlapMatrixEntry * entries, int size, CLayoutObjectIdTable * ids) { m_Entries = entries; m_Size = size; m_Ids = ids; };
+
+	inline iterator					begin() { return iterator(m_Entries, m_Ids); };
+	inline iterator					end() { return iterator(m_Entries + m_Size, m_Ids); };
+	inline unsigned int				size() { return (unsigned int)m_Size; };
+	inline bool						empty() { return m_Size == 0; };
+	inline COverlapMatrixEntry *	GetEntry(int i) { return m_Entries + i; };
+	COverlapMatrixEntry *			Find(int index);
+
+private:
+	COverlapMatrixEntry *	m_Entries;
+	int						m_Size;
+	CLayoutObjectIdTable *	m_Ids;	//For the IDs of the overlapping objects
+};
+
+
+/*
+ * Class COverlapMatrix
+ *
+ * Sparse matrix of overlapping object pairs in compressed sparse row format
+ * (row = object index of one layout, column = object index of the other layout).
+ * Read-only after Build() (can be used from several threads).
+ */
+class COverlapMatrix
+{
+public:
+	COverlapMatrix();
+	~COverlapMatrix();
+
+	void			Build(int rowCount, std::vector<std::pair<int, COverlapMatrixEntry> > * entries, 
+							std::vector<int> * columnOrder, CLayoutObjectIdTable * columnIds);
+	void			GetTransposedEntries(std::vector<std::pair<int, COverlapMatrixEntry> > * entries);
+
+	COverlapRow *	GetRow(int row);
+	inline int		GetRowCount() { return (int)m_Rows.size(); };
+
+private:
+	std::vector<COverlapMatrixEntry>	m_Entries;	//All entries, row by row
+	std::vector<COverlapRow>			m_Rows;		//Views on m_Entries
+};
+
+} //end namespace
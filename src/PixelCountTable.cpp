@@ -0,0 +1,92 @@
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include "stdafx.h"
+#include "PixelCountTable.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace PRImA
+{
+
+/*
+ * Class CPixelCountTable
+ *
+ * Summed-area table (integral image) of the black pixels of a bilevel image.
+ * Counting the black pixels within a rectangle takes four lookups.
+ */
+
+/*
+ * Constructor (builds the table)
+ */
+CPixelCountTable::CPixelCountTable(COpenCvBiLevelImage * image)
+{
+	m_Width = image->GetWidth();
+	m_Height = image->GetHeight();
+	int stride = m_Width + 1;
+	m_Sums.assign((size_t)stride * (m_Height + 1), 0);
+
+	for (int y=0; y<m_Height; y++)
+	{
+		int64_t rowSum = 0;
+		int64_t * above = &m_Sums[(size_t)y * stride];
+		int64_t * current = &m_Sums[(size_t)(y+1) * stride];
+		for (int x=0; x<m_Width; x++)
+		{
+			if (image->IsBlack(x, y))
+				rowSum++;
+			current[x+1] = above[x+1] + rowSum;
+		}
+	}
+}
+
+/*
+ * Destructor
+ */
+CPixelCountTable::~CPixelCountTable()
+{
+}
+
+/*
+ * Returns the number of black pixels within the given rectangle (inclusive coordinates, clipped to the image).
+ */
+long CPixelCountTable::CountPixels(int x1, int y1, int x2, int y2)
+{
+	x1 = max(x1, 0);
+	y1 = max(y1, 0);
+	x2 = min(x2, m_Width-1);
+	y2 = min(y2, m_Height-1);
+	if (x2 < x1 || y2 < y1)
+		return 0L;
+
+	size_t stride = m_Width + 1;
+	return (long)(m_Sums[(y2+1) * stride + x2+1]
+				- m_Sums[y1 * stride + x2+1]
+				- m_Sums[(y2+1) * stride + x1]
+				+ m_Sums[y1 * stride + x1]);
+}
+
+/*
+ * Returns the number of black pixels within the given rectangle (right and bottom are inclusive).
+ */
+long CPixelCountTable::CountPixels(CRect * rect)
+{
+	return CountPixels(rect->left, rect->top, rect->right, rect->bottom);
+}
+
+/*
+ * Returns the number of black pixels within the given rectangles (the rectangles should not overlap).
+ */
+long CPixelCountTable::CountPixels(vector<CRect*> * rects)
+{
+	long count = 0L;
+	for (unsigned int i=0; i<rects->size(); i++)
+		count += CountPixels(rects->at(i));
+	return count;
+}
+
+} //end namespace
@@ -0,0 +1,38 @@
+#pragma once
+
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include "opencvimage.h"
+#include <vector>
+#include <cstdint>
+
+namespace PRImA
+{
+
+/*
+ * Class CPixelCountTable
+ *
+ * Summed-area table (integral image) of the black pixels of a bilevel image.
+ * Counting the black pixels within a rectangle takes four lookups.
+ */
+class CPixelCountTable
+{
+public:
+	CPixelCountTable(COpenCvBiLevelImage * image);
+	~CPixelCountTable();
+
+	long	CountPixels(int x1, int y1, int x2, int y2);
+	long	CountPixels(CRect * rect);
+	long	CountPixels(std::vector<CRect*> * rects);
+
+private:
+	int		m_Width;
+	int		m_Height;
+	std::vector<int64_t>	m_Sums;		//(width+1) x (height+1), first row and column are 0 (64 bit, the sums of large images exceed 32 bit)
+};
+
+} //end namespace
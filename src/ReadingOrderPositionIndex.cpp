@@ -0,0 +1,78 @@
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include "stdafx.h"
+#include "ReadingOrderPositionIndex.h"
+
+using namespace std;
+
+namespace PRImA
+{
+
+/*
+ * Class CReadingOrderPositionIndex
+ *
+ * Map from region ID to the position of the region ref within a reading order.
+ * If a region is referenced more than once, the first group found by a search that checks
+ * the region refs of a group before descending into its subgroups is used
+ * (same as CLayoutEvaluator::FindReadingOrderGroup).
+ * Read-only after construction (can be used from several threads).
+ */
+
+/*
+ * Constructor (indexes the whole reading order tree)
+ */
+CReadingOrderPositionIndex::CReadingOrderPositionIndex(CReadingOrder * readingOrder)
+{
+	m_ReadingOrder = readingOrder;
+	if (readingOrder->GetRoot() != NULL)
+		AddGroup(readingOrder->GetRoot());
+}
+
+/*
+ * Destructor
+ */
+CReadingOrderPositionIndex::~CReadingOrderPositionIndex()
+{
+}
+
+/*
+ * Adds the region refs of the given group first and then the ones of the subgroups.
+ */
+void CReadingOrderPositionIndex::AddGroup(CReadingOrderGroup * group)
+{
+	for (int i=0; i<group->GetSize(); i++)
+	{
+		CReadingOrderElement * element = group->GetElement(i);
+		if (element->GetType() != CReadingOrderElement::TYPE_REGION_REF)
+			continue;
+
+		CReadingOrderPosition position;
+		position.m_Group = group;
+		position.m_Index = i;
+		position.m_Sorted = group->IsSorted();
+		m_Positions.insert(pair<CUniString, CReadingOrderPosition>(((CReadingOrderRegionRef*)element)->GetIdRef(), position)); //Keeps the first
+	}
+	for (int i=0; i<group->GetSize(); i++)
+	{
+		CReadingOrderElement * element = group->GetElement(i);
+		if (element->GetType() == CReadingOrderElement::TYPE_GROUP)
+			AddGroup((CReadingOrderGroup*)element);
+	}
+}
+
+/*
+ * Returns the position of the given region or NULL if the region is not part of the reading order.
+ */
+CReadingOrderPosition * CReadingOrderPositionIndex::GetPosition(CUniString region)
+{
+	map<CUniString, CReadingOrderPosition>::iterator it = m_Positions.find(region);
+	if (it == m_Positions.end())
+		return NULL;
+	return &(*it).second;
+}
+
+} //end namespace
@@ -0,0 +1,56 @@
+#pragma once
+
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include "DocumentLayout.h"
+#include <map>
+
+namespace PRImA
+{
+
+/*
+ * Class CReadingOrderPosition
+ *
+ * Position of a region ref within the reading order tree.
+ */
+class CReadingOrderPosition
+{
+public:
+	CReadingOrderGroup *	m_Group;	//Group containing the region ref
+	int						m_Index;	//Index of the region ref within the group
+	bool					m_Sorted;	//Ordered group?
+};
+
+
+/*
+ * Class CReadingOrderPositionIndex
+ *
+ * Map from region ID to the position of the region ref within a reading order.
+ * If a region is referenced more than once, the first group found by a search that checks
+ * the region refs of a group before descending into its subgroups is used
+ * (same as CLayoutEvaluator::FindReadingOrderGroup).
+ * Read-only after construction (can be used from several threads).
+ */
+class CReadingOrderPositionIndex
+{
+public:
+	CReadingOrderPositionIndex(CReadingOrder * readingOrder);
+	~CReadingOrderPositionIndex();
+
+	CReadingOrderPosition *	GetPosition(CUniString region);
+	inline bool				Contains(CUniString region) { return m_Positions.find(region) != m_Positions.end(); };
+	inline CReadingOrder *	GetReadingOrder() { return m_ReadingOrder; };
+
+private:
+	void	AddGroup(CReadingOrderGroup * group);
+
+private:
+	CReadingOrder *								m_ReadingOrder;
+	std::map<CUniString, CReadingOrderPosition>	m_Positions;
+};
+
+} //end namespace
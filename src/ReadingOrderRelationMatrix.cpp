@@ -0,0 +1,169 @@
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include "stdafx.h"
+#include "ReadingOrderRelationMatrix.h"
+
+using namespace std;
+
+namespace PRImA
+{
+
+/*
+ * Class CReadingOrderRelationMatrix
+ *
+ * Relations (see CReadingOrder::CalculateRelation) between the region refs of a reading order.
+ * The region refs are numbered in pre-order of the reading order tree. The relations of each
+ * pair are stored as bitmask (bit n set = relation type n is part of the relation set).
+ * The relation of a pair is calculated by CReadingOrder::CalculateRelation on first access
+ * and looked up afterwards. Can be used from several threads.
+ */
+
+/*
+ * Constructor (numbers the region refs, the relations are calculated on demand)
+ */
+CReadingOrderRelationMatrix::CReadingOrderRelationMatrix(CReadingOrder * readingOrder)
+{
+	m_ReadingOrder = readingOrder;
+	if (readingOrder->GetRoot() != NULL)
+		CollectRegionRefs(readingOrder->GetRoot());
+
+	size_t size = m_RegionIds.size();
+	m_Relations = new atomic<unsigned int>[size * size];
+	for (size_t i=0; i<size * size; i++)
+		m_Relations[i].store(NOT_CALCULATED, memory_order_relaxed);
+}
+
+/*
+ * Destructor
+ */
+CReadingOrderRelationMatrix::~CReadingOrderRelationMatrix()
+{
+	delete [] m_Relations;
+}
+
+/*
+ * Numbers the region refs of the given group and its subgroups (pre-order)
+ */
+void CReadingOrderRelationMatrix::CollectRegionRefs(CReadingOrderGroup * group)
+{
+	for (int i=0; i<group->GetSize(); i++)
+	{
+		CReadingOrderElement * element = group->GetElement(i);
+		if (element->GetType() == CReadingOrderElement::TYPE_GROUP)
+			CollectRegionRefs((CReadingOrderGroup*)element);
+		else if (element->GetType() == CReadingOrderElement::TYPE_REGION_REF)
+		{
+			CUniString regionId = ((CReadingOrderRegionRef*)element)->GetIdRef();
+			if (m_RegionIndex.find(regionId) == m_RegionIndex.end())
+			{
+				m_RegionIndex.insert(pair<CUniString, int>(regionId, (int)m_RegionIds.size()));
+				m_RegionIds.push_back(regionId);
+			}
+		}
+	}
+}
+
+/*
+ * Returns the index of the given region ref or -1 if the region is not part of the reading order.
+ */
+int CReadingOrderRelationMatrix::GetIndex(CUniString region)
+{
+	map<CUniString, int>::iterator it = m_RegionIndex.find(region);
+	if (it == m_RegionIndex.end())
+		return -1;
+	return (*it).second;
+}
+
+/*
+ * Returns the relation mask for the given region pair.
+ * Regions that are not in the reading order are passed on to CReadingOrder::CalculateRelation.
+ */
+unsigned int CReadingOrderRelationMatrix::GetRelation(CUniString region1, CUniString region2)
+{
+	int index1 = GetIndex(region1);
+	int index2 = GetIndex(region2);
+	if (index1 >= 0 && index2 >= 0)
+		return GetRelation(index1, index2);
+
+	return CalculateRelation(region1, region2);
+}
+
+/*
+ * Returns the relation mask for the given region ref indices (calculated on first access).
+ */
+unsigned int CReadingOrderRelationMatrix::GetRelation(int index1, int index2)
+{
+	atomic<unsigned int> & entry = m_Relations[(size_t)index1 * m_RegionIds.size() + index2];
+	unsigned int relation = entry.load(memory_order_acquire);
+	if (relation == NOT_CALCULATED)
+	{
+		relation = CalculateRelation(m_RegionIds[index1], m_RegionIds[index2]);
+		entry.store(relation, memory_order_release);
+	}
+	return relation;
+}
+
+/*
+ * Calls CReadingOrder::CalculateRelation (synchronised, the reading order is not known to be thread-safe)
+ */
+unsigned int CReadingOrderRelationMatrix::CalculateRelation(CUniString region1, CUniString region2)
+{
+	lock_guard<mutex> lock(m_Mutex);
+	return ToMask(m_ReadingOrder->CalculateRelation(region1, region2));
+}
+
+/*
+ * Checks if the given number is one of the relation types (CReadingOrder::RELATION_...)
+ */
+bool CReadingOrderRelationMatrix::IsValidRelation(int relation)
+{
+	if (relation < 0 || relation >= 32) //Has to fit into the mask
+		return false;
+	return	relation == CReadingOrder::RELATION_PREDECESSOR
+		||	relation == CReadingOrder::RELATION_SUCCESSOR
+		||	relation == CReadingOrder::RELATION_BEFORE
+		||	relation == CReadingOrder::RELATION_AFTER
+		||	relation == CReadingOrder::RELATION_UNORDERED
+		||	relation == CReadingOrder::RELATION_UNRELATED
+		||	relation == CReadingOrder::RELATION_UNKNOWN
+		||	relation == CReadingOrder::RELATION_NOT_DEFINED;
+}
+
+/*
+ * Converts a single relation (CReadingOrder::RELATION_...) to a bitmask (0 if it isn't a valid relation type).
+ */
+unsigned int CReadingOrderRelationMatrix::ToMask(int relation)
+{
+	if (!IsValidRelation(relation))
+		return 0;
+	return 1u << relation;
+}
+
+/*
+ * Converts a relation set (CReadingOrder::RELATION_...) to a bitmask (invalid relation types are skipped).
+ */
+unsigned int CReadingOrderRelationMatrix::ToMask(const set<int> & relation)
+{
+	unsigned int mask = 0;
+	for (set<int>::const_iterator it = relation.begin(); it != relation.end(); it++)
+		mask |= ToMask(*it);
+	return mask;
+}
+
+/*
+ * Converts a relation bitmask to a relation set (CReadingOrder::RELATION_...).
+ */
+set<int> CReadingOrderRelationMatrix::ToSet(unsigned int relationMask)
+{
+	set<int> relation;
+	for (int i=0; relationMask != 0; i++, relationMask >>= 1)
+		if (relationMask & 1u)
+			relation.insert(i);
+	return relation;
+}
+
+} //end namespace
@@ -0,0 +1,62 @@
+#pragma once
+
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include "DocumentLayout.h"
+#include <map>
+#include <set>
+#include <vector>
+#include <atomic>
+#include <mutex>
+
+namespace PRImA
+{
+
+/*
+ * Class CReadingOrderRelationMatrix
+ *
+ * Relations (see CReadingOrder::CalculateRelation) between the region refs of a reading order.
+ * The region refs are numbered in pre-order of the reading order tree. The relations of each
+ * pair are stored as bitmask (bit n set = relation type n is part of the relation set).
+ * The relation of a pair is calculated by CReadingOrder::CalculateRelation on first access
+ * and looked up afterwards. Can be used from several threads.
+ */
+class CReadingOrderRelationMatrix
+{
+public:
+	CReadingOrderRelationMatrix(CReadingOrder * readingOrder);
+	~CReadingOrderRelationMatrix();
+
+	unsigned int	GetRelation(CUniString region1, CUniString region2);
+	unsigned int	GetRelation(int index1, int index2);
+	int				GetIndex(CUniString region);
+	inline bool		Contains(CUniString region) { return GetIndex(region) >= 0; };
+	inline int		GetSize() { return (int)m_RegionIds.size(); };
+	inline CUniString GetRegionId(int index) { return m_RegionIds[index]; };
+	inline CReadingOrder * GetReadingOrder() { return m_ReadingOrder; };
+
+	static inline bool HasRelation(unsigned int relationMask, int relation) { return (relationMask & (1u << relation)) != 0; };
+	static bool				IsValidRelation(int relation);
+	static unsigned int		ToMask(int relation);
+	static unsigned int		ToMask(const std::set<int> & relation);
+	static std::set<int>	ToSet(unsigned int relationMask);
+
+private:
+	static const unsigned int NOT_CALCULATED = 0xFFFFFFFF;	//Relation of a pair that hasn't been calculated yet
+
+	void			CollectRegionRefs(CReadingOrderGroup * group);
+	unsigned int	CalculateRelation(CUniString region1, CUniString region2);
+
+private:
+	CReadingOrder *					m_ReadingOrder;
+	std::vector<CUniString>			m_RegionIds;		//Region refs in pre-order (first occurrence)
+	std::map<CUniString, int>		m_RegionIndex;		//Map [region ID, index]
+	std::atomic<unsigned int>	*	m_Relations;		//Matrix [index1 * size + index2] of relation masks (NOT_CALCULATED if not calculated yet)
+	std::mutex						m_Mutex;			//For calls of CReadingOrder::CalculateRelation
+};
+
+} //end namespace
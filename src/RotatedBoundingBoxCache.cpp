@@ -0,0 +1,96 @@
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include "stdafx.h"
+#include "RotatedBoundingBoxCache.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+using namespace std;
+
+namespace PRImA
+{
+
+/*
+ * Class CRotatedBoundingBoxCache
+ *
+ * Bounding boxes of layout objects after rerotating them by a reading orientation
+ * (see CLayoutEvaluator::CheckIfMergeAllowable).
+ * Filled before the evaluation starts and read-only afterwards (can be used from several threads).
+ */
+
+/*
+ * Constructor
+ */
+CRotatedBoundingBoxCache::CRotatedBoundingBoxCache()
+{
+}
+
+/*
+ * Destructor
+ */
+CRotatedBoundingBoxCache::~CRotatedBoundingBoxCache()
+{
+}
+
+/*
+ * Calculates and stores the rotated bounding box of the given object (if not stored already).
+ * 'orientation' - Reading orientation in degrees (-180 to 180, clockwise)
+ */
+void CRotatedBoundingBoxCache::Add(CLayoutObject * object, double orientation)
+{
+	map<CLayoutObject*, CRect> & boxes = m_BoundingBoxes[orientation];
+	if (boxes.find(object) == boxes.end())
+		boxes.insert(pair<CLayoutObject*, CRect>(object, CalculateBoundingBox(object->GetCoords(), orientation)));
+}
+
+/*
+ * Returns the stored rotated bounding box of the given object or NULL if not available.
+ */
+CRect * CRotatedBoundingBoxCache::Get(CLayoutObject * object, double orientation)
+{
+	map<double, map<CLayoutObject*, CRect> >::iterator itOrientation = m_BoundingBoxes.find(orientation);
+	if (itOrientation == m_BoundingBoxes.end())
+		return NULL;
+	map<CLayoutObject*, CRect>::iterator it = (*itOrientation).second.find(object);
+	if (it == (*itOrientation).second.end())
+		return NULL;
+	return &(*it).second;
+}
+
+/*
+ * Rotates the given polygon anti clockwise by the reading orientation and returns the bounding box
+ * of the result (the polygon itself is not changed).
+ */
+CRect CRotatedBoundingBoxCache::CalculateBoundingBox(CPointList * coords, double orientation)
+{
+	double rad = orientation * M_PI / 180.0;
+	double cosRad = cos(rad);
+	double sinRad = sin(rad);
+	int left = INT_MAX, top = INT_MAX, right = INT_MIN, bottom = INT_MIN;
+	int x, y, xRot, yRot;
+
+	CPolygonPoint * p = coords->GetHeadPoint();
+	if (p == NULL)
+		return CRect(0, 0, 0, 0);
+	while (p != NULL)
+	{
+		x = p->GetX();
+		y = -p->GetY();		//The coordinate system is flipped
+		//Rotate
+		xRot =  (int)(x*cosRad - y*sinRad);
+		yRot = -(int)(x*sinRad + y*cosRad);
+		left = min(left, xRot);
+		right = max(right, xRot);
+		top = min(top, yRot);
+		bottom = max(bottom, yRot);
+		p = p->GetNextPoint();
+	}
+	return CRect(left, top, right, bottom);
+}
+
+} //end namespace
@@ -0,0 +1,37 @@
+#pragma once
+
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include "DocumentLayout.h"
+#include <map>
+
+namespace PRImA
+{
+
+/*
+ * Class CRotatedBoundingBoxCache
+ *
+ * Bounding boxes of layout objects after rerotating them by a reading orientation
+ * (see CLayoutEvaluator::CheckIfMergeAllowable).
+ * Filled before the evaluation starts and read-only afterwards (can be used from several threads).
+ */
+class CRotatedBoundingBoxCache
+{
+public:
+	CRotatedBoundingBoxCache();
+	~CRotatedBoundingBoxCache();
+
+	void		Add(CLayoutObject * object, double orientation);
+	CRect *		Get(CLayoutObject * object, double orientation);
+
+	static CRect CalculateBoundingBox(CPointList * coords, double orientation);
+
+private:
+	std::map<double, std::map<CLayoutObject*, CRect> >	m_BoundingBoxes;	//Map [orientation, map [object, bounding box]]
+};
+
+} //end namespace
@@ -0,0 +1,177 @@
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include "stdafx.h"
+#include "WorkerPool.h"
+#include "EvaluationArena.h"
+
+using namespace std;
+
+namespace PRImA
+{
+
+/*
+ * Class CWorkerPool
+ *
+ * Fixed set of worker threads for running loops of independent tasks in parallel (see ParallelFor).
+ * ParallelFor can be called from within a task (nested loops). The calling thread always works on
+ * its own loop, idle workers help with any loop that has unclaimed tasks, so the number of threads
+ * stays the same regardless of the nesting depth.
+ */
+
+/*
+ * Constructor (starts threadCount-1 workers, the calling thread of ParallelFor is the last one)
+ */
+CWorkerPool::CWorkerPool(int threadCount)
+{
+	m_ThreadCount = threadCount < 1 ? 1 : threadCount;
+	m_Stop = false;
+	for (int i=1; i<m_ThreadCount; i++)
+		m_Workers.push_back(new thread(&CWorkerPool::WorkerLoop, this));
+}
+
+/*
+ * Destructor (stops the workers)
+ */
+CWorkerPool::~CWorkerPool()
+{
+	unique_lock<mutex> lock(m_Mutex);
+	m_Stop = true;
+	m_WorkAvailable.notify_all();
+	lock.unlock();
+
+	for (unsigned int i=0; i<m_Workers.size(); i++)
+	{
+		m_Workers[i]->join();
+		delete m_Workers[i];
+	}
+}
+
+/*
+ * Runs the tasks 0..taskCount-1 on the workers and the calling thread. Returns when all tasks have finished.
+ * The tasks use the evaluation arena of the calling thread.
+ * If a task throws an exception, the remaining unclaimed tasks are skipped and the (first) exception
+ * is thrown again in the calling thread.
+ */
+void CWorkerPool::ParallelFor(int taskCount, const function<void(int)> & task)
+{
+	if (m_Workers.empty() || taskCount <= 1) //Run in calling thread
+	{
+		for (int i=0; i<taskCount; i++)
+			task(i);
+		return;
+	}
+
+	CJob job;
+	job.m_Task = &task;
+	job.m_TaskCount = taskCount;
+	job.m_NextTask = 0;
+	job.m_Running = 0;
+	job.m_Arena = CEvaluationArena::GetCurrent();
+
+	unique_lock<mutex> lock(m_Mutex);
+	m_Jobs.push_back(&job);
+	m_WorkAvailable.notify_all();
+
+	//The calling thread claims tasks of its own job only. Claimed tasks are always being run by some thread,
+	//so waiting for them below can't deadlock (also not for nested calls from within a task).
+	int taskIndex;
+	while (ClaimTask(&job, taskIndex))
+		RunTask(&job, taskIndex, lock);
+
+	while (job.m_Running > 0)
+		m_JobFinished.wait(lock);
+	lock.unlock();
+
+	if (job.m_Exception)
+		rethrow_exception(job.m_Exception);
+}
+
+/*
+ * Worker thread: runs tasks of the innermost job with unclaimed tasks until the pool is stopped
+ */
+void CWorkerPool::WorkerLoop()
+{
+	unique_lock<mutex> lock(m_Mutex);
+	while (true)
+	{
+		while (!m_Stop && m_Jobs.empty())
+			m_WorkAvailable.wait(lock);
+		if (m_Jobs.empty()) //Stopped
+			break;
+
+		CJob * job = m_Jobs.back();
+		int taskIndex;
+		if (ClaimTask(job, taskIndex))
+			RunTask(job, taskIndex, lock);
+	}
+}
+
+/*
+ * Takes the next task of the given job (lock has to be held).
+ * Returns false if all tasks have been claimed already.
+ */
+bool CWorkerPool::ClaimTask(CJob * job, int & taskIndex)
+{
+	if (job->m_NextTask >= job->m_TaskCount)
+	{
+		RemoveJob(job);
+		return false;
+	}
+	taskIndex = job->m_NextTask++;
+	job->m_Running++;
+	if (job->m_NextTask >= job->m_TaskCount)
+		RemoveJob(job);
+	return true;
+}
+
+/*
+ * Runs a claimed task (lock has to be held, it is released while the task is running)
+ */
+void CWorkerPool::RunTask(CJob * job, int taskIndex, unique_lock<mutex> & lock)
+{
+	lock.unlock();
+	exception_ptr exception;
+	{
+		CEvaluationArena::CScope arenaScope(job->m_Arena);
+		try
+		{
+			(*job->m_Task)(taskIndex);
+		}
+		catch (...)
+		{
+			exception = current_exception();
+		}
+	}
+	lock.lock();
+
+	if (exception && !job->m_Exception)
+	{
+		job->m_Exception = exception;
+		job->m_NextTask = job->m_TaskCount;	//Skip the remaining tasks
+		RemoveJob(job);
+	}
+	job->m_Running--;
+	if (job->m_Running == 0 && job->m_NextTask >= job->m_TaskCount)
+		m_JobFinished.notify_all();
+}
+
+/*
+ * Removes the job from the list of jobs with unclaimed tasks (lock has to be held)
+ */
+void CWorkerPool::RemoveJob(CJob * job)
+{
+	for (unsigned int i=0; i<m_Jobs.size(); i++)
+	{
+		if (m_Jobs[i] == job)
+		{
+			m_Jobs.erase(m_Jobs.begin() + i);
+			return;
+		}
+	}
+}
+
+} //end namespace
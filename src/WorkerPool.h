@@ -0,0 +1,70 @@
+#pragma once
+
+/*
+ * University of Salford
+ * Pattern Recognition and Image Analysis Research Lab
+ * Author: Christian Clausner
+ */
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+namespace PRImA
+{
+
+class CEvaluationArena;
+
+/*
+ * Class CWorkerPool
+ *
+ * Fixed set of worker threads for running loops of independent tasks in parallel (see ParallelFor).
+ * ParallelFor can be called from within a task (nested loops). The calling thread always works on
+ * its own loop, idle workers help with any loop that has unclaimed tasks, so the number of threads
+ * stays the same regardless of the nesting depth.
+ */
+class CWorkerPool
+{
+private:
+	/*
+	 * One call of ParallelFor
+	 */
+	struct CJob
+	{
+		const std::function<void(int)> *	m_Task;
+		int					m_TaskCount;
+		int					m_NextTask;		//Next unclaimed task
+		int					m_Running;		//Claimed tasks that haven't finished yet
+		CEvaluationArena *	m_Arena;		//Arena of the calling thread (used for the tasks)
+		std::exception_ptr	m_Exception;	//First exception thrown by a task
+	};
+
+public:
+	CWorkerPool(int threadCount);
+	~CWorkerPool();
+
+	void	ParallelFor(int taskCount, const std::function<void(int)> & task);
+
+	inline int GetThreadCount() { return m_ThreadCount; };
+
+private:
+	void	WorkerLoop();
+	bool	ClaimTask(CJob * job, int & taskIndex);
+	void	RunTask(CJob * job, int taskIndex, std::unique_lock<std::mutex> & lock);
+	void	RemoveJob(CJob * job);
+
+private:
+	int							m_ThreadCount;	//Including the calling thread
+	std::vector<std::thread*>	m_Workers;
+	std::vector<CJob*>			m_Jobs;			//Jobs with unclaimed tasks (innermost last)
+	bool						m_Stop;
+
+	std::mutex					m_Mutex;		//For the jobs
+	std::condition_variable		m_WorkAvailable;
+	std::condition_variable		m_JobFinished;
+};
+
+} //end namespace
@@ -7,6 +7,7 @@
 
 #include "stdafx.h"
 #include "XmlEvaluationReader.h"
+#include "ReadingOrderRelationMatrix.h"
 
 using namespace PRImA;
 using namespace std;
@@ -1046,7 +1047,7 @@ CReadingOrderError * CXmlEvaluationReader::ParseReadingOrderError(CMsXmlNode * e
 		penalty = errorNode->GetDoubleAttribute(ATTR_penalty);
 
 	//Relations
-	set<int> segResultRel;
+	unsigned int segResultRel = 0;
 	CMsXmlNode * tempNode = errorNode->GetFirstChild();
 	vector<CFuzzyReadingOrderRelation> groundTruthRel;
 	while (tempNode != NULL)
@@ -1058,7 +1059,7 @@ CReadingOrderError * CXmlEvaluationReader::ParseReadingOrderError(CMsXmlNode * e
 		else if(tempNode->GetName() == CUniString(ELEMENT_GroundTruthRelation))
 		{
 			//Relation set
-			set<int> rel = ParseRelationSet(tempNode);
+			unsigned int rel = ParseRelationSet(tempNode);
 			//Weight
 			double weight = 0.0;
 			if (tempNode->HasAttribute(ATTR_weight))
@@ -1089,21 +1090,25 @@ CReadingOrderError * CXmlEvaluationReader::ParseReadingOrderError(CMsXmlNode * e
 }
 
 /*
- * Parses reading order realtion set (set of base relations)
+ * Parses reading order realtion set (set of base relations, returned as bitmask; see CReadingOrderRelationMatrix)
  */
-set<int> CXmlEvaluationReader::ParseRelationSet(CMsXmlNode * node)
+unsigned int CXmlEvaluationReader::ParseRelationSet(CMsXmlNode * node)
 {
-	set<int> ret;
+	unsigned int ret = 0;
 
 	CMsXmlNode * tempNode = node->GetFirstChild();
 	while (tempNode != NULL)
 	{
 		if(tempNode->GetName() == CUniString(ELEMENT_Relation))
 		{
+			int relation;
 			if (m_SchemaVersion >= SCHEMA_2013_07_15)
-				ret.insert(ReadingOrderRelationTypeStringToInt(tempNode->GetAttribute(ATTR_type)));
+				relation = ReadingOrderRelationTypeStringToInt(tempNode->GetAttribute(ATTR_type));
 			else
-				ret.insert(tempNode->GetIntAttribute(ATTR_type));
+				relation = tempNode->GetIntAttribute(ATTR_type);
+
+			if (CReadingOrderRelationMatrix::IsValidRelation(relation)) //Unknown relation types are skipped
+				ret |= CReadingOrderRelationMatrix::ToMask(relation);
 		}
 		tempNode = tempNode->GetNextSibling();
 	}
@@ -1245,12 +1250,12 @@ void CXmlEvaluationReader::ParseRegionError(CMsXmlNode * errorNode, CLayoutObjec
 	{
 		if(tempNode->GetName() == CUniString(ELEMENT_ErrorRects))
 		{
-			list<CRect*> * rects = error->GetRects();
+			CCompactRectArray * rects = error->GetRects();
 			ParseRects(tempNode, rects);
 		}
 		else if(tempNode->GetName() == CUniString(ELEMENT_FalseAlarmRects))
 		{
-			list<CRect*> * rects = error->GetFalseAlarmRects();
+			CCompactRectArray * rects = error->GetFalseAlarmRects();
 			ParseRects(tempNode, rects);
 		}
 		tempNode = tempNode->GetNextSibling();
@@ -1320,7 +1325,7 @@ void CXmlEvaluationReader::ParseRegionError(CMsXmlNode * errorNode, CLayoutObjec
 /*
  * Parses the given node for rectangles and puts them into the specified vector.
  */
-void CXmlEvaluationReader::ParseRects(CMsXmlNode * node, list<CRect*> * rects)
+void CXmlEvaluationReader::ParseRects(CMsXmlNode * node, CCompactRectArray * rects)
 {
 	//Rects attribute (list of rectangles)
 	if (m_SchemaVersion >= SCHEMA_2013_07_15)
@@ -1341,7 +1346,7 @@ void CXmlEvaluationReader::ParseRects(CMsXmlNode * node, list<CRect*> * rects)
 					int top		= rectCoords[1].ToInt();
 					int right	= rectCoords[2].ToInt();
 					int bottom	= rectCoords[3].ToInt();
-					rects->push_back(new CRect(left, top, right, bottom));
+					rects->Add(left, top, right, bottom);
 				}
 			}
 		}
@@ -1357,8 +1362,7 @@ void CXmlEvaluationReader::ParseRects(CMsXmlNode * node, list<CRect*> * rects)
 				int top = tempNode->GetIntAttribute(ATTR_top);
 				int right = tempNode->GetIntAttribute(ATTR_right);
 				int bottom = tempNode->GetIntAttribute(ATTR_bottom);
-				CRect * rect = new CRect(left, top, right, bottom);
-				rects->push_back(rect);
+				rects->Add(left, top, right, bottom);
 			}
 			tempNode = tempNode->GetNextSibling();
 		}
@@ -1506,6 +1510,8 @@ void CXmlEvaluationReader::parseProfileNode(CEvaluationProfile * profile,
 	}
 
 	MigrateProfileFromOldFormat(profile);
+
+	profile->InvalidateWeightTable(); //Weight values have changed
 }
 
 void CXmlEvaluationReader::MigrateProfileFromOldFormat(CEvaluationProfile * profile)
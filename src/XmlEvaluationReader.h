@@ -254,8 +254,8 @@ private:
 	COverlapRects * ParseOverlap(CMsXmlNode * node, CPageLayout * pageLayout);
 	void ParseReadingOrderResults(CMsXmlNode * resultsNode, CEvaluationResults * results, CEvaluationProfile * profile);
 	CReadingOrderError * ParseReadingOrderError(CMsXmlNode * errorNode, CEvaluationResults * results, CEvaluationProfile * profile);
-	set<int> ParseRelationSet(CMsXmlNode * node);
-	void ParseRects(CMsXmlNode * node, list<CRect*> * rects);
+	unsigned int ParseRelationSet(CMsXmlNode * node);
+	void ParseRects(CMsXmlNode * node, CCompactRectArray * rects);
 
 	void ParseMetricResults(CMsXmlNode * metricsNode, CEvaluationResults * results);
 	void ParseMetricsNode(CMsXmlNode * metricsNode, CLayoutObjectEvaluationMetrics * metrics);
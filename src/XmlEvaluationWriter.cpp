@@ -7,6 +7,7 @@
 
 #include "stdafx.h"
 #include "XmlEvaluationWriter.h"
+#include "ReadingOrderRelationMatrix.h"
 
 
 using namespace PRImA;
@@ -1052,25 +1053,23 @@ void CXmlEvaluationWriter::WriteDoublePerErrorTypeNode(map<int, double> * values
 void CXmlEvaluationWriter::WriteRawData(CEvaluationResults * results, CMsXmlNode * parentNode)
 {
 	//Ground-truth overlaps
-	map<CUniString, set<CUniString>*> * overlaps = results->GetGroundTruthOverlaps();
-	map<CUniString, set<CUniString>*>::iterator itReg1 = overlaps->begin();
-	while (itReg1 != overlaps->end())
+	vector<CUniString> overlappingObjects;
+	results->GetOverlappingObjects(true, &overlappingObjects);
+	for (unsigned int i=0; i<overlappingObjects.size(); i++)
 	{
 		CMsXmlNode * overlapNode;
 		overlapNode = parentNode->AddChildNode(CXmlEvaluationReader::ELEMENT_GroundTruthOverlap);
-		WriteOverlapEntries((*itReg1).first, (*itReg1).second, overlapNode);
-		itReg1++;
+		WriteOverlapEntries(overlappingObjects[i], results->GetGroundTruthOverlaps(overlappingObjects[i]), overlapNode);
 	}
 
 	//Seg result overlaps
-	overlaps = results->GetSegResultOverlaps();
-	itReg1 = overlaps->begin();
-	while (itReg1 != overlaps->end())
+	overlappingObjects.clear();
+	results->GetOverlappingObjects(false, &overlappingObjects);
+	for (unsigned int i=0; i<overlappingObjects.size(); i++)
 	{
 		CMsXmlNode * overlapNode;
 		overlapNode = parentNode->AddChildNode(CXmlEvaluationReader::ELEMENT_SegResultOverlap);
-		WriteOverlapEntries((*itReg1).first, (*itReg1).second, overlapNode);
-		itReg1++;
+		WriteOverlapEntries(overlappingObjects[i], results->GetSegResultOverlaps(overlappingObjects[i]), overlapNode);
 	}
 
 	//Region results (merge, split, ...)
@@ -1128,13 +1127,13 @@ void CXmlEvaluationWriter::WriteReadingOrderError(CReadingOrderError * error,
 	//Seg result relation
 	CMsXmlNode * segResultRelNode;
 	segResultRelNode = readingOrderErrorNode->AddChildNode(CXmlEvaluationReader::ELEMENT_SegResultRelation);
-	WriteRelation(error->GetSegResultRelation(), segResultRelNode);
+	WriteRelation(error->GetSegResultRelationMask(), segResultRelNode);
 
 	//Fuzzy ground-truth relations
 	vector<CFuzzyReadingOrderRelation> * groundTruthRelations = error->GetGroundTruthRelations();
 	for (unsigned int i=0; i<groundTruthRelations->size(); i++)
 	{
-		CFuzzyReadingOrderRelation fuzzyRel = groundTruthRelations->at(i);
+		CFuzzyReadingOrderRelation & fuzzyRel = groundTruthRelations->at(i);
 		CMsXmlNode * groundTruthRelNode;
 		groundTruthRelNode = readingOrderErrorNode->AddChildNode(CXmlEvaluationReader::ELEMENT_GroundTruthRelation);
 		//Penalty
@@ -1149,26 +1148,24 @@ void CXmlEvaluationWriter::WriteReadingOrderError(CReadingOrderError * error,
 		//Seg result base relation used for the error
 		groundTruthRelNode->AddAttribute(CXmlEvaluationReader::ATTR_segResultRelation, fuzzyRel.GetCausingSegResultRelation());
 		//Relation set
-		WriteRelation(&fuzzyRel.GetRelation(), groundTruthRelNode);
+		WriteRelation(fuzzyRel.GetRelationMask(), groundTruthRelNode);
 	}
 }
 
 /*
- * Writes a reading order relation set
+ * Writes a reading order relation set (bitmask, see CReadingOrderRelationMatrix)
  */
-void CXmlEvaluationWriter::WriteRelation(set<int> * relation, CMsXmlNode * node)
+void CXmlEvaluationWriter::WriteRelation(unsigned int relation, CMsXmlNode * node)
 {
-	if (relation != NULL)
+	set<int> relationSet = CReadingOrderRelationMatrix::ToSet(relation);
+	set<int>::iterator it = relationSet.begin();
+	while (it != relationSet.end())
 	{
-		set<int>::iterator it = relation->begin();
-		while (it != relation->end())
-		{
-			CMsXmlNode * baseRelationNode;
-			baseRelationNode = node->AddChildNode(CXmlEvaluationReader::ELEMENT_Relation);
-			//Type
-			baseRelationNode->AddAttribute(CXmlEvaluationReader::ATTR_type, ReadingOrderRelationTypeIntToString((*it)));
-			it++;
-		}
+		CMsXmlNode * baseRelationNode;
+		baseRelationNode = node->AddChildNode(CXmlEvaluationReader::ELEMENT_Relation);
+		//Type
+		baseRelationNode->AddAttribute(CXmlEvaluationReader::ATTR_type, ReadingOrderRelationTypeIntToString((*it)));
+		it++;
 	}
 }
 
@@ -1177,7 +1174,7 @@ void CXmlEvaluationWriter::WriteRelation(set<int> * relation, CMsXmlNode * node)
  * region1 can be either a ground-truth region or a segmentation result region.
  * regions2 is then a list of overlappint regions from the opposite document layout.
  */
-void CXmlEvaluationWriter::WriteOverlapEntries(CUniString region1, set<CUniString> * regions2, 
+void CXmlEvaluationWriter::WriteOverlapEntries(CUniString region1, COverlapRow * regions2, 
 											   CMsXmlNode * overlapNode)
 {
 	//ID of region 1
@@ -1185,7 +1182,7 @@ void CXmlEvaluationWriter::WriteOverlapEntries(CUniString region1, set<CUniStrin
 
 	if (regions2 != NULL)
 	{
-		set<CUniString>::iterator itReg2 = regions2->begin();
+		COverlapRow::iterator itReg2 = regions2->begin();
 		while (itReg2 != regions2->end())
 		{
 			CMsXmlNode * overlapRegionNode;
@@ -1250,7 +1247,7 @@ void CXmlEvaluationWriter::WriteRegionError(CLayoutObjectEvaluationError * error
 	errorNode->AddAttribute(CXmlEvaluationReader::ATTR_falseAlarm, error->IsFalseAlarm());
 
 	//Rects
-	list<CRect*> * rects = error->GetRects();
+	CCompactRectArray * rects = error->GetRects();
 	if (rects != NULL && !rects->empty())
 	{
 		CMsXmlNode * rectsNode;
@@ -1347,10 +1344,10 @@ void CXmlEvaluationWriter::WriteOverlaps(COverlapRects * overlapRects,
 /*
  * Writes rectangles
  */
-void CXmlEvaluationWriter::WriteRects(list<CRect*> * rects, CMsXmlNode * rectsNode)
+void CXmlEvaluationWriter::WriteRects(CCompactRectArray * rects, CMsXmlNode * rectsNode)
 {
 	CUniString rectsString;
-	for (list<CRect*>::iterator it = rects->begin(); it != rects->end(); it++)
+	for (CCompactRect * it = rects->begin(); it != rects->end(); it++)
 	{
 		/*CMsXmlNode * rectNode;
 		rectNode = rectsNode->AddChildNode(CXmlEvaluationReader::ELEMENT_Rect);
@@ -1362,13 +1359,13 @@ void CXmlEvaluationWriter::WriteRects(list<CRect*> * rects, CMsXmlNode * rectsNo
 		*/
 		if (!rectsString.IsEmpty())
 			rectsString.Append(L" ");
-		rectsString.Append((int)(*it)->left);
+		rectsString.Append(it->left);
 		rectsString.Append(L",");
-		rectsString.Append((int)(*it)->top);
+		rectsString.Append(it->top);
 		rectsString.Append(L",");
-		rectsString.Append((int)(*it)->right);
+		rectsString.Append(it->right);
 		rectsString.Append(L",");
-		rectsString.Append((int)(*it)->bottom);
+		rectsString.Append(it->bottom);
 	}
 	rectsNode->AddAttribute(CXmlEvaluationReader::ATTR_rects, rectsString);
 }
@@ -60,14 +60,14 @@ private:
 	void WriteRawData(CEvaluationResults * results, CMsXmlNode * parentNode);
 	void WriteMetricResults(CEvaluationResults * results, CMsXmlNode * metricsNode);
 	void WriteMetricResult(CLayoutObjectEvaluationMetrics * metricResult, CMsXmlNode * metricsNode);
-	void WriteOverlapEntries(CUniString region1, set<CUniString> * regions2, CMsXmlNode * overlapNode);
+	void WriteOverlapEntries(CUniString region1, COverlapRow * regions2, CMsXmlNode * overlapNode);
 	void WriteRegionResults(CUniString region, CLayoutObjectEvaluationResult * results, CMsXmlNode * resultsNode);
 	void WriteRegionError(CLayoutObjectEvaluationError * error, CMsXmlNode * errorNode);
-	void WriteRects(list<CRect*> * rects, CMsXmlNode * rectsNode);
+	void WriteRects(CCompactRectArray * rects, CMsXmlNode * rectsNode);
 	void WriteOverlaps(COverlapRects * overlapRects, CMsXmlNode * node);
 
 	void WriteReadingOrderError(CReadingOrderError * error, CMsXmlNode * readingOrderErrorNode);
-	void WriteRelation(set<int> * relation, CMsXmlNode * node);
+	void WriteRelation(unsigned int relation, CMsXmlNode * node);
 
 	void WriteIntPerRegionTypeNode(map<int, int> * values, const wchar_t * elementName, CMsXmlNode * parentNode);
 	void WriteDoublePerRegionTypeNode(map<int, double> * values, const wchar_t * elementName, CMsXmlNode * parentNode);